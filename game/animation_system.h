@@ -18,12 +18,12 @@ struct WeightedAnimationJoint {
 
 struct AnimatedVertex {
   Gamma::Vertex vertex;
-  std::vector<WeightedAnimationJoint> joints;
+  Gamma::TrackedVector<WeightedAnimationJoint, Gamma::MEMORY_ANIMATION> joints;
 };
 
 struct AnimationRig {
-  std::vector<AnimationJoint> joints;
-  std::vector<AnimatedVertex> vertices;
+  Gamma::TrackedVector<AnimationJoint, Gamma::MEMORY_ANIMATION> joints;
+  Gamma::TrackedVector<AnimatedVertex, Gamma::MEMORY_ANIMATION> vertices;
 };
 
 namespace AnimationSystem {
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cmath>
+
+#include "bvh.h"
+#include "macros.h"
+
+using namespace Gamma;
+
+constexpr static u32 MAX_LEAF_ENTRIES = 4;
+constexpr static u32 MIN_UNSORTED_ENTRIES_BEFORE_REBUILD = 32;
+
+internal u64 getRecordKey(const ObjectRecord& record) {
+  return (u64(record.meshIndex) << 32) | (u64(record.id) << 16) | u64(record.generation);
+}
+
+internal float getAxisComponent(const Vec3f& vector, u8 axis) {
+  return axis == 0 ? vector.x : axis == 1 ? vector.y : vector.z;
+}
+
+internal void expandBounds(Vec3f& min, Vec3f& max, const Vec3f& boundsMin, const Vec3f& boundsMax) {
+  min.x = std::min(min.x, boundsMin.x);
+  min.y = std::min(min.y, boundsMin.y);
+  min.z = std::min(min.z, boundsMin.z);
+
+  max.x = std::max(max.x, boundsMax.x);
+  max.y = std::max(max.y, boundsMax.y);
+  max.z = std::max(max.z, boundsMax.z);
+}
+
+internal void resetBounds(Vec3f& min, Vec3f& max) {
+  min = Vec3f(Gm_FLOAT_MAX);
+  max = Vec3f(-Gm_FLOAT_MAX);
+}
+
+internal void updateEntryBounds(BvhEntry& entry, const Object& object, const Vec3f& hitboxScale, const Vec3f& hitboxOffset) {
+  Matrix4f rotation = object.rotation.toMatrix4f();
+  Vec3f adjustedScale = object.scale * hitboxScale;
+
+  entry.record = object._record;
+  entry.center = object.position + rotation.transformVec3f(adjustedScale * hitboxOffset);
+  entry.axes[0] = rotation.transformVec3f(Vec3f(1.f, 0, 0));
+  entry.axes[1] = rotation.transformVec3f(Vec3f(0, 1.f, 0));
+  entry.axes[2] = rotation.transformVec3f(Vec3f(0, 0, 1.f));
+  entry.halfExtents = Vec3f(fabsf(adjustedScale.x), fabsf(adjustedScale.y), fabsf(adjustedScale.z));
+
+  // Project the oriented box onto the world axes
+  Vec3f extent;
+
+  extent.x = fabsf(entry.axes[0].x) * entry.halfExtents.x + fabsf(entry.axes[1].x) * entry.halfExtents.y + fabsf(entry.axes[2].x) * entry.halfExtents.z;
+  extent.y = fabsf(entry.axes[0].y) * entry.halfExtents.x + fabsf(entry.axes[1].y) * entry.halfExtents.y + fabsf(entry.axes[2].y) * entry.halfExtents.z;
+  extent.z = fabsf(entry.axes[0].z) * entry.halfExtents.x + fabsf(entry.axes[1].z) * entry.halfExtents.y + fabsf(entry.axes[2].z) * entry.halfExtents.z;
+
+  entry.min = entry.center - extent;
+  entry.max = entry.center + extent;
+}
+
+internal void refitLeaf(ObjectBvh& bvh, u32 nodeIndex) {
+  auto& leaf = bvh.nodes[nodeIndex];
+
+  resetBounds(leaf.min, leaf.max);
+
+  for (u32 i = leaf.start; i < leaf.start + leaf.count; i++) {
+    auto& entry = bvh.entries[bvh.leafEntries[i]];
+
+    if (entry.active) {
+      expandBounds(leaf.min, leaf.max, entry.min, entry.max);
+    }
+  }
+
+  // Walk up the tree, refitting each parent to its children
+  u32 index = nodeIndex;
+
+  while (index != 0) {
+    index = bvh.nodes[index].parent;
+
+    auto& node = bvh.nodes[index];
+    auto& left = bvh.nodes[node.left];
+    auto& right = bvh.nodes[node.right];
+
+    resetBounds(node.min, node.max);
+    expandBounds(node.min, node.max, left.min, left.max);
+    expandBounds(node.min, node.max, right.min, right.max);
+  }
+}
+
+internal u32 buildNode(ObjectBvh& bvh, u32 parent, u32 start, u32 count) {
+  u32 nodeIndex = (u32)bvh.nodes.size();
+
+  bvh.nodes.emplace_back();
+
+  Vec3f min, max, centroidMin, centroidMax;
+
+  resetBounds(min, max);
+  resetBounds(centroidMin, centroidMax);
+
+  for (u32 i = start; i < start + count; i++) {
+    auto& entry = bvh.entries[bvh.leafEntries[i]];
+
+    expandBounds(min, max, entry.min, entry.max);
+    expandBounds(centroidMin, centroidMax, entry.center, entry.center);
+  }
+
+  bvh.nodes[nodeIndex].min = min;
+  bvh.nodes[nodeIndex].max = max;
+  bvh.nodes[nodeIndex].parent = parent;
+
+  if (count <= MAX_LEAF_ENTRIES) {
+    bvh.nodes[nodeIndex].start = start;
+    bvh.nodes[nodeIndex].count = count;
+
+    for (u32 i = start; i < start + count; i++) {
+      auto& entry = bvh.entries[bvh.leafEntries[i]];
+
+      entry.leafIndex = nodeIndex;
+      entry.isInTree = true;
+    }
+
+    return nodeIndex;
+  }
+
+  // Split along the longest axis of the entry centers, at the median
+  Vec3f centroidRange = centroidMax - centroidMin;
+  u8 axis = centroidRange.x > centroidRange.y && centroidRange.x > centroidRange.z ? 0 : centroidRange.y > centroidRange.z ? 1 : 2;
+  u32 half = count / 2;
+  auto begin = bvh.leafEntries.begin() + start;
+
+  std::nth_element(begin, begin + half, begin + count, [&bvh, axis](u32 a, u32 b) {
+    return getAxisComponent(bvh.entries[a].center, axis) < getAxisComponent(bvh.entries[b].center, axis);
+  });
+
+  u32 left = buildNode(bvh, nodeIndex, start, half);
+  u32 right = buildNode(bvh, nodeIndex, start + half, count - half);
+
+  bvh.nodes[nodeIndex].left = left;
+  bvh.nodes[nodeIndex].right = right;
+
+  return nodeIndex;
+}
+
+internal bool isRayIntersectingBounds(const Vec3f& origin, const Vec3f& inverseDirection, float maxDistance, const Vec3f& min, const Vec3f& max) {
+  float tx1 = (min.x - origin.x) * inverseDirection.x;
+  float tx2 = (max.x - origin.x) * inverseDirection.x;
+  float ty1 = (min.y - origin.y) * inverseDirection.y;
+  float ty2 = (max.y - origin.y) * inverseDirection.y;
+  float tz1 = (min.z - origin.z) * inverseDirection.z;
+  float tz2 = (max.z - origin.z) * inverseDirection.z;
+
+  float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::min(tz1, tz2));
+  float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+
+  return tFar >= std::max(tNear, 0.f) && tNear <= maxDistance;
+}
+
+/**
+ * Returns the distance along the ray to the entry's oriented box,
+ * or -1 if the ray misses it. Boxes containing the ray origin are
+ * treated as misses, mirroring the editor's behavior of only
+ * considering hitbox faces which face the camera.
+ */
+internal float getRayEntryDistance(const Vec3f& origin, const Vec3f& direction, const BvhEntry& entry) {
+  Vec3f originToCenter = entry.center - origin;
+  float tNear = -Gm_FLOAT_MAX;
+  float tFar = Gm_FLOAT_MAX;
+
+  for (u8 i = 0; i < 3; i++) {
+    float halfExtent = getAxisComponent(entry.halfExtents, i);
+    float e = Vec3f::dot(entry.axes[i], originToCenter);
+    float f = Vec3f::dot(entry.axes[i], direction);
+
+    if (fabsf(f) > 0.00001f) {
+      float t1 = (e + halfExtent) / f;
+      float t2 = (e - halfExtent) / f;
+
+      if (t1 > t2) std::swap(t1, t2);
+      if (t1 > tNear) tNear = t1;
+      if (t2 < tFar) tFar = t2;
+      if (tNear > tFar || tFar < 0.f) return -1.f;
+    } else if (-e - halfExtent > 0.f || -e + halfExtent < 0.f) {
+      return -1.f;
+    }
+  }
+
+  return tNear >= 0.f ? tNear : -1.f;
+}
+
+internal void testRayEntry(const ObjectBvh& bvh, u32 entryIndex, const Vec3f& origin, const Vec3f& direction, BvhRayHit& closestHit) {
+  auto& entry = bvh.entries[entryIndex];
+
+  if (!entry.active) {
+    return;
+  }
+
+  float distance = getRayEntryDistance(origin, direction, entry);
+
+  if (distance >= 0.f && distance < closestHit.distance) {
+    closestHit.record = entry.record;
+    closestHit.distance = distance;
+    closestHit.point = origin + direction * distance;
+    closestHit.hit = true;
+  }
+}
+
+/**
+ * Bvh::build
+ * ----------
+ *
+ * Discards removed entries and rebuilds the tree from scratch.
+ */
+void Bvh::build(ObjectBvh& bvh) {
+  std::vector<BvhEntry> activeEntries;
+
+  activeEntries.reserve(bvh.entries.size() - bvh.totalInactiveEntries);
+
+  for (auto& entry : bvh.entries) {
+    if (entry.active) {
+      activeEntries.push_back(entry);
+    }
+  }
+
+  bvh.entries = std::move(activeEntries);
+  bvh.nodes.clear();
+  bvh.leafEntries.clear();
+  bvh.unsortedEntries.clear();
+  bvh.entryIndexByRecord.clear();
+  bvh.totalInactiveEntries = 0;
+
+  for (u32 i = 0; i < bvh.entries.size(); i++) {
+    bvh.leafEntries.push_back(i);
+    bvh.entryIndexByRecord[getRecordKey(bvh.entries[i].record)] = i;
+  }
+
+  if (bvh.entries.size() > 0) {
+    buildNode(bvh, 0, 0, (u32)bvh.entries.size());
+  }
+}
+
+void Bvh::clear(ObjectBvh& bvh) {
+  bvh.entries.clear();
+  bvh.nodes.clear();
+  bvh.leafEntries.clear();
+  bvh.unsortedEntries.clear();
+  bvh.entryIndexByRecord.clear();
+  bvh.totalInactiveEntries = 0;
+}
+
+/**
+ * Bvh::raycast
+ * ------------
+ *
+ * Finds the closest object hitbox along a ray, where
+ * the ray direction is expected to be normalized.
+ */
+BvhRayHit Bvh::raycast(const ObjectBvh& bvh, const Vec3f& origin, const Vec3f& direction, float maxDistance) {
+  BvhRayHit closestHit;
+  Vec3f inverseDirection = Vec3f(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+
+  closestHit.distance = maxDistance;
+
+  if (bvh.nodes.size() > 0) {
+    u32 stack[64];
+    u32 stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+      auto& node = bvh.nodes[stack[--stackSize]];
+
+      if (!isRayIntersectingBounds(origin, inverseDirection, closestHit.distance, node.min, node.max)) {
+        continue;
+      }
+
+      if (node.left == 0) {
+        for (u32 i = node.start; i < node.start + node.count; i++) {
+          testRayEntry(bvh, bvh.leafEntries[i], origin, direction, closestHit);
+        }
+      } else {
+        stack[stackSize++] = node.left;
+        stack[stackSize++] = node.right;
+      }
+    }
+  }
+
+  for (auto entryIndex : bvh.unsortedEntries) {
+    testRayEntry(bvh, entryIndex, origin, direction, closestHit);
+  }
+
+  return closestHit;
+}
+
+void Bvh::removeObject(ObjectBvh& bvh, const ObjectRecord& record) {
+  auto key = getRecordKey(record);
+  auto found = bvh.entryIndexByRecord.find(key);
+
+  if (found == bvh.entryIndexByRecord.end()) {
+    return;
+  }
+
+  // Leave the node bounds as-is; they remain conservative
+  // until the next build
+  bvh.entries[found->second].active = false;
+  bvh.entryIndexByRecord.erase(found);
+  bvh.totalInactiveEntries++;
+}
+
+/**
+ * Bvh::updateObject
+ * -----------------
+ *
+ * Refits the entry for an existing object, or adds a new
+ * entry for objects not yet tracked. The tree is rebuilt
+ * once enough entries have been added or removed since
+ * the last build.
+ */
+void Bvh::updateObject(ObjectBvh& bvh, const Object& object, const Vec3f& hitboxScale, const Vec3f& hitboxOffset) {
+  auto key = getRecordKey(object._record);
+  auto found = bvh.entryIndexByRecord.find(key);
+
+  if (found != bvh.entryIndexByRecord.end()) {
+    auto& entry = bvh.entries[found->second];
+
+    updateEntryBounds(entry, object, hitboxScale, hitboxOffset);
+
+    if (entry.isInTree) {
+      refitLeaf(bvh, entry.leafIndex);
+    }
+
+    return;
+  }
+
+  BvhEntry entry;
+
+  updateEntryBounds(entry, object, hitboxScale, hitboxOffset);
+
+  u32 entryIndex = (u32)bvh.entries.size();
+
+  bvh.entries.push_back(entry);
+  bvh.unsortedEntries.push_back(entryIndex);
+  bvh.entryIndexByRecord[key] = entryIndex;
+
+  u32 totalEntries = (u32)bvh.entries.size();
+
+  if (
+    bvh.unsortedEntries.size() > std::max(MIN_UNSORTED_ENTRIES_BEFORE_REBUILD, totalEntries / 8) ||
+    bvh.totalInactiveEntries > totalEntries / 4
+  ) {
+    build(bvh);
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Gamma.h"
+
+/**
+ * BvhEntry
+ * --------
+ *
+ * An object's oriented hitbox, along with the axis-aligned
+ * bounds enclosing it.
+ */
+struct BvhEntry {
+  Gamma::ObjectRecord record;
+  Gamma::Vec3f center;
+  Gamma::Vec3f axes[3];
+  Gamma::Vec3f halfExtents;
+  Gamma::Vec3f min;
+  Gamma::Vec3f max;
+  u32 leafIndex = 0;
+  bool isInTree = false;
+  bool active = true;
+};
+
+struct BvhNode {
+  Gamma::Vec3f min;
+  Gamma::Vec3f max;
+  u32 parent = 0;
+  // Child node indexes (0 for leaf nodes)
+  u32 left = 0;
+  u32 right = 0;
+  // Range of ObjectBvh::leafEntries belonging to leaf nodes
+  u32 start = 0;
+  u32 count = 0;
+};
+
+/**
+ * ObjectBvh
+ * ---------
+ *
+ * A bounding volume hierarchy over object hitboxes. Entries
+ * modified after a build are refit in place; entries added
+ * after a build are kept in a small unsorted list until the
+ * next build.
+ */
+struct ObjectBvh {
+  std::vector<BvhEntry> entries;
+  std::vector<BvhNode> nodes;
+  std::vector<u32> leafEntries;
+  std::vector<u32> unsortedEntries;
+  std::unordered_map<u64, u32> entryIndexByRecord;
+  u32 totalInactiveEntries = 0;
+};
+
+struct BvhRayHit {
+  Gamma::ObjectRecord record;
+  Gamma::Vec3f point;
+  float distance = 0.f;
+  bool hit = false;
+};
+
+namespace Bvh {
+  void build(ObjectBvh& bvh);
+  void clear(ObjectBvh& bvh);
+  BvhRayHit raycast(const ObjectBvh& bvh, const Gamma::Vec3f& origin, const Gamma::Vec3f& direction, float maxDistance);
+  void removeObject(ObjectBvh& bvh, const Gamma::ObjectRecord& record);
+  void updateObject(ObjectBvh& bvh, const Gamma::Object& object, const Gamma::Vec3f& hitboxScale = Gamma::Vec3f(1.f), const Gamma::Vec3f& hitboxOffset = Gamma::Vec3f(0.f));
+}
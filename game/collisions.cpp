@@ -26,7 +26,7 @@ internal bool isInBetween(float n, float a, float b) {
 }
 
 // @todo rename addObjectBoundingBoxCollisionPlanes (or similar)
-void Collisions::addObjectCollisionPlanes(const Object& object, std::vector<Plane>& planes, const Vec3f& hitboxScale, const Vec3f& hitboxOffset) {
+void Collisions::addObjectCollisionPlanes(const Object& object, TrackedVector<Plane, MEMORY_COLLISION>& planes, const Vec3f& hitboxScale, const Vec3f& hitboxOffset) {
   Matrix4f rotation = object.rotation.toMatrix4f();
   Vec3f adjustedScale = object.scale * hitboxScale;
 
@@ -1,14 +1,19 @@
+#include <chrono>
 #include <functional>
+#include <future>
 #include <string>
 #include <vector>
 
 #include "editor.h"
 #include "world.h"
 #include "game_meshes.h"
+#include "bvh.h"
 #include "collisions.h"
+#include "editor_history.h"
 #include "effects_system.h"
 #include "vehicle_system.h"
 #include "macros.h"
+#include "system/FileWriter.h"
 
 using namespace Gamma;
 
@@ -18,18 +23,29 @@ enum EditorMode {
   LIGHTS
 };
 
-enum ActionType {
-  CREATE,
-  DELETE,
-  POSITION,
-  SCALE,
-  ROTATE,
-  COLOR
+struct ObjectSnapshot {
+  Vec3f position;
+  Vec3f scale;
+  Quaternion rotation;
+  pVec4 color;
 };
 
-struct HistoryAction {
-  ActionType type;
-  Object initialObject;
+struct MeshSnapshot {
+  std::string meshName;
+  std::vector<ObjectSnapshot> objects;
+};
+
+/**
+ * LevelSnapshot
+ * -------------
+ *
+ * A copy of the editor state saved to the level data files.
+ */
+struct LevelSnapshot {
+  std::string levelName;
+  std::vector<ObjectSnapshot> collisionPlanes;
+  std::vector<MeshSnapshot> meshes;
+  std::vector<Light> lights;
 };
 
 static struct EditorState {
@@ -46,17 +62,20 @@ static struct EditorState {
   ActionType currentActionType = ActionType::POSITION;
   u8 currentSelectedMeshIndex = 0;
 
-  // @todo limit size?
-  std::vector<HistoryAction> history;
+  HistoryLog history;
+  Object pendingObject;
+  ActionType pendingActionType = ActionType::POSITION;
+  bool hasPendingAction = false;
 
-  // @todo see if we end up having to use a more optimized lookup structure/world chunks/etc.
-  std::vector<Plane> objectCollisionPlanes;
+  ObjectBvh objectBvh;
+  ObjectBvh lightBvh;
 
-  // @todo see if we end up having to use a more optimized lookup structure/world chunks/etc.
-  std::vector<Plane> lightCollisionPlanes;
+  std::future<bool> autosave;
+  float lastAutosaveTime = 0.f;
 } editor;
 
 constexpr static float DEFAULT_LIGHT_POWER = 5.f;
+constexpr static float AUTOSAVE_INTERVAL = 60.f;
 
 internal std::string getEditorModeName(EditorMode mode) {
   switch (mode) {
@@ -98,15 +117,6 @@ internal bool isSameObject(Object& a, Object& b) {
   );
 }
 
-internal bool areObjectPropertiesIdentical(Object& a, Object& b) {
-  return (
-    a.position == b.position &&
-    a.rotation == b.rotation &&
-    a.scale == b.scale &&
-    a.color == b.color
-  );
-}
-
 internal void restoreObject(GmContext* context, const Object& object) {
   auto* originalObject = get_object_by_record(object._record);
 
@@ -189,40 +199,83 @@ internal void syncLightWithObject(Light& light, const Object& object) {
   light.direction = object.rotation.getDirection();
 }
 
-internal void rebuildCollisionPlanes(GmContext* context, GameState& state) {
-  u64 start = Gm_GetMicroseconds();
-
+internal void rebuildGameplayCollisionPlanes(GmContext* context, GameState& state) {
   state.collisionPlanes.clear();
 
-  editor.objectCollisionPlanes.clear();
-  editor.lightCollisionPlanes.clear();
+  for (auto& platform : objects("platform")) {
+    Collisions::addObjectCollisionPlanes(platform, state.collisionPlanes);
+  }
 
-  // Rebuild static and dynamic gameplay collision planes
-  {
-    for (auto& platform : objects("platform")) {
-      Collisions::addObjectCollisionPlanes(platform, state.collisionPlanes);
-    }
+  World::rebuildDynamicCollisionPlanes(context, state);
+}
 
-    World::rebuildDynamicCollisionPlanes(context, state);
-  }
+internal void rebuildCollisionPlanes(GmContext* context, GameState& state) {
+  u64 start = Gm_GetMicroseconds();
 
-  // Rebuild editor collision planes (objects + lights)
+  // Rebuild static and dynamic gameplay collision planes
+  rebuildGameplayCollisionPlanes(context, state);
+
+  // Rebuild editor hitboxes (objects + lights)
   {
+    Bvh::clear(editor.objectBvh);
+    Bvh::clear(editor.lightBvh);
+
     for (auto& asset : GameMeshes::meshAssets) {
       for (auto& object : mesh(asset.name)->objects) {
-        Collisions::addObjectCollisionPlanes(object, editor.objectCollisionPlanes, asset.hitboxScale, asset.hitboxOffset);
+        Bvh::updateObject(editor.objectBvh, object, asset.hitboxScale, asset.hitboxOffset);
       }
     }
 
     for (auto& sphere : objects("light-sphere")) {
-      Collisions::addObjectCollisionPlanes(sphere, editor.lightCollisionPlanes);
+      Bvh::updateObject(editor.lightBvh, sphere);
     }
+
+    Bvh::build(editor.objectBvh);
+    Bvh::build(editor.lightBvh);
   }
 
   #if GAMMA_DEVELOPER_MODE
-    u32 total = state.collisionPlanes.size() + editor.objectCollisionPlanes.size() + editor.lightCollisionPlanes.size();
+    u32 totalPlanes = state.collisionPlanes.size();
+    u32 totalHitboxes = editor.objectBvh.entries.size() + editor.lightBvh.entries.size();
+
+    Console::log("Rebuilt", totalPlanes, "collision planes and", totalHitboxes, "editor hitboxes in", (Gm_GetMicroseconds() - start), "us");
+  #endif
+}
+
+/**
+ * Updates collision data after an object has been created, modified
+ * or removed. Only the object's own editor hitbox is refit; gameplay
+ * collision planes are derived from a small subset of objects, and
+ * are simply rebuilt.
+ */
+internal void updateCollisionPlanesForObject(GmContext* context, GameState& state, const Object& object) {
+  u64 start = Gm_GetMicroseconds();
 
-    Console::log("Rebuilt", total, "collision planes in", (Gm_GetMicroseconds() - start), "us");
+  rebuildGameplayCollisionPlanes(context, state);
+
+  auto* liveObject = get_object_by_record(object._record);
+  auto& meshName = context->scene.meshes[object._record.meshIndex]->name;
+
+  if (meshName == "light-sphere") {
+    if (liveObject == nullptr) {
+      Bvh::removeObject(editor.lightBvh, object._record);
+    } else {
+      Bvh::updateObject(editor.lightBvh, *liveObject);
+    }
+  } else if (liveObject == nullptr) {
+    Bvh::removeObject(editor.objectBvh, object._record);
+  } else {
+    for (auto& asset : GameMeshes::meshAssets) {
+      if (asset.name == meshName) {
+        Bvh::updateObject(editor.objectBvh, *liveObject, asset.hitboxScale, asset.hitboxOffset);
+
+        break;
+      }
+    }
+  }
+
+  #if GAMMA_DEVELOPER_MODE
+    Console::log("Updated collision planes in", (Gm_GetMicroseconds() - start), "us");
   #endif
 }
 
@@ -428,7 +481,7 @@ internal Vec3f getMostSimilarScalingAxis(const Vec3f& sourceAxis, Object& object
 internal Vec3f getCurrentActionDelta(GmContext* context, float mouseDx, float mouseDy, float dt) {
   auto& camera = get_camera();
   auto& input = get_input();
-  auto& object = editor.history.back().initialObject;
+  auto& object = editor.hasPendingAction ? editor.pendingObject : editor.selectedObject;
   bool isVerticalMotion = Gm_Absf(mouseDy) > Gm_Absf(mouseDx);
   float multiplier = 1.f;
   Vec3f axis;
@@ -486,159 +539,267 @@ internal Vec3f getCurrentActionDelta(GmContext* context, float mouseDx, float mo
     : axis * mouseDx * multiplier * dt;
 }
 
-internal void createObjectHistoryAction(GmContext* context, ActionType type, Object& object) {
-  if (editor.history.size() > 0) {
-    auto& lastAction = editor.history.back();
-    auto* liveLastActionObject = get_object_by_record(lastAction.initialObject._record);
-
-    if (
-      liveLastActionObject != nullptr &&
-      areObjectPropertiesIdentical(*liveLastActionObject, lastAction.initialObject) &&
-      lastAction.type != ActionType::CREATE &&
-      lastAction.type != ActionType::DELETE
-    ) {
-      // No modifications were made to the last object in the history queue,
-      // so replace the object in the last history action with this one
-      lastAction.type = type;
-      lastAction.initialObject = object;
+internal void trackSelectedObjectChanges(ActionType type, const Object& object) {
+  editor.pendingObject = object;
+  editor.pendingActionType = type;
+  editor.hasPendingAction = true;
+}
 
-      return;
-    }
+internal ActionType getHistoryFieldsActionType(u8 fields, ActionType defaultType) {
+  switch (fields) {
+    case FIELD_POSITION:
+      return ActionType::POSITION;
+    case FIELD_SCALE:
+      return ActionType::SCALE;
+    case FIELD_ROTATION:
+      return ActionType::ROTATE;
+    case FIELD_COLOR:
+      return ActionType::COLOR;
+  }
 
-    if (
-      isSameObject(object, lastAction.initialObject) &&
-      areObjectPropertiesIdentical(object, lastAction.initialObject) &&
-      lastAction.type != ActionType::CREATE &&
-      lastAction.type != ActionType::DELETE
-    ) {
-      // Don't create a new history action when reselecting the same object,
-      // unless the last action was a CREATE/DELETE, which we want to preserve
-      // as separate records in the editor history
+  return defaultType;
+}
+
+/**
+ * Records any changes made to the tracked object since it was
+ * selected, or since its last recorded change. Drags are only
+ * recorded once the mouse is released, so a continuous drag
+ * produces a single history action.
+ */
+internal void commitPendingHistoryAction(GmContext* context) {
+  if (!editor.hasPendingAction) {
+    return;
+  }
+
+  editor.hasPendingAction = false;
+
+  Object currentObject;
+  bool isSelected = editor.isObjectSelected && isSameObject(editor.selectedObject, editor.pendingObject);
+
+  if (isSelected) {
+    // Use the selected object copy, since the live object
+    // may have a highlight color applied
+    currentObject = editor.selectedObject;
+  } else {
+    auto* liveObject = get_object_by_record(editor.pendingObject._record);
+
+    if (liveObject == nullptr) {
       return;
     }
+
+    currentObject = *liveObject;
   }
 
-  HistoryAction action;
+  u8 fields = History::getChangedFields(editor.pendingObject, currentObject);
 
-  action.type = type;
-  action.initialObject = object;
+  if (fields != 0) {
+    HistoryAction action;
 
-  editor.history.push_back(action);
-}
+    action.type = getHistoryFieldsActionType(fields, editor.pendingActionType);
+    action.record = currentObject._record;
+    action.fields = fields;
+    action.before = editor.pendingObject;
+    action.after = currentObject;
 
-internal void undoLastHistoryAction(GmContext* context, GameState& state) {
-  if (editor.history.size() == 0) {
-    return;
+    History::push(editor.history, action, get_context_time());
   }
 
-  auto& action = editor.history.back();
-
-  switch (action.type) {
-    case ActionType::CREATE: {
-      auto& initialObject = action.initialObject;
+  if (isSelected) {
+    trackSelectedObjectChanges(editor.pendingActionType, currentObject);
+  }
+}
 
-      if (context->scene.meshes[initialObject._record.meshIndex]->name == "light-sphere") {
-        // When undoing CREATE actions on light spheres,
-        // remove the associated light
-        auto* light = findLightByPosition(context, initialObject.position);
+internal void createObjectHistoryAction(GmContext* context, ActionType type, Object& object) {
+  commitPendingHistoryAction(context);
 
-        if (light != nullptr) {
-          remove_light(light);
-        }
-      }
+  if (type == ActionType::CREATE || type == ActionType::DELETE) {
+    HistoryAction action;
 
-      remove_object(initialObject);
+    action.type = type;
+    action.record = object._record;
+    action.fields = FIELD_ALL;
+    action.before = object;
+    action.after = object;
 
-      editor.isObjectSelected = false;
+    History::push(editor.history, action, get_context_time());
 
-      rebuildCollisionPlanes(context, state);
-      World::rebuildDynamicMeshes(context);
+    editor.hasPendingAction = false;
 
-      break;
+    if (type == ActionType::CREATE) {
+      // Record subsequent changes to newly-created objects separately
+      trackSelectedObjectChanges(ActionType::POSITION, object);
     }
-    case ActionType::DELETE: {
-      auto& deletedObject = action.initialObject;
-      auto& restoredObject = create_object_from(deletedObject._record.meshIndex);
-
-      restoredObject.position = deletedObject.position;
-      restoredObject.scale = deletedObject.scale;
-      restoredObject.rotation = deletedObject.rotation;
-      restoredObject.color = deletedObject.color;
-
-      commit(restoredObject);
-
-      editor.selectedObject = restoredObject;
-      editor.isObjectSelected = true;
-
-      rebuildCollisionPlanes(context, state);
-      World::rebuildDynamicMeshes(context);
-
-      // When restoring deleted objects using undo, we need to update
-      // older references to that object in the history as referring
-      // to the restored object, which may use a different ID/generation
-      // than the original. This preserves the integrity of objects across
-      // CREATE -> DELETE -> undo -> undo sequences.
-      for (auto& action : editor.history) {
-        if (isSameObject(action.initialObject, deletedObject)) {
-          action.initialObject._record = restoredObject._record;
-        }
-      }
+  } else {
+    trackSelectedObjectChanges(type, object);
+  }
+}
 
-      // When restoring light spheres, recreate the deleted light source
-      if (context->scene.meshes[restoredObject._record.meshIndex]->name == "light-sphere") {
-        auto& light = create_light(LightType::POINT);
+internal void removeHistoryObject(GmContext* context, GameState& state, const ObjectRecord& record) {
+  auto* liveObject = get_object_by_record(record);
 
-        // @todo figure out a better way of determining power
-        light.power = DEFAULT_LIGHT_POWER;
-        light.basePower = DEFAULT_LIGHT_POWER;
+  if (liveObject == nullptr) {
+    return;
+  }
+
+  Object object = *liveObject;
 
-        syncLightWithObject(light, restoredObject);
+  if (context->scene.meshes[record.meshIndex]->name == "light-sphere") {
+    // Remove the light associated with light spheres
+    auto* light = findLightByPosition(context, object.position);
 
-        editor.selectedLight = &light;
+    if (light != nullptr) {
+      if (editor.selectedLight == light) {
+        editor.selectedLight = nullptr;
       }
 
-      break;
+      remove_light(light);
     }
-    default: {
-      auto& initialObject = action.initialObject;
-      auto* liveLastActionObject = get_object_by_record(initialObject._record);
+  }
 
-      if (liveLastActionObject != nullptr) {
-        if (context->scene.meshes[initialObject._record.meshIndex]->name == "light-sphere") {
-          // Update the associated light when undoing actions on light spheres
-          auto* light = findLightByPosition(context, liveLastActionObject->position);
+  remove_object(object);
 
-          if (light != nullptr) {
-            syncLightWithObject(*light, initialObject);
-          }
-        }
+  editor.isObjectSelected = false;
 
-        *liveLastActionObject = initialObject;
+  updateCollisionPlanesForObject(context, state, object);
+  World::rebuildDynamicMeshesForObject(context, object);
+}
 
-        commit(*liveLastActionObject);
+internal void restoreHistoryObject(GmContext* context, GameState& state, const Object& object) {
+  auto& restoredObject = create_object_from(object._record.meshIndex);
 
-        editor.selectedObject = *liveLastActionObject;
-        editor.isObjectSelected = true;
+  restoredObject.position = object.position;
+  restoredObject.scale = object.scale;
+  restoredObject.rotation = object.rotation;
+  restoredObject.color = object.color;
 
-        rebuildCollisionPlanes(context, state);
-        World::rebuildDynamicMeshes(context);
-      }
+  commit(restoredObject);
+
+  editor.selectedObject = restoredObject;
+  editor.isObjectSelected = true;
+
+  updateCollisionPlanesForObject(context, state, restoredObject);
+  World::rebuildDynamicMeshesForObject(context, restoredObject);
+
+  // Restored objects may use a different ID/generation than the
+  // original, so we need to update older references to the object
+  // in the history. This preserves the integrity of objects across
+  // CREATE -> DELETE -> undo -> undo sequences.
+  History::replaceRecord(editor.history, object._record, restoredObject._record);
+
+  // When restoring light spheres, recreate the light source
+  if (context->scene.meshes[restoredObject._record.meshIndex]->name == "light-sphere") {
+    auto& light = create_light(LightType::POINT);
+
+    // @todo figure out a better way of determining power
+    light.power = DEFAULT_LIGHT_POWER;
+    light.basePower = DEFAULT_LIGHT_POWER;
+
+    syncLightWithObject(light, restoredObject);
+
+    editor.selectedLight = &light;
+  }
+}
+
+internal void applyHistoryObjectFields(GmContext* context, GameState& state, const Object& source, u8 fields) {
+  auto* liveObject = get_object_by_record(source._record);
+
+  if (liveObject == nullptr) {
+    return;
+  }
+
+  Object updatedObject = *liveObject;
+
+  if (fields & FIELD_POSITION) updatedObject.position = source.position;
+  if (fields & FIELD_SCALE) updatedObject.scale = source.scale;
+  if (fields & FIELD_ROTATION) updatedObject.rotation = source.rotation;
+  if (fields & FIELD_COLOR) updatedObject.color = source.color;
+
+  if (context->scene.meshes[source._record.meshIndex]->name == "light-sphere") {
+    // Update the associated light when changing light spheres
+    auto* light = findLightByPosition(context, liveObject->position);
+
+    if (light != nullptr) {
+      syncLightWithObject(*light, updatedObject);
     }
   }
 
+  *liveObject = updatedObject;
+
+  commit(*liveObject);
+
+  editor.selectedObject = *liveObject;
+  editor.isObjectSelected = true;
+
+  updateCollisionPlanesForObject(context, state, *liveObject);
+  World::rebuildDynamicMeshesForObject(context, *liveObject);
+}
+
+internal void handleHistoryActionApplied(const HistoryAction& action) {
   if (action.type == ActionType::DELETE) {
     // Don't allow the DELETE action type to be explicitly set;
-    // default to POSITION when undoing deletion actions
+    // default to POSITION when undoing/redoing deletion actions
     editor.currentActionType = ActionType::POSITION;
   } else {
     editor.currentActionType = action.type;
   }
 
-  editor.history.pop_back();
+  if (editor.isObjectSelected) {
+    trackSelectedObjectChanges(editor.currentActionType, editor.selectedObject);
+  }
+}
+
+internal void undoLastHistoryAction(GmContext* context, GameState& state) {
+  commitPendingHistoryAction(context);
+
+  if (!History::canUndo(editor.history)) {
+    return;
+  }
+
+  auto action = History::undo(editor.history);
+
+  switch (action.type) {
+    case ActionType::CREATE:
+      removeHistoryObject(context, state, action.record);
+      break;
+    case ActionType::DELETE:
+      restoreHistoryObject(context, state, action.before);
+      break;
+    default:
+      applyHistoryObjectFields(context, state, action.before, action.fields);
+      break;
+  }
+
+  handleHistoryActionApplied(action);
 
   Console::log("[Editor] " + getActionTypeName(action.type) + " action reverted");
 }
 
+internal void redoLastHistoryAction(GmContext* context, GameState& state) {
+  commitPendingHistoryAction(context);
+
+  if (!History::canRedo(editor.history)) {
+    return;
+  }
+
+  auto action = History::redo(editor.history);
+
+  switch (action.type) {
+    case ActionType::CREATE:
+      restoreHistoryObject(context, state, action.after);
+      break;
+    case ActionType::DELETE:
+      removeHistoryObject(context, state, action.record);
+      break;
+    default:
+      applyHistoryObjectFields(context, state, action.after, action.fields);
+      break;
+  }
+
+  handleHistoryActionApplied(action);
+
+  Console::log("[Editor] " + getActionTypeName(action.type) + " action restored");
+}
+
 internal void createNewLight(GmContext* context, GameState& state) {
   auto& camera = get_camera();
   auto& light = create_light(LightType::POINT);
@@ -655,7 +816,7 @@ internal void createNewLight(GmContext* context, GameState& state) {
 
   syncLightWithObject(light, lightSphere);
   createObjectHistoryAction(context, ActionType::CREATE, lightSphere);
-  rebuildCollisionPlanes(context, state);
+  updateCollisionPlanesForObject(context, state, lightSphere);
 
   editor.currentActionType = ActionType::POSITION;
   editor.selectedLight = &light;
@@ -683,14 +844,10 @@ internal void createNewObject(GmContext* context, GameState& state) {
   Vec3f spawnPosition = camera.position + camera.orientation.getDirection() * 300.f;
 
   // Bring the spawn position closer than any objects in front of the camera
-  for (auto& plane : editor.objectCollisionPlanes) {
-    Vec3f start = camera.position;
-    Vec3f end = spawnPosition;
-    auto collision = Collisions::getLinePlaneCollision(start, end, plane);
+  auto hit = Bvh::raycast(editor.objectBvh, camera.position, camera.orientation.getDirection().unit(), 300.f);
 
-    if (collision.hit) {
-      spawnPosition = collision.point;
-    }
+  if (hit.hit) {
+    spawnPosition = hit.point;
   }
 
   if (editor.mode == EditorMode::COLLISION_PLANES) {
@@ -702,6 +859,7 @@ internal void createNewObject(GmContext* context, GameState& state) {
     });
 
     selectObject(context, object);
+    updateCollisionPlanesForObject(context, state, object);
   } else if (editor.mode == EditorMode::OBJECTS) {
     auto& asset = GameMeshes::meshAssets[editor.currentSelectedMeshIndex];
 
@@ -713,12 +871,11 @@ internal void createNewObject(GmContext* context, GameState& state) {
     });
 
     selectObject(context, object);
+    updateCollisionPlanesForObject(context, state, object);
 
-    World::rebuildDynamicMeshes(context);
+    World::rebuildDynamicMeshesForObject(context, object);
   }
 
-  rebuildCollisionPlanes(context, state);
-
   editor.currentActionType = ActionType::POSITION;
 }
 
@@ -733,14 +890,10 @@ internal void cloneSelectedObject(GmContext* context, GameState& state) {
   Vec3f spawnPosition = camera.position + cameraDirection * 500.f;
 
   // Bring the spawn position closer than any objects in front of the camera
-  for (auto& plane : editor.objectCollisionPlanes) {
-    Vec3f start = camera.position;
-    Vec3f end = spawnPosition;
-    auto collision = Collisions::getLinePlaneCollision(start, end, plane);
+  auto hit = Bvh::raycast(editor.objectBvh, camera.position, cameraDirection.unit(), 500.f);
 
-    if (collision.hit) {
-      spawnPosition = collision.point;
-    }
+  if (hit.hit) {
+    spawnPosition = hit.point;
   }
 
   object.position = spawnPosition;
@@ -760,10 +913,10 @@ internal void cloneSelectedObject(GmContext* context, GameState& state) {
 
   selectObject(context, object);
   createObjectHistoryAction(context, ActionType::CREATE, object);
-  rebuildCollisionPlanes(context, state);
+  updateCollisionPlanesForObject(context, state, object);
 
   if (editor.mode == EditorMode::OBJECTS) {
-    World::rebuildDynamicMeshes(context);
+    World::rebuildDynamicMeshesForObject(context, object);
   }
 
   editor.currentActionType = ActionType::POSITION;
@@ -777,10 +930,10 @@ internal void deleteObject(GmContext* context, GameState& state, Object& object)
 
     remove_object(*originalObject);
 
-    rebuildCollisionPlanes(context, state);
+    updateCollisionPlanesForObject(context, state, object);
 
     if (editor.mode == EditorMode::OBJECTS) {
-      World::rebuildDynamicMeshes(context);
+      World::rebuildDynamicMeshesForObject(context, object);
     }
 
     editor.isObjectSelected = false;
@@ -807,9 +960,9 @@ internal void cloneSelectedObjectToPosition(GmContext* context, GameState& state
 
   selectObject(context, object);
   createObjectHistoryAction(context, ActionType::CREATE, object);
-  rebuildCollisionPlanes(context, state);
+  updateCollisionPlanesForObject(context, state, object);
 
-  World::rebuildDynamicMeshes(context);
+  World::rebuildDynamicMeshesForObject(context, object);
 
   editor.currentActionType = ActionType::POSITION;
 }
@@ -834,7 +987,6 @@ internal void respawnPlayer(GmContext* context, GameState& state) {
 }
 
 internal void handleColorCommand(GmContext* context, const std::string& command) {
-  // @todo allow color edits to be undone
   using namespace std;
 
   Vec3f color;
@@ -866,6 +1018,8 @@ internal void handleColorCommand(GmContext* context, const std::string& command)
     if (editor.selectedLight != nullptr) {
       syncLightWithObject(*editor.selectedLight, editor.selectedObject);
     }
+
+    commitPendingHistoryAction(context);
   }
 }
 
@@ -964,10 +1118,28 @@ internal void handleTypeCommand(GmContext* context, const std::string& command)
       return;
     }
 
-    editor.selectedLight->type = type;
+    Gm_SetLightType(context, editor.selectedLight, type);
   }
 }
 
+internal void handleHistoryCommand(const std::string& command) {
+  u32 kilobytes;
+
+  try {
+    auto parts = Gm_SplitString(command, " ");
+
+    kilobytes = (u32)stoi(parts[1]);
+  } catch (const std::exception& e) {
+    Console::warn("Invalid history command");
+
+    return;
+  }
+
+  editor.history.maxBytes = kilobytes * 1024;
+
+  Console::log("[Editor] History limit set to", kilobytes, "KB");
+}
+
 internal void handleStaticCommand(GmContext* context, const std::string& command) {
   if (editor.mode != EditorMode::LIGHTS || editor.selectedLight == nullptr) {
     return;
@@ -982,21 +1154,22 @@ internal void handleStaticCommand(GmContext* context, const std::string& command
   }
 }
 
-internal void saveCollisionPlanesData(GmContext* context, GameState& state) {
-  std::string data;
+internal ObjectSnapshot createObjectSnapshot(const Object& object) {
+  return { object.position, object.scale, object.rotation, object.color };
+}
 
-  for (auto& platform : objects("platform")) {
-    data += Gm_Serialize(platform.position) + ",";
-    data += Gm_Serialize(platform.scale) + ",";
-    data += Gm_Serialize(platform.rotation) + ",";
-    data += Gm_Serialize(platform.color) + "\n";
-  }
+/**
+ * Copies the serializable editor state on the main thread, so
+ * it can safely be written to disk from a background thread.
+ */
+internal LevelSnapshot createLevelSnapshot(GmContext* context, GameState& state) {
+  LevelSnapshot snapshot;
 
-  Gm_WriteFileContents("./game/levels/" + state.currentLevelName + "/data_collision_planes.txt", data);
-}
+  snapshot.levelName = state.currentLevelName;
 
-internal void saveWorldObjectsData(GmContext* context, GameState& state) {
-  std::string data;
+  for (auto& platform : objects("platform")) {
+    snapshot.collisionPlanes.push_back(createObjectSnapshot(platform));
+  }
 
   for (auto& asset : GameMeshes::meshAssets) {
     auto& meshObjects = objects(asset.name);
@@ -1005,43 +1178,118 @@ internal void saveWorldObjectsData(GmContext* context, GameState& state) {
       continue;
     }
 
-    data += "@" + asset.name + "\n";
+    MeshSnapshot meshSnapshot;
+
+    meshSnapshot.meshName = asset.name;
+    meshSnapshot.objects.reserve(meshObjects.totalActive());
 
     for (u16 i = 0; i < meshObjects.getHighestId(); i++) {
       auto* object = meshObjects.getById(i);
 
       if (object != nullptr) {
-        data += Gm_Serialize(object->position) + ",";
-        data += Gm_Serialize(object->scale) + ",";
-        data += Gm_Serialize(object->rotation) + ",";
-        data += Gm_Serialize(object->color) + "\n";        
+        meshSnapshot.objects.push_back(createObjectSnapshot(*object));
       }
     }
+
+    snapshot.meshes.push_back(std::move(meshSnapshot));
+  }
+
+  for (auto* light : context->scene.lights) {
+    if (light->serializable) {
+      snapshot.lights.push_back(*light);
+    }
   }
 
-  Gm_WriteFileContents("./game/levels/" + state.currentLevelName + "/data_world_objects.txt", data);
+  return snapshot;
 }
 
-internal void saveLightsData(GmContext* context, GameState& state) {
-  std::string data;
+internal void writeObjectSnapshot(FileWriter& writer, const ObjectSnapshot& object) {
+  writer
+    .write(object.position).write(',')
+    .write(object.scale).write(',')
+    .write(object.rotation).write(',')
+    .write(object.color).write('\n');
+}
 
-  for (auto* light : context->scene.lights) {
-    if (light->serializable) {
-      data += std::to_string(light->type) + ",";
-      data += Gm_Serialize(light->position) + ",";
-      data += std::to_string(light->radius) + ",";
-      data += Gm_Serialize(light->color) + ",";
-      data += std::to_string(light->basePower) + ",";
-      data += Gm_Serialize(light->direction) + ",";
-      data += std::to_string(light->fov) + ",";
+internal bool saveCollisionPlanesData(const LevelSnapshot& snapshot) {
+  FileWriter writer("./game/levels/" + snapshot.levelName + "/data_collision_planes.txt");
+
+  for (auto& plane : snapshot.collisionPlanes) {
+    writeObjectSnapshot(writer, plane);
+  }
 
-      std::string staticFlag = light->isStatic ? "1" : "0";
+  return writer.close();
+}
 
-      data += staticFlag + "\n";
+internal bool saveWorldObjectsData(const LevelSnapshot& snapshot) {
+  FileWriter writer("./game/levels/" + snapshot.levelName + "/data_world_objects.txt");
+
+  for (auto& meshSnapshot : snapshot.meshes) {
+    writer.write('@').write(meshSnapshot.meshName).write('\n');
+
+    for (auto& object : meshSnapshot.objects) {
+      writeObjectSnapshot(writer, object);
     }
   }
 
-  Gm_WriteFileContents("./game/levels/" + state.currentLevelName + "/data_lights.txt", data);
+  return writer.close();
+}
+
+internal bool saveLightsData(const LevelSnapshot& snapshot) {
+  FileWriter writer("./game/levels/" + snapshot.levelName + "/data_lights.txt");
+
+  for (auto& light : snapshot.lights) {
+    writer
+      .write(light.type).write(',')
+      .write(light.position).write(',')
+      .write(light.radius).write(',')
+      .write(light.color).write(',')
+      .write(light.basePower).write(',')
+      .write(light.direction).write(',')
+      .write(light.fov).write(',')
+      .write(light.isStatic ? '1' : '0').write('\n');
+  }
+
+  return writer.close();
+}
+
+internal bool saveLevelData(const LevelSnapshot& snapshot) {
+  bool didSaveCollisionPlanes = saveCollisionPlanesData(snapshot);
+  bool didSaveWorldObjects = saveWorldObjectsData(snapshot);
+  bool didSaveLights = saveLightsData(snapshot);
+
+  return didSaveCollisionPlanes && didSaveWorldObjects && didSaveLights;
+}
+
+internal void waitForAutosave() {
+  if (editor.autosave.valid() && !editor.autosave.get()) {
+    Console::warn("[Editor] Autosave failed");
+  }
+}
+
+/**
+ * Periodically writes the level data on a background thread.
+ * Only one autosave runs at a time; the snapshot is taken on
+ * the main thread, which is much faster than serializing it.
+ */
+internal void handleAutosave(GmContext* context, GameState& state) {
+  if (editor.autosave.valid()) {
+    if (editor.autosave.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return;
+    }
+
+    waitForAutosave();
+  }
+
+  if (context_time_since(editor.lastAutosaveTime) < AUTOSAVE_INTERVAL) {
+    return;
+  }
+
+  editor.lastAutosaveTime = get_context_time();
+
+  editor.autosave = std::async(std::launch::async, [snapshot = createLevelSnapshot(context, state)]() {
+    return saveLevelData(snapshot);
+  });
 }
 
 internal void handlePositionActionIndicator(GmContext* context) {
@@ -1118,6 +1366,8 @@ namespace Editor {
   void enableGameEditor(GmContext* context, GameState& state) {
     state.isEditorEnabled = true;
 
+    editor.lastAutosaveTime = get_context_time();
+
     // Reset free camera motion to avoid residual deceleration from occuring
     // (e.g. exiting the editor when still decelerating in free camera mode)
     context->scene.freeCameraVelocity = Vec3f(0.f);
@@ -1200,9 +1450,11 @@ namespace Editor {
 
     state.isEditorEnabled = false;
 
-    saveCollisionPlanesData(context, state);
-    saveWorldObjectsData(context, state);
-    saveLightsData(context, state);
+    waitForAutosave();
+
+    if (!saveLevelData(createLevelSnapshot(context, state))) {
+      Console::warn("[Editor] Failed to save level data");
+    }
 
     World::rebuildDynamicMeshes(context);
 
@@ -1322,6 +1574,8 @@ namespace Editor {
           handleTypeCommand(context, command);
         } else if (Gm_StringStartsWith(command, "static")) {
           handleStaticCommand(context, command);
+        } else if (Gm_StringStartsWith(command, "history")) {
+          handleHistoryCommand(command);
         }
       }
     });
@@ -1401,6 +1655,9 @@ namespace Editor {
       }
     }
 
+    // Autosave while objects are in their original state
+    handleAutosave(context, state);
+
     // Find and focus the observed object
     {
       if (editor.currentActionType != ActionType::CREATE) {
@@ -1410,45 +1667,54 @@ namespace Editor {
         Vec3f inverseCameraDirection = cameraDirection.invert();
         float closestDistance = Gm_FLOAT_MAX;
 
-        auto collisionPlanes =
-          editor.mode == EditorMode::OBJECTS ? editor.objectCollisionPlanes :
-          editor.mode == EditorMode::LIGHTS ? editor.lightCollisionPlanes :
-          state.collisionPlanes;
-
-        for (auto& plane : collisionPlanes) {
-          // Early out for non-local collision planes
-          // @todo optimize this further if possible
-          if (camera.position.y > plane.maxY && lineOfSightEnd.y > plane.maxY) continue;
-          if (camera.position.y < plane.minY && lineOfSightEnd.y < plane.minY) continue;
+        if (editor.mode == EditorMode::COLLISION_PLANES) {
+          for (auto& plane : state.collisionPlanes) {
+            // Early out for non-local collision planes
+            // @todo optimize this further if possible
+            if (camera.position.y > plane.maxY && lineOfSightEnd.y > plane.maxY) continue;
+            if (camera.position.y < plane.minY && lineOfSightEnd.y < plane.minY) continue;
 
-          float nDotC = Vec3f::dot(plane.normal, inverseCameraDirection);
+            float nDotC = Vec3f::dot(plane.normal, inverseCameraDirection);
 
-          // Only consider planes facing the camera
-          if (nDotC > 0.f) {
-            auto collision = Collisions::getLinePlaneCollision(camera.position, lineOfSightEnd, plane);
+            // Only consider planes facing the camera
+            if (nDotC > 0.f) {
+              auto collision = Collisions::getLinePlaneCollision(camera.position, lineOfSightEnd, plane);
 
-            if (collision.hit) {
-              // @todo none of the editor features should be enabled when not in developer mode anyway!
-              #if GAMMA_DEVELOPER_MODE
-                auto* object = get_object_by_record(plane.sourceObjectRecord);
-              #else
-                Object* object = nullptr;
-              #endif
+              if (collision.hit) {
+                // @todo none of the editor features should be enabled when not in developer mode anyway!
+                #if GAMMA_DEVELOPER_MODE
+                  auto* object = get_object_by_record(plane.sourceObjectRecord);
+                #else
+                  Object* object = nullptr;
+                #endif
 
-              if (object == nullptr) continue;
+                if (object == nullptr) continue;
 
-              auto distance = (object->position - camera.position).magnitude();
+                auto distance = (object->position - camera.position).magnitude();
 
-              if (
-                distance < closestDistance &&
-                context->scene.meshes[object->_record.meshIndex]->name != "dynamic_collision_box"
-              ) {
-                observeObject(context, *object);
+                if (
+                  distance < closestDistance &&
+                  context->scene.meshes[object->_record.meshIndex]->name != "dynamic_collision_box"
+                ) {
+                  observeObject(context, *object);
 
-                closestDistance = distance;
+                  closestDistance = distance;
+                }
               }
             }
           }
+        } else {
+          // Objects and light spheres are picked using exact ray/hitbox tests
+          auto& bvh = editor.mode == EditorMode::OBJECTS ? editor.objectBvh : editor.lightBvh;
+          auto hit = Bvh::raycast(bvh, camera.position, cameraDirection, MAX_DISTANCE);
+
+          if (hit.hit) {
+            auto* object = get_object_by_record(hit.record);
+
+            if (object != nullptr) {
+              observeObject(context, *object);
+            }
+          }
         }
       }
     }
@@ -1473,6 +1739,8 @@ namespace Editor {
         if (editor.isObservingObject || editor.isObjectSelected) {
           if (input.didRightClickMouse()) {
             // Object deselection
+            commitPendingHistoryAction(context);
+
             editor.isObjectSelected = false;
           } else {
             // Check to ensure that we're observing an object before
@@ -1496,11 +1764,14 @@ namespace Editor {
       }
 
       #define CTRL_Z input.isKeyHeld(Key::CONTROL) && input.didPressKey(Key::Z)
+      #define CTRL_Y input.isKeyHeld(Key::CONTROL) && input.didPressKey(Key::Y)
       #define CTRL_V input.isKeyHeld(Key::CONTROL) && input.didPressKey(Key::V)
 
       // Handle shortcut keys
       if (CTRL_Z) {
         undoLastHistoryAction(context, state);
+      } else if (CTRL_Y) {
+        redoLastHistoryAction(context, state);
       } else if (CTRL_V && editor.isObjectSelected) {
         cloneSelectedObject(context, state);
       } else if (input.didPressKey(Key::R)) {
@@ -1664,14 +1935,14 @@ namespace Editor {
             // Create a new collision plane aligned with the selected object
             Vec3f hitboxScale = GameMeshes::meshAssets[editor.currentSelectedMeshIndex].hitboxScale;
 
-            createNewObjectFromMesh(context, "platform", {
+            auto& platform = createNewObjectFromMesh(context, "platform", {
               .position = selectedObject.position + Vec3f(0, 0.5f, 0),
               .scale = selectedObject.scale * hitboxScale,
               .rotation = selectedObject.rotation,
               .color = Vec3f(0, 0, 1.f)
             });
 
-            rebuildCollisionPlanes(context, state);
+            updateCollisionPlanesForObject(context, state, platform);
 
             mesh("platform")->disabled = false;
           }
@@ -1691,8 +1962,9 @@ namespace Editor {
       }
 
       if (input.didReleaseMouse() && editor.isObjectSelected) {
-        rebuildCollisionPlanes(context, state);
-        World::rebuildDynamicMeshes(context);
+        commitPendingHistoryAction(context);
+        updateCollisionPlanesForObject(context, state, editor.selectedObject);
+        World::rebuildDynamicMeshesForObject(context, editor.selectedObject);
       }
     }
 
@@ -1713,6 +1985,7 @@ namespace Editor {
     {
       add_debug_message(getEditorModeName(editor.mode) + " Editor" + (editor.isGiantMode ? " (GIANT)" : ""));
       add_debug_message("Camera position: " + Gm_ToDebugString(camera.position));
+      add_debug_message("History: " + std::to_string(editor.history.totalApplied) + " actions (" + std::to_string(History::getFootprint(editor.history)) + " bytes)");
 
       add_debug_message("Action: "
         + getActionTypeName(editor.currentActionType)
@@ -1774,7 +2047,9 @@ namespace Editor {
   }
 
   void resetGameEditor() {
-    editor.history.clear();
+    History::clear(editor.history);
+
+    editor.hasPendingAction = false;
 
     editor.selectedLight = nullptr;
     editor.isObservingObject = false;
@@ -0,0 +1,258 @@
+#include <cstring>
+
+#include "editor_history.h"
+#include "macros.h"
+
+using namespace Gamma;
+
+// Header: type (1 byte), fields (1 byte), record (6 bytes)
+constexpr static u32 ENTRY_HEADER_SIZE = 2 + sizeof(ObjectRecord);
+constexpr static float COALESCE_WINDOW = 0.5f;
+
+internal void writeBytes(TrackedVector<u8, MEMORY_EDITOR>& bytes, const void* source, u32 size) {
+  auto* data = (const u8*)source;
+
+  bytes.insert(bytes.end(), data, data + size);
+}
+
+internal void writeFields(TrackedVector<u8, MEMORY_EDITOR>& bytes, const Object& object, u8 fields) {
+  if (fields & FIELD_POSITION) writeBytes(bytes, &object.position, sizeof(Vec3f));
+  if (fields & FIELD_SCALE) writeBytes(bytes, &object.scale, sizeof(Vec3f));
+  if (fields & FIELD_ROTATION) writeBytes(bytes, &object.rotation, sizeof(Quaternion));
+  if (fields & FIELD_COLOR) writeBytes(bytes, &object.color, sizeof(pVec4));
+}
+
+internal u32 readFields(const u8* data, Object& object, u8 fields) {
+  u32 offset = 0;
+
+  #define read_field(flag, field, type)\
+    if (fields & flag) {\
+      memcpy(&object.field, data + offset, sizeof(type));\
+      offset += sizeof(type);\
+    }
+
+  read_field(FIELD_POSITION, position, Vec3f);
+  read_field(FIELD_SCALE, scale, Vec3f);
+  read_field(FIELD_ROTATION, rotation, Quaternion);
+  read_field(FIELD_COLOR, color, pVec4);
+
+  return offset;
+}
+
+internal u32 getFieldsSize(u8 fields) {
+  u32 size = 0;
+
+  if (fields & FIELD_POSITION) size += sizeof(Vec3f);
+  if (fields & FIELD_SCALE) size += sizeof(Vec3f);
+  if (fields & FIELD_ROTATION) size += sizeof(Quaternion);
+  if (fields & FIELD_COLOR) size += sizeof(pVec4);
+
+  return size;
+}
+
+internal HistoryAction decodeAction(const HistoryLog& log, u32 index) {
+  HistoryAction action;
+  const u8* data = log.bytes.data() + log.offsets[index];
+
+  action.type = (ActionType)data[0];
+  action.fields = data[1];
+
+  memcpy(&action.record, data + 2, sizeof(ObjectRecord));
+
+  action.before._record = action.record;
+  action.after._record = action.record;
+
+  u32 offset = ENTRY_HEADER_SIZE;
+
+  if (action.type != ActionType::CREATE) {
+    offset += readFields(data + offset, action.before, action.fields);
+  }
+
+  if (action.type != ActionType::DELETE) {
+    readFields(data + offset, action.after, action.fields);
+  }
+
+  return action;
+}
+
+internal bool isSameRecord(const ObjectRecord& a, const ObjectRecord& b) {
+  return a.meshIndex == b.meshIndex && a.id == b.id && a.generation == b.generation;
+}
+
+/**
+ * Determines whether an action can be merged into the most recent
+ * one, e.g. for consecutive drags on the same object in quick succession.
+ */
+internal bool canCoalesce(const HistoryLog& log, const HistoryAction& action, float time) {
+  if (
+    log.totalApplied == 0 ||
+    log.totalApplied != log.offsets.size() ||
+    action.type == ActionType::CREATE ||
+    action.type == ActionType::DELETE ||
+    time - log.lastPushTime > COALESCE_WINDOW
+  ) {
+    return false;
+  }
+
+  const u8* data = log.bytes.data() + log.offsets[log.totalApplied - 1];
+  ObjectRecord record;
+
+  memcpy(&record, data + 2, sizeof(ObjectRecord));
+
+  return (
+    data[0] == (u8)action.type &&
+    data[1] == action.fields &&
+    isSameRecord(record, action.record)
+  );
+}
+
+/**
+ * Discards the oldest entries once the log exceeds its byte
+ * limit. Entries are discarded until the log is back under
+ * 3/4 of the limit, so trimming (and reallocating) doesn't
+ * occur on every push.
+ */
+internal void trimHistoryLog(HistoryLog& log) {
+  if (log.bytes.size() <= log.maxBytes || log.offsets.size() < 2) {
+    return;
+  }
+
+  u32 target = log.maxBytes / 4 * 3;
+  u32 totalDiscarded = 0;
+
+  // Always keep the most recent entry
+  while (
+    totalDiscarded < log.offsets.size() - 1 &&
+    log.bytes.size() - log.offsets[totalDiscarded] > target
+  ) {
+    totalDiscarded++;
+  }
+
+  u32 shift = log.offsets[totalDiscarded];
+
+  log.bytes.erase(log.bytes.begin(), log.bytes.begin() + shift);
+  log.offsets.erase(log.offsets.begin(), log.offsets.begin() + totalDiscarded);
+
+  for (auto& offset : log.offsets) {
+    offset -= shift;
+  }
+
+  // Release the discarded capacity, since the log's footprint
+  // is measured by what it has allocated
+  log.bytes.shrink_to_fit();
+  log.offsets.shrink_to_fit();
+
+  log.totalApplied = log.totalApplied > totalDiscarded ? log.totalApplied - totalDiscarded : 0;
+}
+
+bool History::canRedo(const HistoryLog& log) {
+  return log.totalApplied < log.offsets.size();
+}
+
+bool History::canUndo(const HistoryLog& log) {
+  return log.totalApplied > 0;
+}
+
+void History::clear(HistoryLog& log) {
+  log.bytes.clear();
+  log.offsets.clear();
+  log.totalApplied = 0;
+  log.lastPushTime = 0.f;
+}
+
+u8 History::getChangedFields(const Object& a, const Object& b) {
+  u8 fields = 0;
+
+  if (a.position != b.position) fields |= FIELD_POSITION;
+  if (a.scale != b.scale) fields |= FIELD_SCALE;
+  if (!(a.rotation == b.rotation)) fields |= FIELD_ROTATION;
+  if (!(a.color == b.color)) fields |= FIELD_COLOR;
+
+  return fields;
+}
+
+/**
+ * History::getFootprint
+ * ---------------------
+ *
+ * Returns the number of bytes allocated for the log.
+ */
+u32 History::getFootprint(const HistoryLog& log) {
+  return u32(log.bytes.capacity() + log.offsets.capacity() * sizeof(u32));
+}
+
+/**
+ * History::push
+ * -------------
+ *
+ * Appends an action to the log, discarding any actions which
+ * could have been redone. Actions matching the most recent one
+ * are merged into it, keeping its initial 'before' state.
+ */
+void History::push(HistoryLog& log, const HistoryAction& action, float time) {
+  if (log.totalApplied < log.offsets.size()) {
+    log.bytes.resize(log.offsets[log.totalApplied]);
+    log.offsets.resize(log.totalApplied);
+  }
+
+  if (canCoalesce(log, action, time)) {
+    u32 offset = log.offsets.back() + ENTRY_HEADER_SIZE + getFieldsSize(action.fields);
+
+    log.bytes.resize(offset);
+
+    writeFields(log.bytes, action.after, action.fields);
+
+    log.lastPushTime = time;
+
+    return;
+  }
+
+  log.offsets.push_back((u32)log.bytes.size());
+
+  log.bytes.push_back((u8)action.type);
+  log.bytes.push_back(action.fields);
+
+  writeBytes(log.bytes, &action.record, sizeof(ObjectRecord));
+
+  if (action.type != ActionType::CREATE) {
+    writeFields(log.bytes, action.before, action.fields);
+  }
+
+  if (action.type != ActionType::DELETE) {
+    writeFields(log.bytes, action.after, action.fields);
+  }
+
+  log.totalApplied++;
+  log.lastPushTime = time;
+
+  trimHistoryLog(log);
+}
+
+HistoryAction History::redo(HistoryLog& log) {
+  return decodeAction(log, log.totalApplied++);
+}
+
+/**
+ * History::replaceRecord
+ * ----------------------
+ *
+ * Updates entries referring to an object which was recreated,
+ * e.g. when undoing a deletion, since recreated objects may
+ * use a different ID/generation than the original.
+ */
+void History::replaceRecord(HistoryLog& log, const ObjectRecord& from, const ObjectRecord& to) {
+  for (auto offset : log.offsets) {
+    u8* data = log.bytes.data() + offset;
+    ObjectRecord record;
+
+    memcpy(&record, data + 2, sizeof(ObjectRecord));
+
+    if (isSameRecord(record, from)) {
+      memcpy(data + 2, &to, sizeof(ObjectRecord));
+    }
+  }
+}
+
+HistoryAction History::undo(HistoryLog& log) {
+  return decodeAction(log, --log.totalApplied);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include "Gamma.h"
+
+enum ActionType {
+  CREATE,
+  DELETE,
+  POSITION,
+  SCALE,
+  ROTATE,
+  COLOR
+};
+
+enum HistoryField {
+  FIELD_POSITION = 1 << 0,
+  FIELD_SCALE = 1 << 1,
+  FIELD_ROTATION = 1 << 2,
+  FIELD_COLOR = 1 << 3,
+  FIELD_ALL = FIELD_POSITION | FIELD_SCALE | FIELD_ROTATION | FIELD_COLOR
+};
+
+/**
+ * HistoryAction
+ * -------------
+ *
+ * A decoded editor history entry. Only the fields in the
+ * 'fields' mask of 'before' and 'after' are meaningful.
+ * CREATE actions only store 'after', and DELETE actions
+ * only store 'before'.
+ */
+struct HistoryAction {
+  ActionType type;
+  Gamma::ObjectRecord record;
+  u8 fields = 0;
+  Gamma::Object before;
+  Gamma::Object after;
+};
+
+/**
+ * HistoryLog
+ * ----------
+ *
+ * A bounded log of packed editor history actions. Entries
+ * before 'totalApplied' can be undone, and entries after it
+ * can be redone. The oldest entries are discarded once the
+ * log exceeds 'maxBytes'.
+ */
+struct HistoryLog {
+  Gamma::TrackedVector<u8, Gamma::MEMORY_EDITOR> bytes;
+  Gamma::TrackedVector<u32, Gamma::MEMORY_EDITOR> offsets;
+  u32 totalApplied = 0;
+  u32 maxBytes = 256 * 1024;
+  float lastPushTime = 0.f;
+};
+
+namespace History {
+  bool canRedo(const HistoryLog& log);
+  bool canUndo(const HistoryLog& log);
+  void clear(HistoryLog& log);
+  u8 getChangedFields(const Gamma::Object& a, const Gamma::Object& b);
+  u32 getFootprint(const HistoryLog& log);
+  void push(HistoryLog& log, const HistoryAction& action, float time);
+  HistoryAction redo(HistoryLog& log);
+  void replaceRecord(HistoryLog& log, const Gamma::ObjectRecord& from, const Gamma::ObjectRecord& to);
+  HistoryAction undo(HistoryLog& log);
+}
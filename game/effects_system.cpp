@@ -423,14 +423,11 @@ void EffectsSystem::updateDayNightCycleLighting(GmContext* context, GameState& s
   {
     float lightPowerFactor = powf(Gm_Clampf(0.5f - sinf(state.dayNightCycleTime)), 1.f / 3.f);
 
-    for (auto* light : context->scene.lights) {
-      if (
-        light->serializable &&
-        !light->isStatic &&
-        light->type != LightType::DIRECTIONAL &&
-        light->type != LightType::DIRECTIONAL_SHADOWCASTER
-      ) {
-        light->power = light->basePower * lightPowerFactor;
+    for (auto type : { LightType::POINT, LightType::SPOT, LightType::POINT_SHADOWCASTER, LightType::SPOT_SHADOWCASTER }) {
+      for (auto* light : context->scene.lights.getLightsByType(type)) {
+        if (light->serializable && !light->isStatic) {
+          light->power = light->basePower * lightPowerFactor;
+        }
       }
     }
   }
@@ -22,30 +22,6 @@
 
 using namespace Gamma;
 
-/**
- * Adapted from http://paulbourke.net/miscellaneous/interpolation/
- *
- * Performs cubic spline interpolation.
- */
-internal float interpolateCubicSpline(float a, float b, float c, float d, float alpha) {
-  float m = alpha * alpha;
-
-  float a0 = d - c - a + b;
-  float a1 = a - b - a0;
-  float a2 = c - a;
-  float a3 = b;
-  
-  return (a0 * alpha * m) + (a1 * m) + (a2 * alpha) + a3;
-}
-
-internal Vec3f interpolateCubicSpline(const Vec3f& a, const Vec3f& b, const Vec3f& c, const Vec3f& d, float alpha) {
-  return Vec3f(
-    interpolateCubicSpline(a.x, b.x, c.x, d.x, alpha),
-    interpolateCubicSpline(a.y, b.y, c.y, d.y, alpha),
-    interpolateCubicSpline(a.z, b.z, c.z, d.z, alpha)
-  );
-}
-
 internal u32 getWrappedIndex(s32 index, u32 total) {
   if (index < 0) {
     return u32(total + index);
@@ -88,7 +64,7 @@ internal void addJetstream(GmContext* context, GameState& state, const std::vect
       float alpha = completion - u32(completion);
       u32 currentIndex = u32(std::floorf(completion));
 
-      Vec3f streamPoint = interpolateCubicSpline(
+      Vec3f streamPoint = Vec3f::cubicSpline(
         points[getWrappedIndex(currentIndex - 1, points.size())],
         points[getWrappedIndex(currentIndex, points.size())],
         points[getWrappedIndex(currentIndex + 1, points.size())],
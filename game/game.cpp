@@ -109,6 +109,8 @@ internal void initializeInputHandlers(GmContext* context, GameState& state) {
         handleTimeCommand(context, state, command);
       } else if (Gm_StringStartsWith(command, "level")) {
         handleLevelCommand(context, state, command);
+      } else if (command == "memory") {
+        Gm_DumpMemoryStats();
       }
     });
   #endif
@@ -198,8 +200,8 @@ void updateGame(GmContext* context, GameState& state, float dt) {
     {
       add_debug_message("Player position: " + Gm_ToDebugString(player.position));
       add_debug_message("Player velocity: " + Gm_ToDebugString(state.velocity));
-      add_debug_message("Day/Night cycle time: " + std::to_string(state.dayNightCycleTime));
-      add_debug_message("Game speed: " + std::to_string(state.gameSpeed));
+      add_debug_message(Gm_FrameFormat("Day/Night cycle time: %f", state.dayNightCycleTime));
+      add_debug_message(Gm_FrameFormat("Game speed: %f", state.gameSpeed));
     }
   #endif
 
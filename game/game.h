@@ -41,14 +41,31 @@ struct Jetstream {
 
 struct Vehicle {
   Gamma::ObjectRecord object;
-  u32 trackPointTarget;
-  float trackSectionStartAngle;
   float speed;
+  // Distance traveled along the track
+  float distance = 0.f;
+  // The track sample preceding the vehicle's position
+  u32 sampleIndex = 0;
+};
+
+/**
+ * TrackSample
+ * -----------
+ *
+ * A point along the spline through a vehicle track's
+ * points, with its precomputed arc length and heading.
+ */
+struct TrackSample {
+  Gamma::Vec3f position;
+  float distance = 0.f;
+  float angle = 0.f;
 };
 
 struct VehicleTrack {
   std::vector<Gamma::Vec3f> points;
   std::vector<Gamma::Vec3f> stops;
+  std::vector<TrackSample> samples;
+  float length = 0.f;
 
   std::vector<Vehicle> vehicles;
 };
@@ -169,7 +186,7 @@ struct GameState {
   // @todo use in dev mode only
   bool isEditorEnabled = false;
 
-  std::vector<Plane> collisionPlanes;
+  Gamma::TrackedVector<Plane, Gamma::MEMORY_COLLISION> collisionPlanes;
   std::vector<Gamma::Object> initialMovingObjects;
   std::vector<NonPlayerCharacter> npcs;
   std::vector<Slingshot> slingshots;
@@ -0,0 +1,234 @@
+#include <cstring>
+
+#include "object_staging.h"
+#include "macros.h"
+
+using namespace Gamma;
+
+/**
+ * ObjectStaging::build
+ * --------------------
+ *
+ * Runs each builder in parallel, returning a staging buffer
+ * per builder in the same order as the builders. Builders may
+ * read from the scene, but must not modify it.
+ */
+std::vector<StagingBuffer> ObjectStaging::build(const std::vector<StagingBuilder>& builders) {
+  std::vector<StagingBuffer> buffers(builders.size());
+
+  Gm_ParallelFor((u32)builders.size(), [&](u32 i) {
+    builders[i](buffers[i]);
+  });
+
+  return buffers;
+}
+
+internal u64 getSourceKey(const ObjectRecord& record) {
+  return (u64(record.meshIndex) << 32) | (u64(record.id) << 16) | u64(record.generation);
+}
+
+/**
+ * ObjectStaging::commitBuffer
+ * ---------------------------
+ *
+ * Creates the staged objects and lights in the scene, in the
+ * order they were staged, tracking which source objects they
+ * were generated from.
+ */
+void ObjectStaging::commitBuffer(GmContext* context, StagingBuffer& buffer, GeneratedObjects& generated) {
+  for (auto& staged : buffer.objects) {
+    auto& object = create_object_from(staged.object._record.meshIndex);
+
+    object.position = staged.object.position;
+    object.scale = staged.object.scale;
+    object.rotation = staged.object.rotation;
+    object.color = staged.object.color;
+
+    commit(object);
+
+    for (u8 i = 0; i < staged.totalSources; i++) {
+      generated.objects[getSourceKey(staged.sources[i])].push_back(object._record);
+    }
+  }
+
+  for (auto& staged : buffer.lights) {
+    auto& light = create_light((LightType)staged.light.type);
+
+    light = staged.light;
+
+    if (staged.hasSource) {
+      generated.lights[getSourceKey(staged.source)].push_back(&light);
+    } else {
+      generated.unsourcedLights.push_back(&light);
+    }
+  }
+}
+
+Light& ObjectStaging::createLight(StagingBuffer& buffer, LightType type) {
+  StagedLight staged;
+
+  staged.light.type = type;
+
+  buffer.lights.push_back(staged);
+
+  return buffer.lights.back().light;
+}
+
+/**
+ * ObjectStaging::createLight
+ * --------------------------
+ *
+ * Stages a light generated from a source object, so it can
+ * be associated with the source once committed.
+ */
+Light& ObjectStaging::createLight(StagingBuffer& buffer, LightType type, const Object& source) {
+  auto& light = ObjectStaging::createLight(buffer, type);
+  auto& staged = buffer.lights.back();
+
+  staged.source = source._record;
+  staged.hasSource = true;
+
+  return light;
+}
+
+Object& ObjectStaging::createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName) {
+  StagedObject staged;
+
+  staged.object._record.meshIndex = mesh(meshName)->index;
+  staged.object.position = Vec3f(0.f);
+  staged.object.rotation = Quaternion(1.f, 0, 0, 0);
+  staged.object.scale = Vec3f(1.f);
+
+  buffer.objects.push_back(staged);
+
+  return buffer.objects.back().object;
+}
+
+/**
+ * ObjectStaging::createObject
+ * ---------------------------
+ *
+ * Stages an object generated from a source object, so it can
+ * be associated with the source once committed.
+ */
+Object& ObjectStaging::createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName, const Object& source) {
+  auto& object = ObjectStaging::createObject(context, buffer, meshName);
+  auto& staged = buffer.objects.back();
+
+  staged.sources[0] = source._record;
+  staged.totalSources = 1;
+
+  return object;
+}
+
+/**
+ * ObjectStaging::createObject
+ * ---------------------------
+ *
+ * Stages an object generated from a pair of source objects,
+ * e.g. a wire span between two poles, so it can be replaced
+ * when either source changes.
+ */
+Object& ObjectStaging::createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName, const Object& source, const Object& otherSource) {
+  auto& object = ObjectStaging::createObject(context, buffer, meshName);
+  auto& staged = buffer.objects.back();
+
+  staged.sources[0] = source._record;
+  staged.sources[1] = otherSource._record;
+  staged.totalSources = 2;
+
+  return object;
+}
+
+/**
+ * ObjectStaging::getSeed
+ * ----------------------
+ *
+ * Returns a random seed derived from a position, so objects
+ * generated from a source object are the same regardless of
+ * which thread generates them.
+ */
+u32 ObjectStaging::getSeed(const Vec3f& position) {
+  u32 x, y, z;
+
+  memcpy(&x, &position.x, sizeof(u32));
+  memcpy(&y, &position.y, sizeof(u32));
+  memcpy(&z, &position.z, sizeof(u32));
+
+  u32 seed = x * 73856093u ^ y * 19349663u ^ z * 83492791u;
+
+  return seed != 0 ? seed : 1;
+}
+
+/**
+ * ObjectStaging::random
+ * ---------------------
+ *
+ * Returns a random value between low and high, advancing
+ * the seed (xorshift32).
+ */
+float ObjectStaging::random(u32& seed, float low, float high) {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return low + float(seed & 0xffffff) / float(0xffffff) * (high - low);
+}
+
+/**
+ * ObjectStaging::removeGeneratedObjects
+ * -------------------------------------
+ *
+ * Removes the objects and lights generated from a source
+ * object. Objects generated from a pair of sources remain
+ * listed under the other source, but since they no longer
+ * exist, they're skipped when it's removed.
+ */
+void ObjectStaging::removeGeneratedObjects(GmContext* context, GeneratedObjects& generated, const ObjectRecord& source) {
+  auto key = getSourceKey(source);
+  auto objectsEntry = generated.objects.find(key);
+  auto lightsEntry = generated.lights.find(key);
+
+  if (objectsEntry != generated.objects.end()) {
+    for (auto& record : objectsEntry->second) {
+      auto* object = get_object_by_record(record);
+
+      if (object != nullptr) {
+        remove_object(*object);
+      }
+    }
+
+    generated.objects.erase(objectsEntry);
+  }
+
+  if (lightsEntry != generated.lights.end()) {
+    for (auto* light : lightsEntry->second) {
+      remove_light(light);
+    }
+
+    generated.lights.erase(lightsEntry);
+  }
+}
+
+/**
+ * ObjectStaging::resetGeneratedObjects
+ * ------------------------------------
+ *
+ * Removes all generated lights and stops tracking generated
+ * objects, ahead of the generated object pools being reset.
+ */
+void ObjectStaging::resetGeneratedObjects(GmContext* context, GeneratedObjects& generated) {
+  for (auto& [ key, lights ] : generated.lights) {
+    for (auto* light : lights) {
+      remove_light(light);
+    }
+  }
+
+  for (auto* light : generated.unsourcedLights) {
+    remove_light(light);
+  }
+
+  generated.objects.clear();
+  generated.lights.clear();
+  generated.unsourcedLights.clear();
+}
\ No newline at end of file
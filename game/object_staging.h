@@ -0,0 +1,77 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Gamma.h"
+
+struct StagedObject {
+  Gamma::Object object;
+  // The objects this object was generated from, if any.
+  // Wire spans are generated from both of their end points.
+  Gamma::ObjectRecord sources[2];
+  u8 totalSources = 0;
+};
+
+struct StagedLight {
+  Gamma::Light light;
+  Gamma::ObjectRecord source;
+  bool hasSource = false;
+};
+
+/**
+ * StagingBuffer
+ * -------------
+ *
+ * Collects the objects and lights generated by a builder
+ * without modifying the scene, so builders can run in
+ * parallel. Buffers are committed to the scene in a fixed
+ * order, producing the same objects as running the builders
+ * one after another.
+ */
+struct StagingBuffer {
+  // A deque keeps references to staged objects stable
+  std::deque<StagedObject, Gamma::TrackedAllocator<StagedObject, Gamma::MEMORY_PROCEDURAL>> objects;
+  Gamma::TrackedVector<StagedLight, Gamma::MEMORY_PROCEDURAL> lights;
+};
+
+/**
+ * GeneratedObjects
+ * ----------------
+ *
+ * Maps source objects to the objects and lights generated
+ * from them, so the editor can replace the generated objects
+ * of a single edited source instead of rebuilding them all.
+ */
+struct GeneratedObjects {
+  std::map<u64, std::vector<Gamma::ObjectRecord>> objects;
+  std::map<u64, std::vector<Gamma::Light*>> lights;
+  // Lights committed without a source, e.g. when restored
+  // from the procedural cache
+  std::vector<Gamma::Light*> unsourcedLights;
+};
+
+typedef std::function<void(StagingBuffer&)> StagingBuilder;
+
+namespace ObjectStaging {
+  std::vector<StagingBuffer> build(const std::vector<StagingBuilder>& builders);
+  void commitBuffer(GmContext* context, StagingBuffer& buffer, GeneratedObjects& generated);
+  Gamma::Light& createLight(StagingBuffer& buffer, Gamma::LightType type);
+  Gamma::Light& createLight(StagingBuffer& buffer, Gamma::LightType type, const Gamma::Object& source);
+  Gamma::Object& createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName);
+  Gamma::Object& createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName, const Gamma::Object& source);
+  Gamma::Object& createObject(GmContext* context, StagingBuffer& buffer, const std::string& meshName, const Gamma::Object& source, const Gamma::Object& otherSource);
+  u32 getSeed(const Gamma::Vec3f& position);
+  float random(u32& seed, float low, float high);
+  void removeGeneratedObjects(GmContext* context, GeneratedObjects& generated, const Gamma::ObjectRecord& source);
+  void resetGeneratedObjects(GmContext* context, GeneratedObjects& generated);
+}
+
+#define stage_object(meshName) ObjectStaging::createObject(context, staging, meshName)
+#define stage_generated_object(meshName, source) ObjectStaging::createObject(context, staging, meshName, source)
+#define stage_span_object(meshName, source, otherSource) ObjectStaging::createObject(context, staging, meshName, source, otherSource)
+#define stage_light(type) ObjectStaging::createLight(staging, type)
+#define stage_generated_light(type, source) ObjectStaging::createLight(staging, type, source)
@@ -0,0 +1,302 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "procedural_cache.h"
+#include "macros.h"
+#include "system/FileWriter.h"
+
+using namespace Gamma;
+
+// Bump whenever a builder changes its output, so stale
+// caches are regenerated rather than loaded
+constexpr static u32 CACHE_VERSION = 3;
+// "CRPC"
+constexpr static u32 CACHE_MAGIC = 0x43505243;
+
+struct CacheReader {
+  std::string bytes;
+  u32 offset = 0;
+
+  bool read(void* destination, u32 size) {
+    if (offset + size > bytes.size()) {
+      return false;
+    }
+
+    memcpy(destination, bytes.data() + offset, size);
+
+    offset += size;
+
+    return true;
+  }
+};
+
+/**
+ * Lights are written field by field, rather than as raw
+ * structs, so the cache doesn't depend on the Light layout
+ * or padding.
+ */
+internal void writeLight(FileWriter& writer, const Light& light) {
+  u8 isStatic = light.isStatic ? 1 : 0;
+  u8 serializable = light.serializable ? 1 : 0;
+
+  writer.write(&light.position, sizeof(Vec3f));
+  writer.write(&light.radius, sizeof(float));
+  writer.write(&light.color, sizeof(Vec3f));
+  writer.write(&light.direction, sizeof(Vec3f));
+  writer.write(&light.fov, sizeof(float));
+  writer.write(&light.power, sizeof(float));
+  writer.write(&light.basePower, sizeof(float));
+  writer.write(&light.type, sizeof(u32));
+  writer.write(&isStatic, sizeof(u8));
+  writer.write(&serializable, sizeof(u8));
+}
+
+internal bool readLight(CacheReader& reader, Light& light) {
+  u8 isStatic;
+  u8 serializable;
+
+  if (
+    !reader.read(&light.position, sizeof(Vec3f)) ||
+    !reader.read(&light.radius, sizeof(float)) ||
+    !reader.read(&light.color, sizeof(Vec3f)) ||
+    !reader.read(&light.direction, sizeof(Vec3f)) ||
+    !reader.read(&light.fov, sizeof(float)) ||
+    !reader.read(&light.power, sizeof(float)) ||
+    !reader.read(&light.basePower, sizeof(float)) ||
+    !reader.read(&light.type, sizeof(u32)) ||
+    !reader.read(&isStatic, sizeof(u8)) ||
+    !reader.read(&serializable, sizeof(u8))
+  ) {
+    return false;
+  }
+
+  light.isStatic = isStatic != 0;
+  light.serializable = serializable != 0;
+
+  return true;
+}
+
+internal void writeBuffers(FileWriter& writer, const std::vector<StagingBuffer>& buffers, std::map<u16, u16>& nameIndices) {
+  u32 totalBuffers = (u32)buffers.size();
+
+  writer.write(&totalBuffers, sizeof(u32));
+
+  for (auto& buffer : buffers) {
+    u32 totalObjects = (u32)buffer.objects.size();
+    u32 totalLights = (u32)buffer.lights.size();
+
+    writer.write(&totalObjects, sizeof(u32));
+
+    for (auto& staged : buffer.objects) {
+      auto& object = staged.object;
+      u16 nameIndex = nameIndices.at(object._record.meshIndex);
+
+      writer.write(&nameIndex, sizeof(u16));
+      writer.write(&object.position, sizeof(Vec3f));
+      writer.write(&object.scale, sizeof(Vec3f));
+      writer.write(&object.rotation, sizeof(Quaternion));
+      writer.write(&object.color, sizeof(pVec4));
+    }
+
+    writer.write(&totalLights, sizeof(u32));
+
+    for (auto& staged : buffer.lights) {
+      writeLight(writer, staged.light);
+    }
+  }
+}
+
+internal bool readBuffers(CacheReader& reader, std::vector<StagingBuffer>& buffers, const std::vector<u16>& meshIndices) {
+  u32 totalBuffers;
+
+  if (!reader.read(&totalBuffers, sizeof(u32))) {
+    return false;
+  }
+
+  buffers.resize(totalBuffers);
+
+  for (auto& buffer : buffers) {
+    u32 totalObjects;
+    u32 totalLights;
+
+    if (!reader.read(&totalObjects, sizeof(u32))) {
+      return false;
+    }
+
+    for (u32 i = 0; i < totalObjects; i++) {
+      StagedObject staged;
+      auto& object = staged.object;
+      u16 nameIndex;
+
+      if (
+        !reader.read(&nameIndex, sizeof(u16)) ||
+        nameIndex >= meshIndices.size() ||
+        !reader.read(&object.position, sizeof(Vec3f)) ||
+        !reader.read(&object.scale, sizeof(Vec3f)) ||
+        !reader.read(&object.rotation, sizeof(Quaternion)) ||
+        !reader.read(&object.color, sizeof(pVec4))
+      ) {
+        return false;
+      }
+
+      object._record.meshIndex = meshIndices[nameIndex];
+
+      buffer.objects.push_back(staged);
+    }
+
+    if (!reader.read(&totalLights, sizeof(u32))) {
+      return false;
+    }
+
+    buffer.lights.resize(totalLights);
+
+    for (auto& staged : buffer.lights) {
+      if (!readLight(reader, staged.light)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * ProceduralCache::getInputHash
+ * -----------------------------
+ *
+ * Returns an FNV-1a hash of the data the generated meshes
+ * are derived from, e.g. the level's world object data.
+ */
+u64 ProceduralCache::getInputHash(std::string_view data) {
+  u64 hash = 0xcbf29ce484222325;
+
+  for (auto c : data) {
+    hash ^= u8(c);
+    hash *= 0x100000001b3;
+  }
+
+  return hash;
+}
+
+/**
+ * ProceduralCache::load
+ * ---------------------
+ *
+ * Reads cached generated meshes, provided the cache exists
+ * and was produced from the same inputs. Returns false if the
+ * meshes need to be regenerated.
+ */
+bool ProceduralCache::load(GmContext* context, const std::string& path, u64 inputHash, GeneratedMeshes& meshes) {
+  std::ifstream file(path, std::ios::binary);
+
+  if (file.fail()) {
+    return false;
+  }
+
+  CacheReader reader;
+
+  reader.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+  file.close();
+
+  u32 magic;
+  u32 version;
+  u64 hash;
+  u32 totalMeshNames;
+
+  if (
+    !reader.read(&magic, sizeof(u32)) ||
+    !reader.read(&version, sizeof(u32)) ||
+    !reader.read(&hash, sizeof(u64)) ||
+    magic != CACHE_MAGIC ||
+    version != CACHE_VERSION ||
+    hash != inputHash ||
+    !reader.read(&totalMeshNames, sizeof(u32))
+  ) {
+    return false;
+  }
+
+  // Mesh indices depend on mesh registration order, so
+  // the cache refers to meshes by name
+  std::vector<u16> meshIndices;
+  auto& meshMap = context->scene.meshMap;
+
+  for (u32 i = 0; i < totalMeshNames; i++) {
+    u32 length;
+    std::string name;
+
+    if (!reader.read(&length, sizeof(u32)) || reader.offset + length > reader.bytes.size()) {
+      return false;
+    }
+
+    name.assign(reader.bytes.data() + reader.offset, length);
+
+    reader.offset += length;
+
+    if (meshMap.find(name) == meshMap.end()) {
+      return false;
+    }
+
+    meshIndices.push_back(meshMap.at(name)->index);
+  }
+
+  return (
+    readBuffers(reader, meshes.dynamicMeshes, meshIndices) &&
+    readBuffers(reader, meshes.wires, meshIndices) &&
+    readBuffers(reader, meshes.proceduralMeshes, meshIndices)
+  );
+}
+
+/**
+ * ProceduralCache::save
+ * ---------------------
+ *
+ * Writes generated meshes to a cache file, along with the
+ * hash of the inputs they were generated from. Source object
+ * associations are not cached, so cached meshes should only
+ * be loaded when the level won't be edited.
+ */
+bool ProceduralCache::save(GmContext* context, const std::string& path, u64 inputHash, const GeneratedMeshes& meshes) {
+  std::map<u16, u16> nameIndices;
+  std::vector<u16> meshIndices;
+
+  for (auto* buffers : { &meshes.dynamicMeshes, &meshes.wires, &meshes.proceduralMeshes }) {
+    for (auto& buffer : *buffers) {
+      for (auto& staged : buffer.objects) {
+        u16 meshIndex = staged.object._record.meshIndex;
+
+        if (nameIndices.find(meshIndex) == nameIndices.end()) {
+          nameIndices[meshIndex] = (u16)meshIndices.size();
+
+          meshIndices.push_back(meshIndex);
+        }
+      }
+    }
+  }
+
+  FileWriter writer(path);
+  u32 magic = CACHE_MAGIC;
+  u32 version = CACHE_VERSION;
+  u32 totalMeshNames = (u32)meshIndices.size();
+
+  writer.write(&magic, sizeof(u32));
+  writer.write(&version, sizeof(u32));
+  writer.write(&inputHash, sizeof(u64));
+  writer.write(&totalMeshNames, sizeof(u32));
+
+  for (auto meshIndex : meshIndices) {
+    auto& name = context->scene.meshes[meshIndex]->name;
+    u32 length = (u32)name.size();
+
+    writer.write(&length, sizeof(u32));
+    writer.write(name);
+  }
+
+  writeBuffers(writer, meshes.dynamicMeshes, nameIndices);
+  writeBuffers(writer, meshes.wires, nameIndices);
+  writeBuffers(writer, meshes.proceduralMeshes, nameIndices);
+
+  return writer.close();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Gamma.h"
+
+#include "object_staging.h"
+
+/**
+ * GeneratedMeshes
+ * ---------------
+ *
+ * The staged output of the dynamic mesh, wire and procedural
+ * mesh builders for a level, in the order it is committed.
+ */
+struct GeneratedMeshes {
+  std::vector<StagingBuffer> dynamicMeshes;
+  std::vector<StagingBuffer> wires;
+  std::vector<StagingBuffer> proceduralMeshes;
+};
+
+namespace ProceduralCache {
+  u64 getInputHash(std::string_view data);
+  bool load(GmContext* context, const std::string& path, u64 inputHash, GeneratedMeshes& meshes);
+  bool save(GmContext* context, const std::string& path, u64 inputHash, const GeneratedMeshes& meshes);
+}
@@ -3,9 +3,13 @@
 #include "Gamma.h"
 
 #include "game.h"
+#include "object_staging.h"
 
 namespace ProceduralMeshes {
-  void buildWireFromStartToEnd(GmContext* context, const Gamma::Vec3f& start, const Gamma::Vec3f& end, const float scale, const Gamma::Vec3f& color);
-  void rebuildProceduralMeshes(GmContext* context);
+  std::vector<StagingBuffer> buildProceduralMeshes(GmContext* context);
+  void buildWireFromStartToEnd(GmContext* context, StagingBuffer& staging, const Gamma::Object& source, const Gamma::Object& otherSource, const Gamma::Vec3f& start, const Gamma::Vec3f& end, const float scale, const Gamma::Vec3f& color);
+  void commitProceduralMeshes(GmContext* context, std::vector<StagingBuffer>& buffers);
+  void rebuildProceduralMeshesForObject(GmContext* context, const Gamma::Object& object);
+  void resetProceduralMeshes(GmContext* context);
   void handleProceduralMeshes(GmContext* context, GameState& state, float dt);
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+
+#include "spatial_hash.h"
+#include "macros.h"
+
+using namespace Gamma;
+
+internal s32 getGridCoordinate(const SpatialGrid& grid, float value) {
+  return s32(std::floorf(value / grid.cellSize));
+}
+
+internal u64 getGridCellKey(s32 x, s32 y, s32 z) {
+  return (
+    (u64(u32(x) & 0x1fffff) << 42) |
+    (u64(u32(y) & 0x1fffff) << 21) |
+    u64(u32(z) & 0x1fffff)
+  );
+}
+
+SpatialGrid SpatialHash::createGrid(const ObjectPool& objects, float cellSize) {
+  SpatialGrid grid;
+  u32 index = 0;
+
+  grid.cellSize = cellSize;
+
+  for (auto& object : objects) {
+    auto& position = object.position;
+
+    grid.cells[getGridCellKey(
+      getGridCoordinate(grid, position.x),
+      getGridCoordinate(grid, position.y),
+      getGridCoordinate(grid, position.z)
+    )].push_back(index++);
+  }
+
+  return grid;
+}
+
+/**
+ * SpatialHash::queryGrid
+ * ----------------------
+ *
+ * Collects the indices of objects in the cells overlapping a
+ * radius around a point. Results are candidates only, and must
+ * be distance-tested by the caller. Indices are sorted, so
+ * candidates are visited in the same order as a linear scan
+ * over the pool.
+ */
+void SpatialHash::queryGrid(const SpatialGrid& grid, const Vec3f& point, float radius, std::vector<u32>& indices) {
+  s32 minX = getGridCoordinate(grid, point.x - radius);
+  s32 maxX = getGridCoordinate(grid, point.x + radius);
+  s32 minY = getGridCoordinate(grid, point.y - radius);
+  s32 maxY = getGridCoordinate(grid, point.y + radius);
+  s32 minZ = getGridCoordinate(grid, point.z - radius);
+  s32 maxZ = getGridCoordinate(grid, point.z + radius);
+
+  indices.clear();
+
+  for (s32 x = minX; x <= maxX; x++) {
+    for (s32 y = minY; y <= maxY; y++) {
+      for (s32 z = minZ; z <= maxZ; z++) {
+        auto cell = grid.cells.find(getGridCellKey(x, y, z));
+
+        if (cell != grid.cells.end()) {
+          indices.insert(indices.end(), cell->second.begin(), cell->second.end());
+        }
+      }
+    }
+  }
+
+  std::sort(indices.begin(), indices.end());
+}
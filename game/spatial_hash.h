@@ -0,0 +1,25 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Gamma.h"
+
+/**
+ * SpatialGrid
+ * -----------
+ *
+ * A spatial hash of object positions, allowing objects near
+ * a point to be found without scanning every object. Objects
+ * are referred to by their index in the pool the grid was
+ * created from.
+ */
+struct SpatialGrid {
+  float cellSize = 1.f;
+  std::unordered_map<u64, std::vector<u32>> cells;
+};
+
+namespace SpatialHash {
+  SpatialGrid createGrid(const Gamma::ObjectPool& objects, float cellSize);
+  void queryGrid(const SpatialGrid& grid, const Gamma::Vec3f& point, float radius, std::vector<u32>& indices);
+}
@@ -154,7 +154,7 @@ internal void handleDialogue(GmContext* context, GameState& state) {
           dialogue.lastCharacterTime = get_scene_time();
         }
 
-        render_text(dialogueFont, runningText, pane.x + 20, pane.y + 20);
+        render_text(dialogueFont, runningText.c_str(), pane.x + 20, pane.y + 20);
       }
     }
   }
@@ -1,4 +1,7 @@
+#include <algorithm>
+
 #include "vehicle_system.h"
+#include "spatial_hash.h"
 #include "macros.h"
 
 using namespace Gamma;
@@ -23,9 +26,87 @@ static std::vector<VehicleConfig> vehicleConfigs = {
   }
 };
 
+constexpr static float TRACK_PROBE_RADIUS = 500.f;
+constexpr static u32 TRACK_SAMPLES_PER_SEGMENT = 8;
+
+/**
+ * Returns the index of the first track object within the
+ * probe radius of a point, or -1 if none are in range.
+ * Candidates are visited in index order, so results match
+ * a linear scan over the track objects.
+ */
+internal s32 findTrackObjectNearPoint(GmContext* context, const SpatialGrid& grid, const Vec3f& point) {
+  auto& tracks = objects("vehicle-track");
+  std::vector<u32> candidates;
+
+  SpatialHash::queryGrid(grid, point, TRACK_PROBE_RADIUS, candidates);
+
+  for (auto index : candidates) {
+    if ((tracks[index].position - point).magnitude() < TRACK_PROBE_RADIUS) {
+      return s32(index);
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * Samples a spline through the track points, storing the
+ * cumulative distance and heading at each sample so vehicles
+ * can be advanced by distance along the curve.
+ */
+internal void buildTrackSamples(VehicleTrack& track) {
+  auto& points = track.points;
+  auto& samples = track.samples;
+  s32 lastIndex = s32(points.size()) - 1;
+
+  samples.clear();
+
+  #define point_at(i) points[std::max(0, std::min(s32(i), lastIndex))]
+
+  for (s32 i = 0; i < lastIndex; i++) {
+    for (u32 j = 0; j < TRACK_SAMPLES_PER_SEGMENT; j++) {
+      float alpha = float(j) / float(TRACK_SAMPLES_PER_SEGMENT);
+      TrackSample sample;
+
+      sample.position = Vec3f::cubicSpline(point_at(i - 1), point_at(i), point_at(i + 1), point_at(i + 2), alpha);
+
+      samples.push_back(sample);
+    }
+  }
+
+  #undef point_at
+
+  if (points.size() > 0) {
+    TrackSample end;
+
+    end.position = points.back();
+
+    samples.push_back(end);
+  }
+
+  // Compute arc lengths and headings
+  for (u32 i = 1; i < samples.size(); i++) {
+    auto& previous = samples[i - 1];
+    auto& sample = samples[i];
+    Vec3f delta = sample.position - previous.position;
+
+    sample.distance = previous.distance + delta.magnitude();
+    previous.angle = atan2f(delta.x, delta.z);
+  }
+
+  if (samples.size() > 1) {
+    samples.back().angle = samples[samples.size() - 2].angle;
+  }
+
+  track.length = samples.size() > 0 ? samples.back().distance : 0.f;
+}
+
 // @todo @cleanup the code here is a first-pass and a little messy
 void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
   auto start = Gm_GetMicroseconds();
+  auto grid = SpatialHash::createGrid(objects("vehicle-track"), TRACK_PROBE_RADIUS);
+  auto& trackObjects = objects("vehicle-track");
 
   state.vehicleTracks.clear();
 
@@ -37,7 +118,6 @@ void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
         if ((object.position - spawn.position).magnitude() < 2000.f) {
           Vehicle vehicle = {
             .object = object._record,
-            .trackPointTarget = 0,
             .speed = config.speed
           };
 
@@ -56,7 +136,7 @@ void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
     Vec3f next = start;
     float closest = Gm_FLOAT_MAX;
 
-    for (auto& t : objects("vehicle-track")) {
+    for (auto& t : trackObjects) {
       float distance = (t.position - start).magnitude();
 
       if (distance < closest) {
@@ -67,9 +147,10 @@ void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
 
     track.points.push_back(next);
 
-    bool ended = false;
+    // Guard against tracks which loop back onto themselves
+    u32 maxPoints = trackObjects.totalActive() + 2;
 
-    while (true) {
+    while (track.points.size() < maxPoints) {
       Vec3f direction = (track.points.back() - track.points[track.points.size() - 2]).unit();
       Vec3f checkStart = track.points.back() + (direction * 600.f);
 
@@ -77,18 +158,13 @@ void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
 
       for (u8 i = 0; i < 50; i++) {
         Vec3f check = checkStart + direction * 200.f * float(i);
+        s32 index = findTrackObjectNearPoint(context, grid, check);
 
-        for (auto& t : objects("vehicle-track")) {
-          if ((t.position - check).magnitude() < 500.f) {
-            track.points.push_back(t.position);
-
-            found = true;
+        if (index != -1) {
+          track.points.push_back(trackObjects[index].position);
 
-            break;
-          }
-        }
+          found = true;
 
-        if (found) {
           break;
         }
       }
@@ -98,14 +174,7 @@ void VehicleSystem::rebuildVehicleTracks(GmContext* context, GameState& state) {
       }
     }
 
-    for (auto& vehicle : track.vehicles) {
-      if (track.points.size() > 1) {
-        auto firstTrackSectionDirection = (track.points[1] - track.points[0]).unit();
-        auto initialAngle = atan2f(firstTrackSectionDirection.x, firstTrackSectionDirection.z);
-
-        vehicle.trackSectionStartAngle = initialAngle;
-      }
-    }
+    buildTrackSamples(track);
 
     state.vehicleTracks.push_back(track);
   }
@@ -119,54 +188,41 @@ void VehicleSystem::handleVehicles(GmContext* context, GameState& state, float d
   START_TIMING("handleVehicles");
 
   for (auto& track : state.vehicleTracks) {
+    if (track.length == 0.f) {
+      continue;
+    }
+
+    auto& samples = track.samples;
+
     for (auto& vehicle : track.vehicles) {
       auto object = get_object_by_record(vehicle.object);
 
       if (object != nullptr) {
-        auto target = track.points[vehicle.trackPointTarget];
-        auto objectToTarget = target - object->position;
-        auto targetDistance = objectToTarget.magnitude();
-        auto objectDirection = object->rotation.getDirection();
-        float currentAngle = atan2f(objectDirection.x, objectDirection.z);
-
-        if (targetDistance < 20.f) {
-          vehicle.trackPointTarget++;
-          vehicle.trackSectionStartAngle = currentAngle;
-        }
+        vehicle.distance += vehicle.speed * dt;
 
-        if (vehicle.trackPointTarget > track.points.size() - 1) {
+        if (vehicle.distance >= track.length) {
           // Reset vehicle to start
-          auto direction = (track.points[1] - track.points[0]).unit();
-          auto initialAngle = atan2f(direction.x, direction.z);
-
-          vehicle.trackPointTarget = 0;
-          vehicle.trackSectionStartAngle = initialAngle;
-
-          object->position = track.points[0];
-          object->rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), initialAngle);
-        } else {
-          auto previousTarget = vehicle.trackPointTarget > 0
-            ? track.points[vehicle.trackPointTarget - 1]
-            : track.points[0];
-
-          auto nextTarget = track.points[vehicle.trackPointTarget];
-          auto previousToNextTarget = nextTarget - previousTarget;
-          auto objectToNextTarget = nextTarget - object->position;
-          auto objectToPreviousTarget = previousTarget - object->position;
-          auto objectDirection = object->rotation.getDirection();
-          float targetAngle = atan2f(objectToNextTarget.x, objectToNextTarget.z);
-          float turnProgress = 1.f - objectToNextTarget.magnitude() / previousToNextTarget.magnitude();
-          float angle = Gm_LerpCircularf(vehicle.trackSectionStartAngle, targetAngle, turnProgress, Gm_PI);
-
-          // @todo use proper curved interpolation between points (cubic spline will probably work)
-          object->position += objectToNextTarget.unit() * vehicle.speed * dt;
-          object->rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), angle);
+          vehicle.distance = 0.f;
+          vehicle.sampleIndex = 0;
         }
 
+        while (samples[vehicle.sampleIndex + 1].distance < vehicle.distance) {
+          vehicle.sampleIndex++;
+        }
+
+        auto& from = samples[vehicle.sampleIndex];
+        auto& to = samples[vehicle.sampleIndex + 1];
+        float sectionLength = to.distance - from.distance;
+        float alpha = sectionLength > 0.f ? (vehicle.distance - from.distance) / sectionLength : 0.f;
+        float angle = Gm_LerpCircularf(from.angle, to.angle, alpha, Gm_PI);
+
+        object->position = Vec3f::lerp(from.position, to.position, alpha);
+        object->rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), angle);
+
         commit(*object);
       }
     }
   }
 
   LOG_TIME();
-}
\ No newline at end of file
+}
@@ -1,11 +1,16 @@
+#include <map>
+
 #include "world.h"
 #include "game_meshes.h"
 #include "collisions.h"
 #include "game_constants.h"
+#include "procedural_cache.h"
 #include "procedural_meshes.h"
+#include "spatial_hash.h"
 #include "vehicle_system.h"
 #include "editor.h"
 #include "macros.h"
+#include "system/assert.h"
 
 using namespace Gamma;
 
@@ -17,25 +22,36 @@ struct Platform {
   Vec3f color;
 };
 
+internal void mapLevelFile(const std::string& levelName, const char* fileName, FileBuffer& file) {
+  std::string path = "./game/levels/" + levelName + "/" + fileName;
+
+  Gamma::assert(Gm_MapFile(path, file), "Failed to load level data file: " + path);
+}
+
 internal void loadStaticCollisionPlanes(GmContext* context, GameState& state, const std::string& levelName) {
   u64 start = Gm_GetMicroseconds();
+  FileBuffer file;
 
   // @todo eventually store as binary data
-  auto worldData = Gm_LoadFileContents("./game/levels/" + levelName + "/data_collision_planes.txt");
-  auto lines = Gm_SplitString(worldData, "\n");
+  mapLevelFile(levelName, "data_collision_planes.txt", file);
+
+  std::string_view remaining = file.view();
+  std::string_view line;
+  std::string_view parts[13];
 
   objects("platform").reset();
 
-  for (auto& line : lines) {
+  while (Gm_NextLine(remaining, line)) {
     if (line.size() == 0) {
       continue;
     }
 
-    auto parts = Gm_SplitString(line, ",");
+    Gm_SplitFields(line, ',', parts, 13);
+
     auto& platform = create_object_from("platform");
 
-    #define df(n) stof(parts[n])
-    #define di(n) stoi(parts[n])
+    #define df(n) Gm_ParseFloat(parts[n])
+    #define di(n) Gm_ParseInt(parts[n])
 
     platform.position = Vec3f(df(0), df(1), df(2));
     platform.scale = Vec3f(df(3), df(4), df(5));
@@ -47,21 +63,28 @@ internal void loadStaticCollisionPlanes(GmContext* context, GameState& state, co
     Collisions::addObjectCollisionPlanes(platform, state.collisionPlanes);
   }
 
+  Gm_UnmapFile(file);
+
   Console::log("Loaded collision planes in", Gm_GetMicroseconds() - start, "us");
 }
 
-internal void loadWorldObjects(GmContext* context, GameState& state, const std::string& levelName) {
+/**
+ * Loads the level's world objects, returning a hash of
+ * their data for validating the level's procedural cache.
+ */
+internal u64 loadWorldObjects(GmContext* context, GameState& state, const std::string& levelName) {
   u64 start = Gm_GetMicroseconds();
+  FileBuffer file;
 
   // @todo eventually store as binary data
-  auto worldData = Gm_LoadFileContents("./game/levels/" + levelName + "/data_world_objects.txt");
-  auto lines = Gm_SplitString(worldData, "\n");
+  mapLevelFile(levelName, "data_world_objects.txt", file);
 
+  std::string_view remaining = file.view();
+  std::string_view line;
+  std::string_view parts[13];
   std::string meshName;
 
-  for (u32 i = 0; i < lines.size(); i++) {
-    auto& line = lines[i];
-
+  while (Gm_NextLine(remaining, line)) {
     if (line.size() == 0) {
       continue;
     }
@@ -69,11 +92,12 @@ internal void loadWorldObjects(GmContext* context, GameState& state, const std::
     if (line[0] == '@') {
       meshName = line.substr(1);
     } else {
-      auto parts = Gm_SplitString(line, ",");
+      Gm_SplitFields(line, ',', parts, 13);
+
       auto& object = create_object_from(meshName);
 
-      #define df(n) stof(parts[n])
-      #define di(n) stoi(parts[n])
+      #define df(n) Gm_ParseFloat(parts[n])
+      #define di(n) Gm_ParseInt(parts[n])
 
       object.position = Vec3f(df(0), df(1), df(2));
       object.scale = Vec3f(df(3), df(4), df(5));
@@ -84,26 +108,36 @@ internal void loadWorldObjects(GmContext* context, GameState& state, const std::
     }
   }
 
+  u64 hash = ProceduralCache::getInputHash(file.view());
+
+  Gm_UnmapFile(file);
+
   Console::log("Loaded world objects in", Gm_GetMicroseconds() - start, "us");
+
+  return hash;
 }
 
 internal void loadLights(GmContext* context, const std::string& levelName) {
   u64 start = Gm_GetMicroseconds();
+  FileBuffer file;
 
   // @todo eventually store as binary data
-  auto worldData = Gm_LoadFileContents("./game/levels/" + levelName + "/data_lights.txt");
-  auto lines = Gm_SplitString(worldData, "\n");
+  mapLevelFile(levelName, "data_lights.txt", file);
 
-  for (auto& line : lines) {
+  std::string_view remaining = file.view();
+  std::string_view line;
+  std::string_view parts[14];
+
+  while (Gm_NextLine(remaining, line)) {
     if (line.size() == 0) {
       continue;
     }
 
-    auto parts = Gm_SplitString(line, ",");
-    auto& light = create_light((LightType)stoi(parts[0]));
+    u32 totalParts = Gm_SplitFields(line, ',', parts, 14);
+    auto& light = create_light((LightType)Gm_ParseInt(parts[0]));
 
-    #define rf(n) stof(parts[n])
-    #define ri(n) stoi(parts[n])
+    #define rf(n) Gm_ParseFloat(parts[n])
+    #define ri(n) Gm_ParseInt(parts[n])
 
     light.position = Vec3f(rf(1), rf(2), rf(3));
     light.radius = rf(4);
@@ -112,7 +146,7 @@ internal void loadLights(GmContext* context, const std::string& levelName) {
     light.direction = Vec3f(rf(9), rf(10), rf(11));
     light.fov = rf(12);
 
-    if (parts.size() == 14) {
+    if (totalParts == 14) {
       light.isStatic = ri(13) == 1;
     }
 
@@ -120,6 +154,8 @@ internal void loadLights(GmContext* context, const std::string& levelName) {
     light.basePower = light.power;
   }
 
+  Gm_UnmapFile(file);
+
   Console::log("Loaded lights in", Gm_GetMicroseconds() - start, "us");
 }
 
@@ -138,34 +174,48 @@ internal void loadNpcData(GmContext* context, GameState& state, const std::strin
 
 
   // @todo eventually store as binary data
-  auto npcDataContents = Gm_LoadFileContents("./game/levels/" + levelName + "/data_npcs.txt");
-  auto lines = Gm_SplitString(npcDataContents, "\n");
+  FileBuffer file;
+
+  mapLevelFile(levelName, "data_npcs.txt", file);
+
+  std::string_view remaining = file.view();
+  std::string_view nextLine;
+  std::vector<std::string_view> lines;
+
+  while (Gm_NextLine(remaining, nextLine)) {
+    lines.push_back(nextLine);
+  }
+
+  auto startsWith = [&](u32 i, char c) {
+    return lines[i].size() > 0 && lines[i][0] == c;
+  };
 
   // @temporary
   u32 i = 0;
 
   // @temporary
   while (i < lines.size()) {
-    if (lines[i][0] == '@') {
+    if (startsWith(i, '@')) {
       NonPlayerCharacter npc;
 
       // @todo parse NPC @type
 
       i++;
 
-      npc.position = Gm_ParseVec3f(lines[i]);
+      if (i < lines.size()) {
+        npc.position = Gm_ParseVec3f(lines[i]);
+      }
 
       i++;
   
       std::string dialogueLine;
 
-      while (i < lines.size() && lines[i][0] != '@') {
-        auto line = lines[i++];
-
-        if (line[0] == '-') {
+      while (i < lines.size() && !startsWith(i, '@')) {
+        if (startsWith(i, '-')) {
           npc.dialogue.push_back(dialogueLine);
 
           dialogueLine = "";
+          i++;
 
           continue;
         }
@@ -174,7 +224,7 @@ internal void loadNpcData(GmContext* context, GameState& state, const std::strin
           dialogueLine += '\n';
         }
 
-        dialogueLine += line;
+        dialogueLine += lines[i++];
       }
 
       state.npcs.push_back(npc);
@@ -182,6 +232,8 @@ internal void loadNpcData(GmContext* context, GameState& state, const std::strin
       i++;
     }
   }
+
+  Gm_UnmapFile(file);
 }
 
 internal void unloadCurrentLevel(GmContext* context, GameState& state) {
@@ -211,17 +263,9 @@ internal void unloadCurrentLevel(GmContext* context, GameState& state) {
     auto* light = scene.lights[lightIndex];
 
     if (light->serializable) {
-      if (
-        light->type == LightType::DIRECTIONAL_SHADOWCASTER ||
-        light->type == LightType::POINT_SHADOWCASTER ||
-        light->type == LightType::SPOT_SHADOWCASTER
-      ) {
-        context->renderer->destroyShadowMap(light);
-      }
-
-      Gm_VectorRemove(scene.lights, light);
-
-      delete light;
+      // Removal swaps the last light into this index,
+      // so don't advance until a light is kept
+      remove_light(light);
     } else {
       lightIndex++;
     }
@@ -261,14 +305,61 @@ internal void copyMeshAttributes(Mesh& mesh, const MeshAttributes& attributes) {
   mesh.useCloseTranslucency = attributes.useCloseTranslucency;
   mesh.useXzPlaneTexturing = attributes.useXzPlaneTexturing;
   mesh.useYPlaneTexturing = attributes.useYPlaneTexturing;
+  mesh.instanceFormat = attributes.instanceFormat;
+}
+
+/**
+ * Creates the Meshes for every mesh asset in parallel, since
+ * .obj parsing and normal/tangent computation are independent
+ * for each asset. Meshes are then added to the scene in their
+ * original order on the main thread, which creates their GPU
+ * buffers and preserves mesh indexes.
+ */
+internal std::vector<Mesh*> createGameMeshes(const std::vector<const MeshAsset*>& assets) {
+  u64 start = Gm_GetMicroseconds();
+  std::vector<Mesh*> meshes(assets.size());
+
+  Gm_ParallelFor((u32)assets.size(), [&](u32 i) {
+    meshes[i] = assets[i]->create();
+  }, [](u32 completed, u32 total) {
+    #if GAMMA_DEVELOPER_MODE
+      Console::log("Created", completed, "/", total, "meshes");
+    #endif
+  });
+
+  Console::log("Created game meshes in", Gm_GetMicroseconds() - start, "us");
+
+  return meshes;
 }
 
 // @todo create a loadGameMeshFromAsset() function to simplify this
 internal void loadGameMeshes(GmContext* context, GameState& state) {
   GameMeshes::loadAllMeshAssets();
 
+  // Collect assets in the order their meshes are added
+  std::vector<const MeshAsset*> assets;
+
   for (auto& asset : GameMeshes::meshAssets) {
-    add_mesh(asset.name, asset.maxInstances, asset.create());
+    assets.push_back(&asset);
+
+    for (auto& piece : asset.pieces) {
+      assets.push_back(&piece);
+    }
+  }
+
+  for (auto& asset : GameMeshes::proceduralMeshParts) {
+    assets.push_back(&asset);
+  }
+
+  for (auto& asset : GameMeshes::dynamicMeshPieces) {
+    assets.push_back(&asset);
+  }
+
+  auto createdMeshes = createGameMeshes(assets);
+  u32 meshIndex = 0;
+
+  for (auto& asset : GameMeshes::meshAssets) {
+    add_mesh(asset.name, asset.maxInstances, createdMeshes[meshIndex++]);
 
     auto& mesh = *mesh(asset.name);
     auto& attributes = asset.attributes;
@@ -276,7 +367,7 @@ internal void loadGameMeshes(GmContext* context, GameState& state) {
     copyMeshAttributes(mesh, attributes);
 
     for (auto& piece : asset.pieces) {
-      add_mesh(piece.name, piece.maxInstances, piece.create());
+      add_mesh(piece.name, piece.maxInstances, createdMeshes[meshIndex++]);
 
       auto& pieceMesh = *mesh(piece.name);
       auto& attributes = piece.attributes;
@@ -290,7 +381,7 @@ internal void loadGameMeshes(GmContext* context, GameState& state) {
   }
 
   for (auto& asset : GameMeshes::proceduralMeshParts) {
-    add_mesh(asset.name, asset.maxInstances, asset.create());
+    add_mesh(asset.name, asset.maxInstances, createdMeshes[meshIndex++]);
 
     auto& mesh = *mesh(asset.name);
     auto& attributes = asset.attributes;
@@ -300,7 +391,7 @@ internal void loadGameMeshes(GmContext* context, GameState& state) {
 
   // @todo remove
   for (auto& asset : GameMeshes::dynamicMeshPieces) {
-    add_mesh(asset.name, asset.maxInstances, asset.create());
+    add_mesh(asset.name, asset.maxInstances, createdMeshes[meshIndex++]);
 
     auto& mesh = *mesh(asset.name);
     auto& attributes = asset.attributes;
@@ -309,7 +400,28 @@ internal void loadGameMeshes(GmContext* context, GameState& state) {
   }
 }
 
-internal void rebuildDynamicStaircase(GmContext* context, const Object& staircase, const std::string& type) {
+/**
+ * The objects generated from each source object, so the
+ * editor can regenerate the pieces of a single edited object
+ * instead of rebuilding every dynamic mesh in the level.
+ */
+static GeneratedObjects generatedObjects;
+
+internal void rebuildMeshPieces(GmContext* context, StagingBuffer& staging, const MeshAsset& asset, Object& source) {
+  for (auto& piece : asset.pieces) {
+    auto& pieceObject = stage_generated_object(piece.name, source);
+
+    pieceObject.position = source.position;
+    pieceObject.scale = source.scale;
+    pieceObject.rotation = source.rotation;
+
+    if (piece.rebuild != nullptr) {
+      piece.rebuild(source, pieceObject);
+    }
+  }
+}
+
+internal void rebuildDynamicStaircase(GmContext* context, StagingBuffer& staging, const Object& staircase, const std::string& type) {
   const static auto sidePoints = {
     Vec3f(1.f, 0, 0),
     Vec3f(-1.f, 0, 0),
@@ -361,7 +473,7 @@ internal void rebuildDynamicStaircase(GmContext* context, const Object& staircas
     u32 totalSteps = u32((start - end).magnitude() / 30.f);
 
     for (u32 i = 0; i < totalSteps; i++) {
-      auto& step = create_object_from(type + "-stair-step");
+      auto& step = stage_generated_object(type + "-stair-step", staircase);
 
       step.position = Vec3f::lerp(start, end, i / float(totalSteps));
 
@@ -381,167 +493,250 @@ internal void rebuildDynamicStaircase(GmContext* context, const Object& staircas
       } else {
         step.scale = Vec3f(staircase.scale.x, 70.f, 70.f);
       }
-
-      commit(step);
     }
   }
 }
 
-internal void rebuildDynamicStaircases(GmContext* context) {
-  objects("metal-stair-step").reset();
-  objects("wood-stair-step").reset();
-
+internal void rebuildDynamicStaircases(GmContext* context, StagingBuffer& staging) {
   for (auto& staircase : objects("metal-staircase")) {
-    rebuildDynamicStaircase(context, staircase, "metal");
+    rebuildDynamicStaircase(context, staging, staircase, "metal");
   }
 
   for (auto& staircase : objects("wood-staircase")) {
-    rebuildDynamicStaircase(context, staircase, "wood");
+    rebuildDynamicStaircase(context, staging, staircase, "wood");
   }
-
-  #if GAMMA_DEVELOPER_MODE
-    u16 totalMetalStairSteps = objects("metal-stair-step").totalActive();
-    u16 totalWoodStairSteps = objects("wood-stair-step").totalActive();
-
-    Console::log("Generated", std::to_string(totalMetalStairSteps), "metal stair steps");
-    Console::log("Generated", std::to_string(totalWoodStairSteps), "wood stair steps");
-  #endif
 }
 
 // @todo define as pieces
-internal void rebuildStreetlampLights(GmContext* context) {
-  objects("streetlamp-light").reset();
-  objects("streetlamp-frame").reset();
+internal void rebuildStreetlampLight(GmContext* context, StagingBuffer& staging, const Object& lamp) {
+  auto& lampLight = stage_generated_object("streetlamp-light", lamp);
+  auto& frame = stage_generated_object("streetlamp-frame", lamp);
+
+  Vec3f offset = Vec3f(lamp.scale.x * 0.17f, lamp.scale.y * 0.74f, 0);
+  Vec3f r_offset = lamp.rotation.toMatrix4f().transformVec3f(offset);
+
+  lampLight.position = lamp.position + r_offset;
+  lampLight.scale = Vec3f(lamp.scale.x, lamp.scale.y * 1.2f, lamp.scale.z) * 0.12f;
+  lampLight.rotation = lamp.rotation;
+  lampLight.color = Vec3f(1.f, 0.8f, 0.6f);
+
+  frame.position = lamp.position;
+  frame.scale = lamp.scale;
+  frame.rotation = lamp.rotation;
+  frame.color = Vec3f(0.7f);
+}
 
+internal void rebuildStreetlampLights(GmContext* context, StagingBuffer& staging) {
   for (auto& lamp : objects("streetlamp")) {
-    auto& lampLight = create_object_from("streetlamp-light");
-    auto& frame = create_object_from("streetlamp-frame");
-
-    Vec3f offset = Vec3f(lamp.scale.x * 0.17f, lamp.scale.y * 0.74f, 0);
-    Vec3f r_offset = lamp.rotation.toMatrix4f().transformVec3f(offset);
+    rebuildStreetlampLight(context, staging, lamp);
+  }
+}
 
-    lampLight.position = lamp.position + r_offset;
-    lampLight.scale = Vec3f(lamp.scale.x, lamp.scale.y * 1.2f, lamp.scale.z) * 0.12f;
-    lampLight.rotation = lamp.rotation;
-    lampLight.color = Vec3f(1.f, 0.8f, 0.6f);
+internal void rebuildElectricalPoleWire(GmContext* context, StagingBuffer& staging, const Object& p1, const Object& p2) {
+  float distance = (p1.position - p2.position).magnitude();
+  float yDistance = p1.position.y - p2.position.y;
 
-    frame.position = lamp.position;
-    frame.scale = lamp.scale;
-    frame.rotation = lamp.rotation;
-    frame.color = Vec3f(0.7f);
+  // Only generate wires for poles close enough to one another,
+  // and within a certain y distance threshold
+  if (distance < 2000.f && yDistance > 0.f && yDistance < 500.f) {
+    Vec3f start = p1.position + Vec3f(0, p1.scale.y, 0);
+    Vec3f end = p2.position + Vec3f(0, p2.scale.y, 0);
 
-    commit(lampLight);
-    commit(frame);
+    ProceduralMeshes::buildWireFromStartToEnd(context, staging, p1, p2, start, end, 2.f, Vec3f(0.1f));
   }
 }
 
-// @todo move to a common file
-#define is_same_object(a, b) a._record.id == b._record.id && a._record.generation == b._record.generation
+internal void rebuildWoodElectricalPoleWires(GmContext* context, StagingBuffer& staging, const Object& p1, const Object& p2) {
+  float distance = (p1.position - p2.position).magnitude();
+  float yDistance = p1.position.y - p2.position.y;
 
-internal void rebuildElectricalWires(GmContext* context) {
-  // Electrical pole wires
-  for (auto& p1 : objects("electrical-pole")) {
-    for (auto& p2 : objects("electrical-pole")) {
-      if (is_same_object(p1, p2)) continue;
+  // Only generate wires for poles close enough to one another,
+  // and within a certain y distance threshold
+  if (distance < 20000.f && yDistance > 0.f && yDistance < 4000.f) {
+    // Wire 1
+    {
+      Vec3f start = p1.position + Vec3f(0, p1.scale.y * 1.2f, 0) + (p1.rotation.toMatrix4f() * Vec3f(0, 0, p1.scale.z * 0.8f)).toVec3f();
+      Vec3f end = p2.position + Vec3f(0, p2.scale.y * 1.2f, 0) + (p2.rotation.toMatrix4f() * Vec3f(0, 0, p2.scale.z * 0.8f)).toVec3f();
 
-      float distance = (p1.position - p2.position).magnitude();
-      float yDistance = p1.position.y - p2.position.y;
+      ProceduralMeshes::buildWireFromStartToEnd(context, staging, p1, p2, start, end, 10.f, Vec3f(0.7f));
+    }
 
-      // Only generate wires for poles close enough to one another,
-      // and within a certain y distance threshold
-      if (distance < 2000.f && yDistance > 0.f && yDistance < 500.f) {
-        Vec3f start = p1.position + Vec3f(0, p1.scale.y, 0);
-        Vec3f end = p2.position + Vec3f(0, p2.scale.y, 0);
+    // Wire 2
+    {
+      Vec3f start = p1.position + Vec3f(0, p1.scale.y * 1.63f, 0) + (p1.rotation.toMatrix4f() * Vec3f(0, 0, p1.scale.z * 0.8f)).toVec3f();
+      Vec3f end = p2.position + Vec3f(0, p2.scale.y * 1.63f, 0) + (p2.rotation.toMatrix4f() * Vec3f(0, 0, p2.scale.z * 0.8f)).toVec3f();
 
-        ProceduralMeshes::buildWireFromStartToEnd(context, start, end, 2.f, Vec3f(0.1f));
-      }
+      ProceduralMeshes::buildWireFromStartToEnd(context, staging, p1, p2, start, end, 10.f, Vec3f(0.7f));
     }
   }
+}
 
-  // Wood electrical pole wires
-  for (auto& p1 : objects("wood-electrical-pole")) {
-    for (auto& p2 : objects("wood-electrical-pole")) {
-      if (is_same_object(p1, p2)) {
-        continue;
-      }
+internal void rebuildMiniFlagWire(GmContext* context, StagingBuffer& staging, const Object& s1, const Object& s2) {
+  const static auto FLAG_COLORS = {
+    Vec3f(1.f, 0.5f, 0.2f),
+    Vec3f(1.f, 0.2f, 0.1f),
+    Vec3f(0.2f, 0.5f, 1.f),
+    Vec3f(0.2f, 1.f, 0.5f)
+  };
 
-      float distance = (p1.position - p2.position).magnitude();
-      float yDistance = p1.position.y - p2.position.y;
+  float distance = (s1.position - s2.position).magnitude();
+  float yDistance = s1.position.y - s2.position.y;
 
-      // Only generate wires for poles close enough to one another,
-      // and within a certain y distance threshold
-      if (distance < 20000.f && yDistance > 0.f && yDistance < 4000.f) {
-        // Wire 1
-        {
-          Vec3f start = p1.position + Vec3f(0, p1.scale.y * 1.2f, 0) + (p1.rotation.toMatrix4f() * Vec3f(0, 0, p1.scale.z * 0.8f)).toVec3f();
-          Vec3f end = p2.position + Vec3f(0, p2.scale.y * 1.2f, 0) + (p2.rotation.toMatrix4f() * Vec3f(0, 0, p2.scale.z * 0.8f)).toVec3f();
+  if (distance < 3000.f && yDistance > 0.f && yDistance < 1000.f) {
+    auto& start = s1.position;
+    auto& end = s2.position;
 
-          ProceduralMeshes::buildWireFromStartToEnd(context, start, end, 10.f, Vec3f(0.7f));
-        }
+    // Construct the wire
+    ProceduralMeshes::buildWireFromStartToEnd(context, staging, s1, s2, start, end, 4.f, Vec3f(0.5f));
 
-        // Wire 2
-        {
-          Vec3f start = p1.position + Vec3f(0, p1.scale.y * 1.63f, 0) + (p1.rotation.toMatrix4f() * Vec3f(0, 0, p1.scale.z * 0.8f)).toVec3f();
-          Vec3f end = p2.position + Vec3f(0, p2.scale.y * 1.63f, 0) + (p2.rotation.toMatrix4f() * Vec3f(0, 0, p2.scale.z * 0.8f)).toVec3f();
+    // Add mini flag decorations
+    u8 totalWirePieces = 10;
+    Vec3f direction = end - start;
+    float sagDistance = direction.magnitude() / 10.f;
+    float angle = atan2f(direction.x, direction.z) + Gm_HALF_PI;
 
-          ProceduralMeshes::buildWireFromStartToEnd(context, start, end, 10.f, Vec3f(0.7f));
-        }
-      }
+    for (u8 i = 1; i < totalWirePieces; i++) {
+      float alpha = float(i) / float(totalWirePieces);
+      float sag = (1.f - powf(alpha * 2.f - 1.f, 2)) * sagDistance;
+      Vec3f position = Vec3f::lerp(start, end, alpha) - Vec3f(0, sag + 10.f, 0);
+      u8 colorIndex = u8(Gm_Modf(position.x + position.z, 4.f));
+
+      auto& flag = stage_span_object("mini-flag", s1, s2);
+      float sizeVariance = Gm_Modf(position.x, 10.f);
+
+      flag.position = position - Vec3f(0, 55.f, 0) - Vec3f(0, sizeVariance, 0);
+      flag.scale = Vec3f(60.f - sizeVariance, 60.f + sizeVariance * 2.f, 60.f);
+      flag.color = *(FLAG_COLORS.begin() + colorIndex);
+      flag.rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), angle);
     }
   }
 }
 
-internal void rebuildMiniFlagWires(GmContext* context) {
+internal void rebuildFlagPivotWire(GmContext* context, StagingBuffer& staging, const Object& p1, const Object& p2) {
   const static auto FLAG_COLORS = {
-    Vec3f(1.f, 0.5f, 0.2f),
-    Vec3f(1.f, 0.2f, 0.1f),
-    Vec3f(0.2f, 0.5f, 1.f),
-    Vec3f(0.2f, 1.f, 0.5f)
+    Vec3f(1.f, 0.8f, 0.2f),
+    Vec3f(1.f, 0.3f, 0.1f)
   };
 
-  objects("mini-flag").reset();
+  auto start = p1.position;
+  auto end = p2.position;
 
-  for (auto& s1 : objects("flag-wire-spawn")) {
-    for (auto& s2 : objects("flag-wire-spawn")) {
-      if (is_same_object(s1, s2)) {
-        continue;
-      }
+  if ((start - end).magnitude() < 750.f && start.y > end.y) {
+    // Build the wire
+    ProceduralMeshes::buildWireFromStartToEnd(context, staging, p1, p2, start, end, 1.f, Vec3f(0.3f));
 
-      float distance = (s1.position - s2.position).magnitude();
-      float yDistance = s1.position.y - s2.position.y;
+    // Add mini flag decorations
+    u8 totalWirePieces = 10;
+    Vec3f direction = end - start;
+    float sagDistance = direction.magnitude() / 10.f;
+    float angle = atan2f(direction.x, direction.z) + Gm_HALF_PI;
 
-      if (distance < 3000.f && yDistance > 0.f && yDistance < 1000.f) {
-        auto& start = s1.position;
-        auto& end = s2.position;
+    for (u8 i = 1; i < totalWirePieces; i++) {
+      float alpha = float(i) / float(totalWirePieces);
+      float sag = (1.f - powf(alpha * 2.f - 1.f, 2)) * sagDistance;
+      Vec3f position = Vec3f::lerp(start, end, alpha) - Vec3f(0, sag + 10.f, 0);
+      u8 colorIndex = u8(Gm_Modf(position.x + position.z, 2.f));
 
-        // Construct the wire
-        ProceduralMeshes::buildWireFromStartToEnd(context, start, end, 4.f, Vec3f(0.5f));
+      auto& flag = stage_span_object("mini-flag", p1, p2);
+      float sizeVariance = Gm_Modf(position.x, 10.f);
 
-        // Add mini flag decorations
-        u8 totalWirePieces = 10;
-        Vec3f direction = end - start;
-        float sagDistance = direction.magnitude() / 10.f;
-        float angle = atan2f(direction.x, direction.z) + Gm_HALF_PI;
+      flag.position = position - Vec3f(0, 15.f, 0) - Vec3f(0, sizeVariance * 0.25f, 0);
+      flag.scale = Vec3f(20.f - sizeVariance, 20.f + sizeVariance, 20.f);
+      flag.color = *(FLAG_COLORS.begin() + colorIndex);
+      flag.rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), angle);
+    }
+  }
+}
 
-        for (u8 i = 1; i < totalWirePieces; i++) {
-          float alpha = float(i) / float(totalWirePieces);
-          float sag = (1.f - powf(alpha * 2.f - 1.f, 2)) * sagDistance;
-          Vec3f position = Vec3f::lerp(start, end, alpha) - Vec3f(0, sag + 10.f, 0);
-          u8 colorIndex = u8(Gm_Modf(position.x + position.z, 4.f));
+/**
+ * WireSpanBuilder
+ * ---------------
+ *
+ * A builder for the wire spans between pairs of objects of
+ * a source mesh, within a given range of one another. Spans
+ * are only built from the higher object of each pair, so each
+ * pair is built once regardless of which object comes first.
+ */
+struct WireSpanBuilder {
+  std::string sourceMeshName;
+  float range = 0.f;
+  void (*build)(GmContext*, StagingBuffer&, const Object&, const Object&) = nullptr;
+};
 
-          auto& flag = create_object_from("mini-flag");
-          float sizeVariance = Gm_Modf(position.x, 10.f);
+static std::vector<WireSpanBuilder> wireSpanBuilders = {
+  {
+    .sourceMeshName = "electrical-pole",
+    .range = 2000.f,
+    .build = rebuildElectricalPoleWire
+  },
+  {
+    .sourceMeshName = "wood-electrical-pole",
+    .range = 20000.f,
+    .build = rebuildWoodElectricalPoleWires
+  },
+  {
+    .sourceMeshName = "flag-wire-spawn",
+    .range = 3000.f,
+    .build = rebuildMiniFlagWire
+  },
+  {
+    .sourceMeshName = "flag-pivot",
+    .range = 750.f,
+    .build = rebuildFlagPivotWire
+  }
+};
 
-          flag.position = position - Vec3f(0, 55.f, 0) - Vec3f(0, sizeVariance, 0);
-          flag.scale = Vec3f(60.f - sizeVariance, 60.f + sizeVariance * 2.f, 60.f);
-          flag.color = *(FLAG_COLORS.begin() + colorIndex);
-          flag.rotation = Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), angle);
+internal void rebuildWireSpans(GmContext* context, StagingBuffer& staging, const WireSpanBuilder& builder) {
+  auto& sources = objects(builder.sourceMeshName);
+  auto grid = SpatialHash::createGrid(sources, builder.range);
+  std::vector<u32> candidates;
 
-          commit(flag);
-        }
+  for (u32 i = 0; i < sources.totalActive(); i++) {
+    SpatialHash::queryGrid(grid, sources[i].position, builder.range, candidates);
+
+    for (auto j : candidates) {
+      if (i != j) {
+        builder.build(context, staging, sources[i], sources[j]);
       }
     }
   }
+}
+
+/**
+ * Rebuilds the wire spans between a single source object and
+ * the other objects of its mesh, e.g. after a pole is moved.
+ */
+internal void rebuildWireSpansForSource(GmContext* context, StagingBuffer& staging, const WireSpanBuilder& builder, const Object& source) {
+  for (auto& other : objects(builder.sourceMeshName)) {
+    if (other._record.id != source._record.id) {
+      builder.build(context, staging, source, other);
+      builder.build(context, staging, other, source);
+    }
+  }
+}
+
+// @todo move these to procedural_meshes.cpp
+internal void resetWires(GmContext* context) {
+  objects("wire").reset();
+  objects("mini-flag").reset();
+}
+
+internal std::vector<StagingBuffer> buildWires(GmContext* context) {
+  std::vector<StagingBuilder> builders;
+
+  for (auto& builder : wireSpanBuilders) {
+    builders.push_back([context, &builder](StagingBuffer& staging) {
+      rebuildWireSpans(context, staging, builder);
+    });
+  }
+
+  return ObjectStaging::build(builders);
+}
+
+internal void commitWires(GmContext* context, std::vector<StagingBuffer>& buffers) {
+  for (auto& buffer : buffers) {
+    ObjectStaging::commitBuffer(context, buffer, generatedObjects);
+  }
 
   #if GAMMA_DEVELOPER_MODE
     Console::log("Generated", objects("mini-flag").totalActive(), "mini flags");
@@ -549,13 +744,10 @@ internal void rebuildMiniFlagWires(GmContext* context) {
 }
 
 // @todo create as pieces
-internal void rebuildDynamicBuildings(GmContext* context) {
-  objects("building-1-body").reset();
-  objects("building-1-frame").reset();
-
-  for (auto& building : objects("building-1")) {
-    auto& body = create_object_from("building-1-body");
-    auto& frame = create_object_from("building-1-frame");
+internal void rebuildDynamicBuilding(GmContext* context, StagingBuffer& staging, const Object& building, const std::string& meshName) {
+  if (meshName == "building-1") {
+    auto& body = stage_generated_object("building-1-body", building);
+    auto& frame = stage_generated_object("building-1-frame", building);
 
     body.position = building.position;
     body.scale = building.scale;
@@ -566,49 +758,70 @@ internal void rebuildDynamicBuildings(GmContext* context) {
     frame.scale = building.scale;
     frame.rotation = building.rotation;
     frame.color = Vec3f(1.f);
-
-    commit(body);
-    commit(frame);
-  }
-
-  objects("yuki-building-1-frame").reset();
-
-  for (auto& building : objects("yuki-building-1")) {
-    auto& frame = create_object_from("yuki-building-1-frame");
+  } else if (meshName == "yuki-building-1") {
+    auto& frame = stage_generated_object("yuki-building-1-frame", building);
 
     frame.position = building.position;
     frame.scale = building.scale;
     frame.rotation = building.rotation;
     frame.color = Vec3f(0.5f, 0.4f, 0.3f);
-
-    commit(frame);
-  }
-
-  objects("yuki-building-2-frame").reset();
-
-  for (auto& building : objects("yuki-building-2")) {
-    auto& frame = create_object_from("yuki-building-2-frame");
+  } else if (meshName == "yuki-building-2") {
+    auto& frame = stage_generated_object("yuki-building-2-frame", building);
 
     frame.position = building.position;
     frame.scale = building.scale;
     frame.rotation = building.rotation;
     frame.color = Vec3f(0.2f, 0.15f, 0.15f);
-
-    commit(frame);
-  }
-
-  objects("yuki-building-3-frame").reset();
-
-  for (auto& building : objects("yuki-building-3")) {
-    auto& frame = create_object_from("yuki-building-3-frame");
+  } else if (meshName == "yuki-building-3") {
+    auto& frame = stage_generated_object("yuki-building-3-frame", building);
 
     frame.position = building.position;
     frame.scale = building.scale;
     frame.rotation = building.rotation;
     frame.color = Vec3f(0.3f, 0.25f, 0.2f);
+  } else if (meshName == "bridge-1") {
+    auto& floor = stage_generated_object("bridge-1-floor", building);
+    auto& supports = stage_generated_object("bridge-1-supports", building);
+    auto& roof = stage_generated_object("bridge-1-roof", building);
+
+    floor.position = supports.position = roof.position = building.position;
+    floor.scale = supports.scale = roof.scale = building.scale;
+    floor.rotation = supports.rotation = roof.rotation = building.rotation;
 
-    commit(frame);
+    floor.color = Vec3f(0.75f);
+    supports.color = Vec3f(1.f, 0.7f, 0.3f);
+    roof.color = Vec3f(0.8f, 0.6f, 0.4f);
+  } else if (meshName == "wave-sign") {
+    auto invertColor = [](const Vec3f& color) {
+      return Vec3f(1.f - color.x, 1.f - color.y, 1.f - color.z);
+    };
+
+    auto& s = stage_generated_object("dynamic-wave-sign", building);
+    auto& s2 = stage_generated_object("dynamic-wave-sign", building);
+
+    s.position = building.position;
+    // @todo consider rotation
+    s2.position = building.position + Vec3f(0, building.scale.y * 0.25f, 0);
+
+    s.scale = building.scale;
+    s2.scale = building.scale * Vec3f(1.f, 0.7f, 1.f);
+
+    s.rotation = s2.rotation = building.rotation;
+
+    s.color = building.color;
+    s2.color = Vec3f::lerp(invertColor(building.color.toVec3f()), Vec3f(1.f), 0.5f);
   }
+}
+
+internal void rebuildDynamicBuildings(GmContext* context, StagingBuffer& staging) {
+  const static std::initializer_list<std::string> buildingMeshNames = {
+    "building-1",
+    "yuki-building-1",
+    "yuki-building-2",
+    "yuki-building-3",
+    "bridge-1",
+    "wave-sign"
+  };
 
   // objects("wood-facade-base").reset();
   // objects("wood-facade-cover").reset();
@@ -628,145 +841,180 @@ internal void rebuildDynamicBuildings(GmContext* context) {
   //   commit(cover);
   // }
 
-  objects("bridge-1-floor").reset();
-  objects("bridge-1-supports").reset();
-  objects("bridge-1-roof").reset();
-
-  for (auto& bridge : objects("bridge-1")) {
-    auto& floor = create_object_from("bridge-1-floor");
-    auto& supports = create_object_from("bridge-1-supports");
-    auto& roof = create_object_from("bridge-1-roof");
-
-    floor.position = supports.position = roof.position = bridge.position;
-    floor.scale = supports.scale = roof.scale = bridge.scale;
-    floor.rotation = supports.rotation = roof.rotation = bridge.rotation;
-
-    floor.color = Vec3f(0.75f);
-    supports.color = Vec3f(1.f, 0.7f, 0.3f);
-    roof.color = Vec3f(0.8f, 0.6f, 0.4f);
-
-    commit(floor);
-    commit(supports);
-    commit(roof);
-  }
-
-  objects("dynamic-wave-sign").reset();
-
-  auto invertColor = [](const Vec3f& color) {
-    return Vec3f(1.f - color.x, 1.f - color.y, 1.f - color.z);
-  };
-
-  for (auto& sign : objects("wave-sign")) {
-    auto& s = create_object_from("dynamic-wave-sign");
-    auto& s2 = create_object_from("dynamic-wave-sign");
-
-    s.position = sign.position;
-    // @todo consider rotation
-    s2.position = sign.position + Vec3f(0, sign.scale.y * 0.25f, 0);
-
-    s.scale = sign.scale;
-    s2.scale = sign.scale * Vec3f(1.f, 0.7f, 1.f);
-
-    s.rotation = s2.rotation = sign.rotation;
-
-    s.color = sign.color;
-    s2.color = Vec3f::lerp(invertColor(sign.color.toVec3f()), Vec3f(1.f), 0.5f);
-
-    commit(s);
-    commit(s2);
+  for (auto& meshName : buildingMeshNames) {
+    for (auto& building : objects(meshName)) {
+      rebuildDynamicBuilding(context, staging, building, meshName);
+    }
   }
 }
 
-internal void rebuildAcUnitFans(GmContext* context) {
-  objects("ac-fan").reset();
+internal void rebuildAcUnitFan(GmContext* context, StagingBuffer& staging, const Object& unit, const std::string& meshName) {
+  auto& fan = stage_generated_object("ac-fan", unit);
 
-  for (auto& unit : objects("ac-unit")) {
-    auto& fan = create_object_from("ac-fan");
+  if (meshName == "ac-unit") {
     Vec3f horizontalOffset = unit.rotation.getLeftDirection().invert() * unit.scale.x * 0.38f;
     Vec3f forwardOffset = unit.rotation.getDirection().invert() * unit.scale.z * 0.2f;
 
     fan.position = unit.position + horizontalOffset + forwardOffset;
-    fan.scale = unit.scale * 0.4f;
-    fan.rotation = unit.rotation;
-    fan.color = Vec3f(0.1f);
+  } else if (meshName == "ac-box") {
+    Vec3f horizontalOffset = unit.rotation.getLeftDirection() * unit.scale.x * 0.4f;
+    Vec3f forwardOffset = unit.rotation.getDirection() * unit.scale.z * 0.4f;
+
+    fan.position = unit.position + horizontalOffset + forwardOffset;
+  }
 
-    commit(fan);
+  fan.scale = unit.scale * 0.4f;
+  fan.rotation = unit.rotation;
+  fan.color = Vec3f(0.1f);
+}
+
+internal void rebuildAcUnitFans(GmContext* context, StagingBuffer& staging) {
+  for (auto& unit : objects("ac-unit")) {
+    rebuildAcUnitFan(context, staging, unit, "ac-unit");
   }
 
   for (auto& box : objects("ac-box")) {
-    auto& fan = create_object_from("ac-fan");
-    Vec3f horizontalOffset = box.rotation.getLeftDirection() * box.scale.x * 0.4f;
-    Vec3f forwardOffset = box.rotation.getDirection() * box.scale.z * 0.4f;
+    rebuildAcUnitFan(context, staging, box, "ac-box");
+  }
+}
 
-    fan.position = box.position + horizontalOffset + forwardOffset;
-    fan.scale = box.scale * 0.4f;
-    fan.rotation = box.rotation;
-    fan.color = Vec3f(0.1f);
+internal void rebuildWindTurbine(GmContext* context, StagingBuffer& staging, const Object& base) {
+  auto& turbine = stage_generated_object("wind-turbine", base);
+  Vec3f verticalOffset = base.rotation.getUpDirection() * base.scale.z * 1.13f;
+  Vec3f forwardOffset = base.rotation.getDirection() * base.scale.z * 0.1f;
+
+  turbine.position = base.position + verticalOffset + forwardOffset;
+  turbine.scale = base.scale;
+  turbine.rotation = base.rotation;
+  turbine.color = Vec3f(1.f);
+}
 
-    commit(fan);
+internal void rebuildWindTurbines(GmContext* context, StagingBuffer& staging) {
+  for (auto& base : objects("wind-turbine-base")) {
+    rebuildWindTurbine(context, staging, base);
   }
 }
 
-internal void rebuildWindTurbines(GmContext* context) {
-  objects("wind-turbine").reset();
+// @todo define as pieces
+internal void rebuildSignRoof(GmContext* context, StagingBuffer& staging, const Object& base) {
+  auto& supports = stage_generated_object("sign-roof-supports", base);
+  auto& signs = stage_generated_object("sign-roof-signs", base);
 
-  for (auto& base : objects("wind-turbine-base")) {
-    auto& turbine = create_object_from("wind-turbine");
-    Vec3f verticalOffset = base.rotation.getUpDirection() * base.scale.z * 1.13f;
-    Vec3f forwardOffset = base.rotation.getDirection() * base.scale.z * 0.1f;
+  supports.position = signs.position = base.position;
+  supports.rotation = signs.rotation = base.rotation;
+  supports.scale = signs.scale = base.scale;
 
-    turbine.position = base.position + verticalOffset + forwardOffset;
-    turbine.scale = base.scale;
-    turbine.rotation = base.rotation;
-    turbine.color = Vec3f(1.f);
+  supports.color = Vec3f(0.9f, 0.6f, 0.3f);
+  signs.color = base.color;
+}
 
-    commit(turbine);
+internal void rebuildSignRoofs(GmContext* context, StagingBuffer& staging) {
+  for (auto& base : objects("sign-roof")) {
+    rebuildSignRoof(context, staging, base);
   }
 }
 
-// @todo define as pieces
-internal void rebuildSignRoofs(GmContext* context) {
-  objects("sign-roof-supports").reset();
-  objects("sign-roof-signs").reset();
+internal void rebuildPetalSpawn(GmContext* context, StagingBuffer& staging, const Object& spawn) {
+  auto factor = spawn.scale.magnitude() * 5.f;
+  u16 total = (u16)factor;
+  float radius = factor * 5.f;
+  // Seeded per spawn, since petals may be staged on any thread
+  u32 seed = ObjectStaging::getSeed(spawn.position);
 
-  for (auto& base : objects("sign-roof")) {
-    auto& supports = create_object_from("sign-roof-supports");
-    auto& signs = create_object_from("sign-roof-signs");
+  for (u16 i = 0; i < total; i++) {
+    auto& petal = stage_generated_object("petal", spawn);
 
-    supports.position = signs.position = base.position;
-    supports.rotation = signs.rotation = base.rotation;
-    supports.scale = signs.scale = base.scale;
+    petal.position = spawn.position + Vec3f(
+      ObjectStaging::random(seed, -radius, radius),
+      ObjectStaging::random(seed, -radius, radius),
+      ObjectStaging::random(seed, -radius, radius)
+    );
 
-    supports.color = Vec3f(0.9f, 0.6f, 0.3f);
-    signs.color = base.color;
+    petal.color = Vec3f(1.f, ObjectStaging::random(seed, 0.3f, 0.6f), ObjectStaging::random(seed, 0.3f, 0.6f));
+  }
+}
 
-    commit(supports);
-    commit(signs);
+internal void rebuildPetals(GmContext* context, StagingBuffer& staging) {
+  for (auto& spawn : objects("petal-spawn")) {
+    rebuildPetalSpawn(context, staging, spawn);
   }
 }
 
-internal void rebuildPetals(GmContext* context) {
+internal void resetDynamicMeshPools(GmContext* context) {
+  for (auto& asset : GameMeshes::meshAssets) {
+    for (auto& piece : asset.pieces) {
+      objects(piece.name).reset();
+    }
+  }
+
+  objects("metal-stair-step").reset();
+  objects("wood-stair-step").reset();
+  objects("streetlamp-light").reset();
+  objects("streetlamp-frame").reset();
+  objects("building-1-body").reset();
+  objects("building-1-frame").reset();
+  objects("yuki-building-1-frame").reset();
+  objects("yuki-building-2-frame").reset();
+  objects("yuki-building-3-frame").reset();
+  objects("bridge-1-floor").reset();
+  objects("bridge-1-supports").reset();
+  objects("bridge-1-roof").reset();
+  objects("dynamic-wave-sign").reset();
+  objects("ac-fan").reset();
+  objects("wind-turbine").reset();
+  objects("sign-roof-supports").reset();
+  objects("sign-roof-signs").reset();
   objects("petal").reset();
+}
 
-  for (auto& spawn : objects("petal-spawn")) {
-    auto factor = spawn.scale.magnitude() * 5.f;
-    u16 total = (u16)factor;
-    float radius = factor * 5.f;
+/**
+ * Regenerates the objects belonging to a single source object,
+ * including the wire spans connecting it to other objects.
+ */
+internal void rebuildDynamicMeshesForSource(GmContext* context, Object& source) {
+  auto& meshName = context->scene.meshes[source._record.meshIndex]->name;
+  StagingBuffer staging;
 
-    for (u16 i = 0; i < total; i++) {
-      auto& petal = create_object_from("petal");
+  for (auto& asset : GameMeshes::meshAssets) {
+    if (asset.name == meshName && asset.pieces.size() > 0) {
+      rebuildMeshPieces(context, staging, asset, source);
 
-      petal.position = spawn.position + Vec3f(
-        Gm_Randomf(-radius, radius),
-        Gm_Randomf(-radius, radius),
-        Gm_Randomf(-radius, radius)
-      );
+      break;
+    }
+  }
 
-      petal.color = Vec3f(1.f, Gm_Randomf(0.3f, 0.6f), Gm_Randomf(0.3f, 0.6f));
+  if (meshName == "metal-staircase") {
+    rebuildDynamicStaircase(context, staging, source, "metal");
+  } else if (meshName == "wood-staircase") {
+    rebuildDynamicStaircase(context, staging, source, "wood");
+  } else if (meshName == "streetlamp") {
+    rebuildStreetlampLight(context, staging, source);
+  } else if (
+    meshName == "building-1" ||
+    meshName == "yuki-building-1" ||
+    meshName == "yuki-building-2" ||
+    meshName == "yuki-building-3" ||
+    meshName == "bridge-1" ||
+    meshName == "wave-sign"
+  ) {
+    rebuildDynamicBuilding(context, staging, source, meshName);
+  } else if (meshName == "ac-unit" || meshName == "ac-box") {
+    rebuildAcUnitFan(context, staging, source, meshName);
+  } else if (meshName == "wind-turbine-base") {
+    rebuildWindTurbine(context, staging, source);
+  } else if (meshName == "sign-roof") {
+    rebuildSignRoof(context, staging, source);
+  } else if (meshName == "petal-spawn") {
+    rebuildPetalSpawn(context, staging, source);
+  }
 
-      commit(petal);
+  for (auto& builder : wireSpanBuilders) {
+    if (builder.sourceMeshName == meshName) {
+      rebuildWireSpansForSource(context, staging, builder, source);
     }
   }
+
+  ObjectStaging::commitBuffer(context, staging, generatedObjects);
 }
 
 internal void applyLevelSettings_UmimuraAlpha(GmContext* context, GameState& state) {
@@ -1012,56 +1260,142 @@ void World::initializeGameWorld(GmContext* context, GameState& state) {
   }
 }
 
-void World::rebuildDynamicMeshes(GmContext* context) {
-  auto start = Gm_GetMicroseconds();
+/**
+ * Removes all generated objects, ahead of building
+ * or restoring new ones.
+ */
+internal void resetGeneratedMeshes(GmContext* context) {
+  ObjectStaging::resetGeneratedObjects(context, generatedObjects);
 
-  {
-    for (auto& asset : GameMeshes::meshAssets) {
-      for (auto& piece : asset.pieces) {
-        objects(piece.name).reset();
-
-        for (auto& source : objects(asset.name)) {
-          auto& pieceObject = create_object_from(piece.name);
-
-          pieceObject.position = source.position;
-          pieceObject.scale = source.scale;
-          pieceObject.rotation = source.rotation;
+  resetDynamicMeshPools(context);
+  resetWires(context);
+  ProceduralMeshes::resetProceduralMeshes(context);
+}
 
-          if (piece.rebuild != nullptr) {
-            piece.rebuild(source, pieceObject);
-          }
+internal void buildGeneratedMeshes(GmContext* context, GeneratedMeshes& meshes) {
+  // Builders only stage objects, so they can run in parallel.
+  // Committing the buffers in order afterward produces the
+  // same objects as building them one after another.
+  std::vector<StagingBuilder> builders;
 
-          commit(pieceObject);
+  for (auto& asset : GameMeshes::meshAssets) {
+    if (asset.pieces.size() > 0) {
+      builders.push_back([context, &asset](StagingBuffer& staging) {
+        for (auto& source : objects(asset.name)) {
+          rebuildMeshPieces(context, staging, asset, source);
         }
-      }
+      });
     }
   }
 
-  rebuildDynamicStaircases(context);
-  rebuildStreetlampLights(context);
-  rebuildDynamicBuildings(context);
-  rebuildAcUnitFans(context);
-  rebuildWindTurbines(context);
-  rebuildSignRoofs(context);
-  rebuildPetals(context);
+  #define add_builder(builder) builders.push_back([context](StagingBuffer& staging) { builder(context, staging); })
 
-  // @todo move these to procedural_meshes.cpp
-  {
-    objects("wire").reset();
+  add_builder(rebuildDynamicStaircases);
+  add_builder(rebuildStreetlampLights);
+  add_builder(rebuildDynamicBuildings);
+  add_builder(rebuildAcUnitFans);
+  add_builder(rebuildWindTurbines);
+  add_builder(rebuildSignRoofs);
+  add_builder(rebuildPetals);
+
+  #undef add_builder
 
-    rebuildElectricalWires(context);
-    rebuildMiniFlagWires(context);
+  meshes.dynamicMeshes = ObjectStaging::build(builders);
+  meshes.wires = buildWires(context);
+  meshes.proceduralMeshes = ProceduralMeshes::buildProceduralMeshes(context);
+}
+
+internal void commitGeneratedMeshes(GmContext* context, GeneratedMeshes& meshes) {
+  for (auto& buffer : meshes.dynamicMeshes) {
+    ObjectStaging::commitBuffer(context, buffer, generatedObjects);
   }
 
-  ProceduralMeshes::rebuildProceduralMeshes(context);
+  #if GAMMA_DEVELOPER_MODE
+    Console::log("Generated", objects("metal-stair-step").totalActive(), "metal stair steps");
+    Console::log("Generated", objects("wood-stair-step").totalActive(), "wood stair steps");
+  #endif
+
+  commitWires(context, meshes.wires);
+  ProceduralMeshes::commitProceduralMeshes(context, meshes.proceduralMeshes);
 
   for (auto& asset : GameMeshes::proceduralMeshParts) {
     Console::log("Created", objects(asset.name).totalActive(), asset.name, "meshes");
   }
+}
+
+/**
+ * Restores a level's generated meshes from its procedural
+ * cache, provided the level's world objects haven't changed
+ * since the cache was written. Otherwise, the meshes are
+ * regenerated and the cache is rewritten.
+ *
+ * Levels may be edited in developer mode, so generated meshes
+ * are always regenerated there (keeping track of their source
+ * objects for the editor), and the cache is refreshed.
+ */
+internal void loadGeneratedMeshes(GmContext* context, const std::string& levelName, u64 inputHash) {
+  auto start = Gm_GetMicroseconds();
+  auto cachePath = "./game/cache/" + levelName + "/procedural_cache.bin";
+  GeneratedMeshes meshes;
+
+  resetGeneratedMeshes(context);
+
+  #if !GAMMA_DEVELOPER_MODE
+    if (ProceduralCache::load(context, cachePath, inputHash, meshes)) {
+      commitGeneratedMeshes(context, meshes);
+
+      Console::log("Restored dynamic meshes in", (Gm_GetMicroseconds() - start), "us");
+
+      return;
+    }
+
+    meshes = GeneratedMeshes();
+  #endif
+
+  buildGeneratedMeshes(context, meshes);
+  commitGeneratedMeshes(context, meshes);
+
+  Console::log("Rebuilt dynamic meshes in", (Gm_GetMicroseconds() - start), "us");
+
+  if (!ProceduralCache::save(context, cachePath, inputHash, meshes)) {
+    Console::warn("Failed to write procedural cache:", cachePath);
+  }
+}
+
+void World::rebuildDynamicMeshes(GmContext* context) {
+  auto start = Gm_GetMicroseconds();
+  GeneratedMeshes meshes;
+
+  resetGeneratedMeshes(context);
+  buildGeneratedMeshes(context, meshes);
+  commitGeneratedMeshes(context, meshes);
 
   Console::log("Rebuilt dynamic meshes in", (Gm_GetMicroseconds() - start), "us");
 }
 
+/**
+ * Replaces the generated objects belonging to a created, modified
+ * or removed source object. Used by the editor in place of a full
+ * rebuildDynamicMeshes() after each action.
+ */
+void World::rebuildDynamicMeshesForObject(GmContext* context, const Object& object) {
+  auto start = Gm_GetMicroseconds();
+
+  ObjectStaging::removeGeneratedObjects(context, generatedObjects, object._record);
+
+  auto* liveObject = get_object_by_record(object._record);
+
+  if (liveObject != nullptr) {
+    rebuildDynamicMeshesForSource(context, *liveObject);
+  }
+
+  ProceduralMeshes::rebuildProceduralMeshesForObject(context, object);
+
+  #if GAMMA_DEVELOPER_MODE
+    Console::log("Rebuilt object dynamic meshes in", (Gm_GetMicroseconds() - start), "us");
+  #endif
+}
+
 void World::rebuildDynamicCollisionPlanes(GmContext* context, GameState& state) {
   const static Vec3f DEFAULT_COLOR = Vec3f(0.5f, 0.5f, 1.f);
 
@@ -1221,11 +1555,11 @@ void World::loadLevel(GmContext* context, GameState& state, const std::string& l
   }
 
   loadStaticCollisionPlanes(context, state, levelName);
-  loadWorldObjects(context, state, levelName);
+  u64 inputHash = loadWorldObjects(context, state, levelName);
+
   loadLights(context, levelName);
   loadNpcData(context, state, levelName);
-
-  World::rebuildDynamicMeshes(context);
+  loadGeneratedMeshes(context, levelName, inputHash);
   World::rebuildDynamicCollisionPlanes(context, state);
 
   // Save initial reference copies of moving objects
@@ -11,6 +11,7 @@
 namespace World {
   void initializeGameWorld(GmContext* context, GameState& state);
   void rebuildDynamicMeshes(GmContext* context);
+  void rebuildDynamicMeshesForObject(GmContext* context, const Gamma::Object& object);
   void rebuildDynamicCollisionPlanes(GmContext* context, GameState& state);
   void loadLevel(GmContext* context, GameState& state, const std::string& levelName);
 }
\ No newline at end of file
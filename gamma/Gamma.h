@@ -5,13 +5,16 @@
 #include "math/utilities.h"
 #include "math/vector.h"
 #include "performance/benchmark.h"
+#include "performance/memory.h"
 #include "system/console.h"
 #include "system/context.h"
 #include "system/lights_objects_meshes.h"
 #include "system/file.h"
 #include "system/flags.h"
+#include "system/frame_allocator.h"
 #include "system/immediate_ui.h"
 #include "system/macros.h"
+#include "system/parallel.h"
 #include "system/random.h"
 #include "system/scene.h"
 #include "system/string_helpers.h"
@@ -27,6 +27,23 @@ inline float Gm_Clampf(float value) {
   return Gm_Clampf(value, 0.f, 1.f);
 }
 
+/**
+ * Interpolates between b and c along a cubic spline through
+ * the points a, b, c and d.
+ *
+ * Adapted from http://paulbourke.net/miscellaneous/interpolation/
+ */
+inline float Gm_CubicSplinef(float a, float b, float c, float d, float alpha) {
+  float m = alpha * alpha;
+
+  float a0 = d - c - a + b;
+  float a1 = a - b - a0;
+  float a2 = c - a;
+  float a3 = b;
+
+  return (a0 * alpha * m) + (a1 * m) + (a2 * alpha) + a3;
+}
+
 inline float Gm_Lerpf(float a, float b, float alpha) {
   return a + (b - a) * alpha;
 }
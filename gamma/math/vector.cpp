@@ -117,6 +117,14 @@ namespace Gamma {
     printf("{ x: %f, y: %f, z: %f }\n", x, y, z);
   }
 
+  Vec3f Vec3f::cubicSpline(const Vec3f& v1, const Vec3f& v2, const Vec3f& v3, const Vec3f& v4, float alpha) {
+    return Vec3f(
+      Gm_CubicSplinef(v1.x, v2.x, v3.x, v4.x, alpha),
+      Gm_CubicSplinef(v1.y, v2.y, v3.y, v4.y, alpha),
+      Gm_CubicSplinef(v1.z, v2.z, v3.z, v4.z, alpha)
+    );
+  }
+
   float Vec3f::dot(const Vec3f& v1, const Vec3f& v2) {
     return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
   }
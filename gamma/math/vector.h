@@ -18,6 +18,7 @@ namespace Gamma {
     float z = 0.0f;
 
     static Vec3f cross(const Vec3f& v1, const Vec3f& v2);
+    static Vec3f cubicSpline(const Vec3f& v1, const Vec3f& v2, const Vec3f& v3, const Vec3f& v4, float alpha);
     static float dot(const Vec3f& v1, const Vec3f& v2);
     static Vec3f reflect(const Vec3f& v1, const Vec3f& v2);
     static Vec3f lerp(const Vec3f& v1, const Vec3f& v2, float alpha);
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cmath>
+
+#include "glew.h"
+
+#include "opengl/OpenGLLightClusters.h"
+#include "math/constants.h"
+
+namespace Gamma {
+  enum GLBuffer {
+    LIGHTS,
+    RANGES,
+    INDICES
+  };
+
+  void OpenGLLightClusters::init() {
+    glGenBuffers(3, &buffers[0]);
+  }
+
+  void OpenGLLightClusters::destroy() {
+    glDeleteBuffers(3, &buffers[0]);
+  }
+
+  /**
+   * OpenGLLightClusters::bind
+   * -------------------------
+   *
+   * Binds the light, cluster range and light index buffers
+   * to shader storage binding points 0, 1 and 2.
+   */
+  void OpenGLLightClusters::bind() {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[GLBuffer::LIGHTS]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, buffers[GLBuffer::RANGES]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffers[GLBuffer::INDICES]);
+  }
+
+  const LightClusters& OpenGLLightClusters::getClusters() const {
+    return clusters;
+  }
+
+  u32 OpenGLLightClusters::getTotalPointLights() const {
+    return totalPointLights;
+  }
+
+  /**
+   * OpenGLLightClusters::update
+   * ---------------------------
+   *
+   * Rebuilds the light clusters for the current view and
+   * uploads them to the GPU. Point lights are placed ahead
+   * of spot lights in the light buffer, so the shader can
+   * distinguish them by index.
+   *
+   * matView and matProjection should be untransposed, with
+   * matProjection created by Matrix4f::glPerspective().
+   */
+  void OpenGLLightClusters::update(const std::vector<Light*>& pointLights, const std::vector<Light*>& spotLights, const Matrix4f& matView, const Matrix4f& matProjection) {
+    // Recover the projection parameters, since probes are
+    // rendered with a different projection than the camera
+    float f = matProjection.m[5];
+    float fov = 2.f * atanf(1.f / f) / DEGREES_TO_RADIANS;
+    float aspectRatio = f / matProjection.m[0];
+    float near = matProjection.m[11] / (matProjection.m[10] - 1.f);
+    float far = matProjection.m[11] / (matProjection.m[10] + 1.f);
+
+    lights.clear();
+    lights.insert(lights.end(), pointLights.begin(), pointLights.end());
+    lights.insert(lights.end(), spotLights.begin(), spotLights.end());
+
+    totalPointLights = (u32)pointLights.size();
+
+    Gm_BuildLightClusters(clusters, lights, matView, fov, aspectRatio, near, far);
+
+    clusterLights.resize(lights.size());
+
+    for (u32 i = 0; i < lights.size(); i++) {
+      auto& light = *lights[i];
+      auto& clusterLight = clusterLights[i];
+
+      clusterLight.position = light.position;
+      clusterLight.radius = light.radius;
+      clusterLight.color = light.color;
+      clusterLight.power = light.power;
+      clusterLight.direction = light.direction.unit();
+      clusterLight.fov = light.fov;
+    }
+
+    // Avoid zero-sized buffer stores when there are no hits
+    u32 totalIndices = std::max((u32)clusters.lightIndices.size(), 1u);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[GLBuffer::LIGHTS]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ClusterLight) * clusterLights.size(), clusterLights.data(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[GLBuffer::RANGES]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(LightClusterRange) * clusters.ranges.size(), clusters.ranges.data(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[GLBuffer::INDICES]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(u32) * totalIndices, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(u32) * clusters.lightIndices.size(), clusters.lightIndices.data());
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "math/matrix.h"
+#include "system/light_clusters.h"
+#include "system/lights_objects_meshes.h"
+#include "system/traits.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * ClusterLight
+   * ------------
+   *
+   * A light as laid out in the clustered lighting shader's
+   * light buffer (std430).
+   */
+  struct ClusterLight {
+    Vec3f position;
+    float radius;
+    Vec3f color;
+    float power;
+    Vec3f direction;
+    float fov;
+  };
+
+  class OpenGLLightClusters : public Initable, public Destroyable {
+  public:
+    virtual void init() override;
+    virtual void destroy() override;
+    void bind();
+    const LightClusters& getClusters() const;
+    u32 getTotalPointLights() const;
+    void update(const std::vector<Light*>& pointLights, const std::vector<Light*>& spotLights, const Matrix4f& matView, const Matrix4f& matProjection);
+
+  private:
+    LightClusters clusters;
+    std::vector<Light*> lights;
+    std::vector<ClusterLight> clusterLights;
+    u32 totalPointLights = 0;
+    /**
+     * Shader storage buffers for clustered lighting.
+     *
+     * [0] Lights
+     * [1] Cluster ranges
+     * [2] Cluster light indices
+     */
+    GLuint buffers[3];
+  };
+}
@@ -1,8 +1,11 @@
 #include "opengl/errors.h"
 #include "opengl/indirect_buffer.h"
 #include "opengl/OpenGLMesh.h"
+#include "performance/memory.h"
 #include "system/console.h"
 #include "system/flags.h"
+#include "system/ObjectPool.h"
+#include "system/visibility.h"
 
 #include "glew.h"
 
@@ -10,7 +13,7 @@ namespace Gamma {
   const enum GLBuffer {
     VERTEX,
     COLOR,
-    MATRIX
+    TRANSFORM
   };
 
   const enum GLAttribute {
@@ -19,10 +22,17 @@ namespace Gamma {
     VERTEX_TANGENT,
     VERTEX_UV,
     MODEL_COLOR,
-    MODEL_MATRIX
+    MODEL_MATRIX,
+    // Model matrices occupy four attribute locations
+    INSTANCE_POSITION = MODEL_MATRIX + 4,
+    INSTANCE_ROTATION,
+    INSTANCE_SCALE,
+    // Constant for each draw call, rather than per-instance
+    INSTANCE_FORMAT
   };
 
   u32 OpenGLMesh::totalDrawCalls = 0;
+  u32 OpenGLMesh::frame = 0;
 
   OpenGLMesh::OpenGLMesh(Mesh* mesh) {
     sourceMesh = mesh;
@@ -43,6 +53,10 @@ namespace Gamma {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, faceElements.size() * sizeof(u32), faceElements.data(), GL_STATIC_DRAW);
 
+    staticBufferSize = vertices.size() * sizeof(Vertex) + faceElements.size() * sizeof(u32);
+
+    Gm_TrackAllocation(MEMORY_MESHES, staticBufferSize);
+
     // Define vertex attributes
     glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::VERTEX]);
 
@@ -58,20 +72,8 @@ namespace Gamma {
     glEnableVertexAttribArray(GLAttribute::VERTEX_UV);
     glVertexAttribPointer(GLAttribute::VERTEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
 
-    // Define color attributes
-    glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::COLOR]);
-    glEnableVertexAttribArray(GLAttribute::MODEL_COLOR);
-    glVertexAttribIPointer(GLAttribute::MODEL_COLOR, 1, GL_UNSIGNED_INT, sizeof(pVec4), (void*)0);
-    glVertexAttribDivisor(GLAttribute::MODEL_COLOR, 1);
-
-    // Define matrix attributes
-    glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::MATRIX]);
-
-    for (u32 i = 0; i < 4; i++) {
-      glEnableVertexAttribArray(GLAttribute::MODEL_MATRIX + i);
-      glVertexAttribPointer(GLAttribute::MODEL_MATRIX + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4f), (void*)(i * 4 * sizeof(float)));
-      glVertexAttribDivisor(GLAttribute::MODEL_MATRIX + i, 1);
-    }
+    // Define color and matrix attributes
+    bindInstanceAttributes(buffers[GLBuffer::COLOR], buffers[GLBuffer::TRANSFORM]);
   }
 
   OpenGLMesh::~OpenGLMesh() {
@@ -79,6 +81,13 @@ namespace Gamma {
     glDeleteBuffers(3, &buffers[0]);
     glDeleteBuffers(1, &ebo);
 
+    for (auto& [ viewId, view ] : instanceViews) {
+      glDeleteBuffers(1, &view.colorBuffer);
+      glDeleteBuffers(1, &view.transformBuffer);
+    }
+
+    Gm_TrackFree(MEMORY_MESHES, staticBufferSize);
+
     if (glTexture != nullptr) {
       delete glTexture;
     }
@@ -137,7 +146,16 @@ namespace Gamma {
     return sourceMesh->type == type;
   }
 
-  // @todo provide a parameter to render total visible vs. total active
+  /**
+   * OpenGLMesh::render
+   * ------------------
+   *
+   * Renders the mesh's visible objects. If the object pool
+   * was culled, instance data is gathered from its list of
+   * visible object indices; otherwise all active objects are
+   * buffered, packed into compact transforms if the mesh's
+   * instance format calls for them.
+   */
   void OpenGLMesh::render(GLenum primitiveMode, bool useLowestLevelOfDetail) {
     auto& mesh = *sourceMesh;
 
@@ -145,50 +163,43 @@ namespace Gamma {
       return;
     }
 
-    if (mesh.type != MeshType::REFRACTIVE) {
-      // Don't bind textures for refractive objects, since in
-      // the refractive geometry frag shader we need to read
-      // from the G-Buffer color texture.
-      //
-      // @todo if we use texture units which won't conflict with
-      // the G-Buffer, we can have textured refractive objects.
-      checkAndLoadTexture(mesh.texture, glTexture, GL_TEXTURE0);
-    }
-
-    checkAndLoadTexture(mesh.normals, glNormalMap, GL_TEXTURE1);
-
-    if (sourceMesh->transformedVertices.size() > 0) {
-      // Re-buffer geometry
-      auto& transformedVertices = sourceMesh->transformedVertices;
-
-      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::VERTEX]);
-      // @todo glMapBuffer (?)
-      glBufferData(GL_ARRAY_BUFFER, transformedVertices.size() * sizeof(Vertex), transformedVertices.data(), GL_DYNAMIC_DRAW);
-    }
+    checkAndUpdateInstanceFormat();
+    bindTexturesAndVertices();
 
     bool shouldBufferInstances = (
-      // Buffer instances if we haven't created the buffers at all yet
-      !hasCreatedInstanceBuffers ||
+      // Buffer instances if the buffers don't contain our visible objects
+      !areVisibleInstancesBuffered ||
       // Buffer instances for non-GPU particle meshes when any objects are changed
       ((mesh.type != MeshType::PARTICLES || !mesh.particles.useGpuParticles) && mesh.objects.changed)
     );
 
     if (shouldBufferInstances) {
-      // Buffer colors
-      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::COLOR]);
-      glBufferData(GL_ARRAY_BUFFER, mesh.objects.totalVisible() * sizeof(pVec4), mesh.objects.getColors(), GL_DYNAMIC_DRAW);
+      if (mesh.objects.isCulled()) {
+        gatherAndBufferInstances(buffers[GLBuffer::COLOR], buffers[GLBuffer::TRANSFORM], mesh.objects.getVisibleIndices());
+      } else if (instanceFormat == InstanceFormat::FULL_MATRIX) {
+        bufferInstances(buffers[GLBuffer::COLOR], buffers[GLBuffer::TRANSFORM], mesh.objects.getColors(), mesh.objects.getMatrices(), sizeof(Matrix4f), mesh.objects.totalActive());
+      } else {
+        // Compact transforms have to be packed from the
+        // matrices of all active objects
+        activeObjectIndices.resize(mesh.objects.totalActive());
 
-      // Buffer matrices
-      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::MATRIX]);
-      glBufferData(GL_ARRAY_BUFFER, mesh.objects.totalVisible() * sizeof(Matrix4f), mesh.objects.getMatrices(), GL_DYNAMIC_DRAW);
+        for (u16 i = 0; i < mesh.objects.totalActive(); i++) {
+          activeObjectIndices[i] = i;
+        }
+
+        gatherAndBufferInstances(buffers[GLBuffer::COLOR], buffers[GLBuffer::TRANSFORM], activeObjectIndices);
+      }
 
-      hasCreatedInstanceBuffers = true;
+      areVisibleInstancesBuffered = true;
       mesh.objects.changed = false;
     }
 
+    bindInstanceAttributes(buffers[GLBuffer::COLOR], buffers[GLBuffer::TRANSFORM]);
+
     // Bind VAO/EBO and draw instances
     glBindVertexArray(vao);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glVertexAttribI1ui(GLAttribute::INSTANCE_FORMAT, instanceFormat);
 
     if (mesh.lods.size() > 0) {
       if (useLowestLevelOfDetail) {
@@ -236,4 +247,272 @@ namespace Gamma {
 
     totalDrawCalls++;
   }
+
+  /**
+   * OpenGLMesh::renderInstances
+   * ---------------------------
+   *
+   * Renders a specific list of the mesh's objects, e.g. the
+   * shadow casters visible to a light, in place of its own
+   * visible objects. Each view ID gets its own instance
+   * buffers, which are only re-buffered when the list or the
+   * objects change. Meshes with levels of detail either use
+   * the last level of detail, or select levels of detail by
+   * distance from the camera when the list is buffered.
+   */
+  void OpenGLMesh::renderInstances(GLenum primitiveMode, u32 viewId, const std::vector<u16>& objectIndices, const Vec3f& cameraPosition, bool useLowestLevelOfDetail) {
+    auto& mesh = *sourceMesh;
+
+    if (objectIndices.size() == 0 || mesh.disabled) {
+      return;
+    }
+
+    checkAndUpdateInstanceFormat();
+    bindTexturesAndVertices();
+
+    auto& view = instanceViews[viewId];
+
+    if (view.colorBuffer == 0) {
+      glGenBuffers(1, &view.colorBuffer);
+      glGenBuffers(1, &view.transformBuffer);
+    }
+
+    bool useLevelsOfDetail = mesh.lods.size() > 0 && !useLowestLevelOfDetail && mesh.lodDistance > 0.f;
+
+    if (
+      shouldBufferInstanceView(view, objectIndices, useLowestLevelOfDetail) ||
+      // Levels of detail are reselected whenever the camera moves
+      (useLevelsOfDetail && view.cameraPosition != cameraPosition)
+    ) {
+      if (useLevelsOfDetail) {
+        lodObjectIndices = objectIndices;
+
+        Gm_PartitionObjectsByLod(mesh.objects, lodObjectIndices, (u32)mesh.lods.size(), mesh.lodDistance, cameraPosition, view.lodOffsets);
+        gatherAndBufferInstances(view.colorBuffer, view.transformBuffer, lodObjectIndices);
+      } else {
+        view.lodOffsets.clear();
+
+        gatherAndBufferInstances(view.colorBuffer, view.transformBuffer, objectIndices);
+      }
+
+      view.objectIndices = objectIndices;
+      view.format = instanceFormat;
+      view.version = mesh.objects.version;
+      view.cameraPosition = cameraPosition;
+      view.useLowestLevelOfDetail = useLowestLevelOfDetail;
+      view.isBuffered = true;
+    }
+
+    bindInstanceAttributes(view.colorBuffer, view.transformBuffer);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glVertexAttribI1ui(GLAttribute::INSTANCE_FORMAT, instanceFormat);
+
+    if (mesh.lods.size() > 0 && view.lodOffsets.size() > 0) {
+      // Draw each level of detail group together
+      //
+      // @todo preallocate draw commands array
+      auto* commands = new GlDrawElementsIndirectCommand[mesh.lods.size()];
+
+      for (u32 i = 0; i < mesh.lods.size(); i++) {
+        auto& command = commands[i];
+        auto& lod = mesh.lods[i];
+
+        command.count = lod.elementCount;
+        command.firstIndex = lod.elementOffset;
+        command.instanceCount = view.lodOffsets[i + 1] - view.lodOffsets[i];
+        command.baseInstance = view.lodOffsets[i];
+        command.baseVertex = 0;
+      }
+
+      Gm_BufferDrawElementsIndirectCommands(commands, (u32)mesh.lods.size());
+
+      glMultiDrawElementsIndirect(primitiveMode, GL_UNSIGNED_INT, 0, (GLsizei)mesh.lods.size(), 0);
+
+      delete[] commands;
+    } else if (mesh.lods.size() > 0) {
+      auto& lod = useLowestLevelOfDetail ? mesh.lods.back() : mesh.lods[0];
+
+      glDrawElementsInstanced(primitiveMode, lod.elementCount, GL_UNSIGNED_INT, (void*)(lod.elementOffset * sizeof(u32)), objectIndices.size());
+    } else if (mesh.type == MeshType::PARTICLES) {
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::VERTEX]);
+
+      glDrawArraysInstanced(GL_POINTS, 0, 1, objectIndices.size());
+    } else {
+      glDrawElementsInstanced(primitiveMode, mesh.faceElements.size(), GL_UNSIGNED_INT, (void*)0, objectIndices.size());
+    }
+
+    totalDrawCalls++;
+  }
+
+  /**
+   * OpenGLMesh::bindInstanceAttributes
+   * ----------------------------------
+   *
+   * Points the per-instance color and transform attributes
+   * at a set of instance buffers, in the current instance
+   * format, disabling the attributes of the other formats.
+   *
+   * @see utils/instance-transform.glsl
+   */
+  void OpenGLMesh::bindInstanceAttributes(GLuint colorBuffer, GLuint transformBuffer) {
+    if (
+      colorBuffer == boundColorBuffer &&
+      transformBuffer == boundTransformBuffer &&
+      instanceFormat == boundFormat
+    ) {
+      return;
+    }
+
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+    glEnableVertexAttribArray(GLAttribute::MODEL_COLOR);
+    glVertexAttribIPointer(GLAttribute::MODEL_COLOR, 1, GL_UNSIGNED_INT, sizeof(pVec4), (void*)0);
+    glVertexAttribDivisor(GLAttribute::MODEL_COLOR, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, transformBuffer);
+
+    if (instanceFormat == InstanceFormat::FULL_MATRIX) {
+      for (u32 i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(GLAttribute::MODEL_MATRIX + i);
+        glVertexAttribPointer(GLAttribute::MODEL_MATRIX + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4f), (void*)(i * 4 * sizeof(float)));
+        glVertexAttribDivisor(GLAttribute::MODEL_MATRIX + i, 1);
+      }
+
+      glDisableVertexAttribArray(GLAttribute::INSTANCE_POSITION);
+      glDisableVertexAttribArray(GLAttribute::INSTANCE_ROTATION);
+      glDisableVertexAttribArray(GLAttribute::INSTANCE_SCALE);
+    } else {
+      for (u32 i = 0; i < 4; i++) {
+        glDisableVertexAttribArray(GLAttribute::MODEL_MATRIX + i);
+      }
+
+      glEnableVertexAttribArray(GLAttribute::INSTANCE_POSITION);
+      glEnableVertexAttribArray(GLAttribute::INSTANCE_ROTATION);
+      glEnableVertexAttribArray(GLAttribute::INSTANCE_SCALE);
+
+      if (instanceFormat == InstanceFormat::COMPACT_TRANSFORM) {
+        glVertexAttribPointer(GLAttribute::INSTANCE_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(pTransform), (void*)TRANSFORM_POSITION_OFFSET);
+        glVertexAttribPointer(GLAttribute::INSTANCE_ROTATION, 4, GL_SHORT, GL_TRUE, sizeof(pTransform), (void*)TRANSFORM_ROTATION_OFFSET);
+        glVertexAttribPointer(GLAttribute::INSTANCE_SCALE, 3, GL_FLOAT, GL_FALSE, sizeof(pTransform), (void*)TRANSFORM_SCALE_OFFSET);
+      } else {
+        glVertexAttribPointer(GLAttribute::INSTANCE_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(pHalfTransform), (void*)TRANSFORM_POSITION_OFFSET);
+        glVertexAttribPointer(GLAttribute::INSTANCE_ROTATION, 4, GL_SHORT, GL_TRUE, sizeof(pHalfTransform), (void*)TRANSFORM_ROTATION_OFFSET);
+        glVertexAttribPointer(GLAttribute::INSTANCE_SCALE, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(pHalfTransform), (void*)TRANSFORM_SCALE_OFFSET);
+      }
+
+      glVertexAttribDivisor(GLAttribute::INSTANCE_POSITION, 1);
+      glVertexAttribDivisor(GLAttribute::INSTANCE_ROTATION, 1);
+      glVertexAttribDivisor(GLAttribute::INSTANCE_SCALE, 1);
+    }
+
+    boundColorBuffer = colorBuffer;
+    boundTransformBuffer = transformBuffer;
+    boundFormat = instanceFormat;
+  }
+
+  void OpenGLMesh::bindTexturesAndVertices() {
+    auto& mesh = *sourceMesh;
+
+    if (mesh.type != MeshType::REFRACTIVE) {
+      // Don't bind textures for refractive objects, since in
+      // the refractive geometry frag shader we need to read
+      // from the G-Buffer color texture.
+      //
+      // @todo if we use texture units which won't conflict with
+      // the G-Buffer, we can have textured refractive objects.
+      checkAndLoadTexture(mesh.texture, glTexture, GL_TEXTURE0);
+    }
+
+    checkAndLoadTexture(mesh.normals, glNormalMap, GL_TEXTURE1);
+
+    if (mesh.transformedVertices.size() > 0 && lastVertexBufferFrame != frame) {
+      // Re-buffer geometry, once per frame across all views
+      auto& transformedVertices = mesh.transformedVertices;
+
+      lastVertexBufferFrame = frame;
+
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::VERTEX]);
+      // @todo glMapBuffer (?)
+      glBufferData(GL_ARRAY_BUFFER, transformedVertices.size() * sizeof(Vertex), transformedVertices.data(), GL_DYNAMIC_DRAW);
+    }
+  }
+
+  void OpenGLMesh::bufferInstances(GLuint colorBuffer, GLuint transformBuffer, const pVec4* colors, const void* transforms, u32 transformSize, u32 total) {
+    // Buffer colors
+    glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+    glBufferData(GL_ARRAY_BUFFER, total * sizeof(pVec4), colors, GL_DYNAMIC_DRAW);
+
+    // Buffer matrices or compact transforms
+    glBindBuffer(GL_ARRAY_BUFFER, transformBuffer);
+    glBufferData(GL_ARRAY_BUFFER, total * transformSize, transforms, GL_DYNAMIC_DRAW);
+  }
+
+  /**
+   * OpenGLMesh::checkAndUpdateInstanceFormat
+   * ----------------------------------------
+   *
+   * Switches to the source mesh's instance format if it has
+   * changed. Particle meshes always use full matrices, since
+   * the particle shaders expect them.
+   */
+  void OpenGLMesh::checkAndUpdateInstanceFormat() {
+    auto& mesh = *sourceMesh;
+    auto format = mesh.type == MeshType::PARTICLES ? InstanceFormat::FULL_MATRIX : mesh.instanceFormat;
+
+    if (format != instanceFormat) {
+      instanceFormat = format;
+
+      // Re-buffer instances in the new format. Other views
+      // are re-buffered once their format no longer matches.
+      areVisibleInstancesBuffered = false;
+    }
+  }
+
+  /**
+   * OpenGLMesh::gatherAndBufferInstances
+   * ------------------------------------
+   *
+   * Gathers the instance data of a list of objects in the
+   * current instance format, and buffers it to the GPU.
+   */
+  void OpenGLMesh::gatherAndBufferInstances(GLuint colorBuffer, GLuint transformBuffer, const std::vector<u16>& objectIndices) {
+    auto& objects = sourceMesh->objects;
+    u32 total = (u32)objectIndices.size();
+
+    switch (instanceFormat) {
+      case InstanceFormat::COMPACT_TRANSFORM:
+        Gm_GatherObjectInstances(objects, objectIndices, instanceTransforms, instanceColors);
+        bufferInstances(colorBuffer, transformBuffer, instanceColors.data(), instanceTransforms.data(), sizeof(pTransform), total);
+        break;
+      case InstanceFormat::COMPACT_HALF_TRANSFORM:
+        Gm_GatherObjectInstances(objects, objectIndices, instanceHalfTransforms, instanceColors);
+        bufferInstances(colorBuffer, transformBuffer, instanceColors.data(), instanceHalfTransforms.data(), sizeof(pHalfTransform), total);
+        break;
+      default:
+        Gm_GatherObjectInstances(objects, objectIndices, instanceMatrices, instanceColors);
+        bufferInstances(colorBuffer, transformBuffer, instanceColors.data(), instanceMatrices.data(), sizeof(Matrix4f), total);
+        break;
+    }
+  }
+
+  /**
+   * OpenGLMesh::shouldBufferInstanceView
+   * ------------------------------------
+   *
+   * Determines whether a view's instance buffers are out of
+   * date, either because its objects changed or because it's
+   * being rendered with a different list of objects.
+   */
+  bool OpenGLMesh::shouldBufferInstanceView(const OpenGLInstanceView& view, const std::vector<u16>& objectIndices, bool useLowestLevelOfDetail) const {
+    return (
+      !view.isBuffered ||
+      view.format != instanceFormat ||
+      view.version != sourceMesh->objects.version ||
+      view.useLowestLevelOfDetail != useLowestLevelOfDetail ||
+      view.objectIndices != objectIndices
+    );
+  }
 }
\ No newline at end of file
@@ -1,15 +1,46 @@
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "opengl/OpenGLTexture.h"
 #include "system/lights_objects_meshes.h"
 #include "system/type_aliases.h"
 
 namespace Gamma {
+  /**
+   * OpenGLInstanceView
+   * ------------------
+   *
+   * Instance buffers for a list of a mesh's objects rendered
+   * in a view other than the main one, e.g. a shadow map. Each
+   * view keeps its own buffers, so unchanged lists don't need
+   * to be re-buffered, and the main view's buffers stay valid.
+   */
+  struct OpenGLInstanceView {
+    GLuint colorBuffer = 0;
+    GLuint transformBuffer = 0;
+    InstanceFormat format = InstanceFormat::FULL_MATRIX;
+    // The object pool version the instances were buffered at
+    u32 version = 0;
+    // The object index list the instances were buffered from
+    std::vector<u16> objectIndices;
+    // The start of each level of detail group in the buffered
+    // instances, followed by the total number of instances
+    std::vector<u32> lodOffsets;
+    // The camera position levels of detail were selected from
+    Vec3f cameraPosition;
+    bool useLowestLevelOfDetail = false;
+    bool isBuffered = false;
+  };
+
   class OpenGLMesh {
   public:
     static u32 totalDrawCalls;
+    // Incremented by the renderer once per frame, so per-frame
+    // data is only buffered once across all views
+    static u32 frame;
 
     OpenGLMesh(Mesh* mesh);
     ~OpenGLMesh();
@@ -21,6 +52,7 @@ namespace Gamma {
     bool hasTexture() const;
     bool isMeshType(MeshType type) const;
     void render(GLenum primitiveMode, bool useLowestLevelOfDetail = false);
+    void renderInstances(GLenum primitiveMode, u32 viewId, const std::vector<u16>& objectIndices, const Vec3f& cameraPosition, bool useLowestLevelOfDetail = false);
 
   private:
     Mesh* sourceMesh = nullptr;
@@ -30,14 +62,45 @@ namespace Gamma {
      *
      * [0] Vertex
      * [1] Color
-     * [2] Matrix
+     * [2] Transform (matrices or compact transforms)
      */
     GLuint buffers[3];
     GLuint ebo;
+    // Size of the vertex and element buffers, in bytes
+    u64 staticBufferSize = 0;
     OpenGLTexture* glTexture = nullptr;
     OpenGLTexture* glNormalMap = nullptr;
-    bool hasCreatedInstanceBuffers = false;
+    // Instance data gathered from object index lists
+    std::vector<Matrix4f> instanceMatrices;
+    std::vector<pTransform> instanceTransforms;
+    std::vector<pHalfTransform> instanceHalfTransforms;
+    std::vector<pVec4> instanceColors;
+    // Indices of all active objects, for packing compact
+    // transforms when the object pool isn't culled
+    std::vector<u16> activeObjectIndices;
+    // View object indices, reordered by level of detail
+    std::vector<u16> lodObjectIndices;
+    // Instance buffers for other views, by view ID
+    std::map<u32, OpenGLInstanceView> instanceViews;
+    // The instance format of the source mesh
+    InstanceFormat instanceFormat = InstanceFormat::FULL_MATRIX;
+    // The instance buffers and format the instance attributes
+    // currently point to
+    GLuint boundColorBuffer = 0;
+    GLuint boundTransformBuffer = 0;
+    InstanceFormat boundFormat = InstanceFormat::FULL_MATRIX;
+    // The frame transformed vertices were last buffered on
+    u32 lastVertexBufferFrame = 0;
+    // Determines whether the instance buffers contain the
+    // mesh's visible objects in the current format
+    bool areVisibleInstancesBuffered = false;
 
+    void bindInstanceAttributes(GLuint colorBuffer, GLuint transformBuffer);
+    void bindTexturesAndVertices();
+    void bufferInstances(GLuint colorBuffer, GLuint transformBuffer, const pVec4* colors, const void* transforms, u32 transformSize, u32 total);
     void checkAndLoadTexture(const std::string& path, OpenGLTexture*& texture, GLenum unit);
+    void checkAndUpdateInstanceFormat();
+    void gatherAndBufferInstances(GLuint colorBuffer, GLuint transformBuffer, const std::vector<u16>& objectIndices);
+    bool shouldBufferInstanceView(const OpenGLInstanceView& view, const std::vector<u16>& objectIndices, bool useLowestLevelOfDetail) const;
   };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <map>
 
 #include "SDL.h"
@@ -44,6 +45,10 @@ namespace Gamma {
     Vec3f(0.0f, -1.0f, 0.0f)
   };
 
+  static inline bool isSameMatrix(const Matrix4f& a, const Matrix4f& b) {
+    return std::memcmp(a.m, b.m, sizeof(a.m)) == 0;
+  }
+
   /**
    * OpenGLRenderer
    * --------------
@@ -78,7 +83,9 @@ namespace Gamma {
     // Initialize renderer
     Gm_InitRendererResources(buffers, shaders, internalResolution);
 
+    lightClusters.init();
     lightDisc.init();
+    text.init();
 
     // Initialize remaining shaders
     screen.init();
@@ -124,7 +131,9 @@ namespace Gamma {
     Gm_DestroyRendererResources(buffers, shaders);
     Gm_DestroyDrawIndirectBuffer();
 
+    lightClusters.destroy();
     lightDisc.destroy();
+    text.destroy();
 
     glDeleteTextures(1, &screenTexture);
 
@@ -133,8 +142,10 @@ namespace Gamma {
 
   void OpenGLRenderer::render() {
     OpenGLMesh::totalDrawCalls = 0;
+    OpenGLMesh::frame++;
     OpenGLScreenQuad::totalDrawCalls = 0;
     OpenGLLightDisc::totalDrawCalls = 0;
+    OpenGLText::totalDrawCalls = 0;
 
     auto& scene = gmContext->scene;
 
@@ -231,14 +242,12 @@ namespace Gamma {
     }
 
     if (Gm_FlagWasEnabled(GammaFlags::ENABLE_DEV_LIGHT_DISCS)) {
-      shaders.pointLight.define("USE_DEV_LIGHT_DISCS", "1");
+      shaders.pointLightGlow.define("USE_DEV_LIGHT_DISCS", "1");
       shaders.pointShadowcaster.define("USE_DEV_LIGHT_DISCS", "1");
-      shaders.spotLight.define("USE_DEV_LIGHT_DISCS", "1");
       shaders.spotShadowcaster.define("USE_DEV_LIGHT_DISCS", "1");
     } else if (Gm_FlagWasDisabled(GammaFlags::ENABLE_DEV_LIGHT_DISCS)) {
-      shaders.pointLight.define("USE_DEV_LIGHT_DISCS", "0");
+      shaders.pointLightGlow.define("USE_DEV_LIGHT_DISCS", "0");
       shaders.pointShadowcaster.define("USE_DEV_LIGHT_DISCS", "0");
-      shaders.spotLight.define("USE_DEV_LIGHT_DISCS", "0");
       shaders.spotShadowcaster.define("USE_DEV_LIGHT_DISCS", "0");
     }
 
@@ -344,55 +353,45 @@ namespace Gamma {
   }
 
   /**
-   * @todo description
+   * Categorizes scene lights by how they should be rendered,
+   * using the scene's per-type light pools.
    */
   void OpenGLRenderer::updateLightArrays() {
-    ctx.pointLights.clear();
+    auto& lights = gmContext->scene.lights;
+    bool renderShadows = Gm_IsFlagEnabled(GammaFlags::RENDER_SHADOWS);
+
+    // Only rebuild the light arrays when lights were added,
+    // removed or changed type, or shadows were toggled
+    if (!lights.changed && renderShadows == areLightArraysShadowed) {
+      return;
+    }
+
+    ctx.pointLights = lights.getLightsByType(LightType::POINT);
+    ctx.directionalLights = lights.getLightsByType(LightType::DIRECTIONAL);
+    ctx.spotLights = lights.getLightsByType(LightType::SPOT);
     ctx.pointShadowcasters.clear();
-    ctx.directionalLights.clear();
     ctx.directionalShadowcasters.clear();
-    ctx.spotLights.clear();
     ctx.spotShadowcasters.clear();
 
-    for (auto* light : gmContext->scene.lights) {
-      switch (light->type) {
-        case LightType::POINT:
-          ctx.pointLights.push_back(light);
-          break;
-        case LightType::POINT_SHADOWCASTER:
-          if (Gm_IsFlagEnabled(GammaFlags::RENDER_SHADOWS)) {
-            ctx.pointShadowcasters.push_back(light);
-          } else {
-            ctx.pointLights.push_back(light);
-          }
-
-          break;
-        case LightType::DIRECTIONAL:
-          ctx.directionalLights.push_back(light);
-          break;
-        case LightType::DIRECTIONAL_SHADOWCASTER:
-          if (Gm_IsFlagEnabled(GammaFlags::RENDER_SHADOWS)) {
-            ctx.directionalShadowcasters.push_back(light);
-          } else {
-            ctx.directionalLights.push_back(light);
-          }
-
-          break;
-        case LightType::SPOT:
-          ctx.spotLights.push_back(light);
-          break;
-        case LightType::SPOT_SHADOWCASTER:
-          if (Gm_IsFlagEnabled(GammaFlags::RENDER_SHADOWS)) {
-            ctx.spotShadowcasters.push_back(light);
-          } else {
-            ctx.spotLights.push_back(light);
-          }
-
-          break;
-      }
+    auto& pointShadowcasters = lights.getLightsByType(LightType::POINT_SHADOWCASTER);
+    auto& directionalShadowcasters = lights.getLightsByType(LightType::DIRECTIONAL_SHADOWCASTER);
+    auto& spotShadowcasters = lights.getLightsByType(LightType::SPOT_SHADOWCASTER);
+
+    if (renderShadows) {
+      ctx.pointShadowcasters = pointShadowcasters;
+      ctx.directionalShadowcasters = directionalShadowcasters;
+      ctx.spotShadowcasters = spotShadowcasters;
+    } else {
+      ctx.pointLights.insert(ctx.pointLights.end(), pointShadowcasters.begin(), pointShadowcasters.end());
+      ctx.directionalLights.insert(ctx.directionalLights.end(), directionalShadowcasters.begin(), directionalShadowcasters.end());
+      ctx.spotLights.insert(ctx.spotLights.end(), spotShadowcasters.begin(), spotShadowcasters.end());
     }
+
+    lights.changed = false;
+    areLightArraysShadowed = renderShadows;
   }
 
+
   /**
    * @todo description
    */
@@ -424,8 +423,8 @@ namespace Gamma {
       renderDirectionalShadowcasters();
     }
 
-    if (ctx.spotLights.size() > 0) {
-      renderSpotLights();
+    if (ctx.pointLights.size() > 0 || ctx.spotLights.size() > 0) {
+      renderClusteredLights();
     }
 
     if (ctx.spotShadowcasters.size() > 0) {
@@ -433,7 +432,7 @@ namespace Gamma {
     }
 
     if (ctx.pointLights.size() > 0) {
-      renderPointLights();
+      renderPointLightGlow();
     }
 
     if (ctx.pointShadowcasters.size() > 0) {
@@ -627,6 +626,11 @@ namespace Gamma {
   void OpenGLRenderer::renderDirectionalShadowMaps() {
     auto& camera = *ctx.activeCamera;
     auto& shader = shaders.shadowLightView;
+    // Only stagger cascade updates for the main camera, since
+    // probe cameras change between each render
+    bool isMainCamera = ctx.activeCamera == &gmContext->scene.camera;
+
+    Gm_UpdateShadowCasterCache(shadowCasterCache, gmContext->scene.meshes, frame);
 
     shader.use();
     shader.setFloat("time", gmContext->contextTime);
@@ -634,44 +638,120 @@ namespace Gamma {
 
     for (u32 mapIndex = 0; mapIndex < glDirectionalShadowMaps.size(); mapIndex++) {
       auto& glShadowMap = *glDirectionalShadowMaps[mapIndex];
-      auto& light = *ctx.directionalShadowcasters[mapIndex];
+      auto& light = *glShadowMap.light;
 
-      glShadowMap.buffer.write();
+      for (u8 cascadeIndex = 0; cascadeIndex < 4; cascadeIndex++) {
+        auto& cascade = glShadowMap.cascades[cascadeIndex];
+
+        if (isMainCamera && cascade.isRendered && !Gm_ShouldUpdateShadowCascade(cascadeIndex, frame)) {
+          continue;
+        }
 
-      for (u32 cascade = 0; cascade < 4; cascade++) {
-        glShadowMap.buffer.writeToAttachment(cascade);
-        Matrix4f matLightViewProjection = Gm_CreateCascadedLightViewProjectionMatrixGL(cascade, light.direction, camera);
+        Matrix4f matLightViewProjection = Gm_CreateCascadedLightViewProjectionMatrixGL(cascadeIndex, light.direction, camera);
+        Matrix4f matCascade = matLightViewProjection.transpose();
+
+        bool isCascadeUnchanged = cascade.isRendered && isSameMatrix(matLightViewProjection, cascade.matLightViewProjection);
+
+        bool hasValidStaticLayer = (
+          cascade.hasStaticLayer &&
+          cascade.staticGeneration == shadowCasterCache.staticGeneration &&
+          isSameMatrix(matLightViewProjection, cascade.matStaticLightViewProjection)
+        );
+
+        // Static caster layers are discarded as soon as a cascade
+        // moves, so only render one once a cascade stays in place
+        bool useStaticLayer = hasValidStaticLayer || isCascadeUnchanged;
 
         shader.setMatrix4f("matLightViewProjection", matLightViewProjection);
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (useStaticLayer && !hasValidStaticLayer) {
+          glShadowMap.staticBuffer.write();
+          glShadowMap.staticBuffer.writeToAttachment(cascadeIndex);
 
-        // @todo glMultiDrawElementsIndirect for static world geometry
-        // (will require a handful of other changes to mesh organization/data buffering)
-        for (auto* glMesh : glMeshes) {
-          auto& mesh = *glMesh->getSourceMesh();
+          glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-          if (
-            mesh.type == MeshType::PARTICLES ||
-            !mesh.canCastShadows ||
-            mesh.maxCascade < (cascade + 1)
-          ) {
-            continue;
-          }
+          renderCascadeCasters(mapIndex, cascadeIndex, matCascade, ShadowCasterFilter::STATIC_CASTERS);
+
+          cascade.matStaticLightViewProjection = matLightViewProjection;
+          cascade.staticGeneration = shadowCasterCache.staticGeneration;
+          cascade.hasStaticLayer = true;
+        }
+
+        glShadowMap.buffer.write();
+        glShadowMap.buffer.writeToAttachment(cascadeIndex);
+
+        if (useStaticLayer) {
+          glClear(GL_DEPTH_BUFFER_BIT);
+
+          glShadowMap.staticBuffer.copyColorAttachment(cascadeIndex, glShadowMap.buffer, cascadeIndex);
+
+          // Keep the nearest depth between the static layer
+          // and dynamic casters
+          glEnable(GL_BLEND);
+          glBlendEquation(GL_MIN);
 
-          auto& animation = mesh.animation;
+          renderCascadeCasters(mapIndex, cascadeIndex, matCascade, ShadowCasterFilter::DYNAMIC_CASTERS);
 
-          shader.setInt("animation.type", animation.type);
-          shader.setFloat("animation.speed", animation.speed);
-          shader.setFloat("animation.factor", animation.factor);
-          shader.setBool("hasTexture", glMesh->hasTexture());
+          glBlendEquation(GL_FUNC_ADD);
+          glDisable(GL_BLEND);
+        } else {
+          glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-          glMesh->render(ctx.primitiveMode, mesh.useLowestLevelOfDetailForShadows);
+          renderCascadeCasters(mapIndex, cascadeIndex, matCascade, ShadowCasterFilter::ALL_CASTERS);
         }
+
+        cascade.matLightViewProjection = matLightViewProjection;
+        cascade.isRendered = true;
+      }
+    }
+  }
+
+  /**
+   * Renders the meshes with objects in a given directional
+   * shadow cascade. matCascade should be the untransposed
+   * light view-projection matrix of the cascade.
+   */
+  void OpenGLRenderer::renderCascadeCasters(u32 mapIndex, u8 cascadeIndex, const Matrix4f& matCascade, ShadowCasterFilter filter) {
+    auto& shader = shaders.shadowLightView;
+
+    // @todo glMultiDrawElementsIndirect for static world geometry
+    // (will require a handful of other changes to mesh organization/data buffering)
+    for (auto* glMesh : glMeshes) {
+      auto& mesh = *glMesh->getSourceMesh();
+
+      if (
+        mesh.type == MeshType::PARTICLES ||
+        !mesh.canCastShadows ||
+        mesh.maxCascade < (cascadeIndex + 1)
+      ) {
+        continue;
+      }
+
+      if (
+        (filter == ShadowCasterFilter::STATIC_CASTERS && !Gm_IsStaticShadowCaster(shadowCasterCache, mesh)) ||
+        (filter == ShadowCasterFilter::DYNAMIC_CASTERS && Gm_IsStaticShadowCaster(shadowCasterCache, mesh))
+      ) {
+        continue;
       }
+
+      if (!Gm_GetShadowCastersInCascade(shadowCasterCache, mesh, matCascade, cascadeCasterIndices)) {
+        continue;
+      }
+
+      auto& animation = mesh.animation;
+
+      shader.setInt("animation.type", animation.type);
+      shader.setFloat("animation.speed", animation.speed);
+      shader.setFloat("animation.factor", animation.factor);
+      shader.setBool("hasTexture", glMesh->hasTexture());
+
+      u32 viewId = (LightType::DIRECTIONAL_SHADOWCASTER << 16) | (mapIndex * 4 + cascadeIndex);
+
+      glMesh->renderInstances(ctx.primitiveMode, viewId, cascadeCasterIndices, ctx.activeCamera->position, mesh.useLowestLevelOfDetailForShadows);
     }
   }
 
+
   /**
    * @todo description
    */
@@ -689,6 +769,12 @@ namespace Gamma {
         continue;
       }
 
+      bool haveCastersChanged = Gm_UpdateShadowCasterList(glShadowMap.casters, light, gmContext->scene.meshes);
+
+      if (glShadowMap.isRendered && !haveCastersChanged) {
+        continue;
+      }
+
       Matrix4f matLightProjection = Matrix4f::glPerspective({ 1024, 1024 }, 120.0f, 1.0f, light.radius);
       Matrix4f matLightView = Matrix4f::lookAt(light.position.gl(), light.direction.invert().gl(), Vec3f(0.0f, 1.0f, 0.0f));
       Matrix4f matLightViewProjection = (matLightProjection * matLightView).transpose();
@@ -701,19 +787,22 @@ namespace Gamma {
 
       // @todo glMultiDrawElementsIndirect for static world geometry
       // (will require a handful of other changes to mesh organization/data buffering)
-      // @todo allow specific meshes to be associated with spot lights + rendered to shadow maps
       for (auto* glMesh : glMeshes) {
         auto& mesh = *glMesh->getSourceMesh();
         auto& animation = mesh.animation;
 
+        if (!Gm_IsShadowCaster(glShadowMap.casters, mesh.index)) {
+          continue;
+        }
+
         shader.setInt("animation.type", animation.type);
         shader.setFloat("animation.speed", animation.speed);
         shader.setFloat("animation.factor", animation.factor);
         shader.setBool("hasTexture", glMesh->hasTexture());
 
-        if (mesh.canCastShadows) {
-          glMesh->render(ctx.primitiveMode, mesh.useLowestLevelOfDetailForShadows);
-        }
+        u32 viewId = (LightType::SPOT_SHADOWCASTER << 16) | mapIndex;
+
+        glMesh->renderInstances(ctx.primitiveMode, viewId, Gm_GetShadowCasterIndices(glShadowMap.casters, mesh.index), ctx.activeCamera->position, mesh.useLowestLevelOfDetailForShadows);
       }
 
       glShadowMap.isRendered = true;
@@ -730,12 +819,18 @@ namespace Gamma {
 
     for (u32 mapIndex = 0; mapIndex < glPointShadowMaps.size(); mapIndex++) {
       auto& glShadowMap = *glPointShadowMaps[mapIndex];
-      auto& light = *ctx.pointShadowcasters[mapIndex];
+      auto& light = *glShadowMap.light;
 
       if (light.isStatic && glShadowMap.isRendered) {
         continue;
       }
 
+      bool haveCastersChanged = Gm_UpdateShadowCasterList(glShadowMap.casters, light, gmContext->scene.meshes);
+
+      if (glShadowMap.isRendered && !haveCastersChanged) {
+        continue;
+      }
+
       glShadowMap.buffer.write();
 
       glClear(GL_DEPTH_BUFFER_BIT);
@@ -757,14 +852,15 @@ namespace Gamma {
 
       // @todo glMultiDrawElementsIndirect for static world geometry
       // (will require a handful of other changes to mesh organization/data buffering)
-      // @todo allow specific meshes to be associated with point lights + rendered to shadow maps
       for (auto* glMesh : glMeshes) {
         auto& mesh = *glMesh->getSourceMesh();
 
         // @todo handle foliage (requires point shadowcaster view shader updates)
 
-        if (mesh.canCastShadows) {
-          glMesh->render(ctx.primitiveMode, mesh.useLowestLevelOfDetailForShadows);
+        if (Gm_IsShadowCaster(glShadowMap.casters, mesh.index)) {
+          u32 viewId = (LightType::POINT_SHADOWCASTER << 16) | mapIndex;
+
+          glMesh->renderInstances(ctx.primitiveMode, viewId, Gm_GetShadowCasterIndices(glShadowMap.casters, mesh.index), ctx.activeCamera->position, mesh.useLowestLevelOfDetailForShadows);
         }
       }
 
@@ -867,10 +963,12 @@ namespace Gamma {
       shader.setInt("texShadowMaps[1]", 4);
       shader.setInt("texShadowMaps[2]", 5);
       shader.setInt("texShadowMaps[3]", 6);
-      shader.setMatrix4f("lightMatrices[0]", Gm_CreateCascadedLightViewProjectionMatrixGL(0, light.direction, camera));
-      shader.setMatrix4f("lightMatrices[1]", Gm_CreateCascadedLightViewProjectionMatrixGL(1, light.direction, camera));
-      shader.setMatrix4f("lightMatrices[2]", Gm_CreateCascadedLightViewProjectionMatrixGL(2, light.direction, camera));
-      shader.setMatrix4f("lightMatrices[3]", Gm_CreateCascadedLightViewProjectionMatrixGL(3, light.direction, camera));
+      // Cascades aren't necessarily updated every frame, so
+      // use the matrices they were last rendered with
+      shader.setMatrix4f("lightMatrices[0]", glShadowMap.cascades[0].matLightViewProjection);
+      shader.setMatrix4f("lightMatrices[1]", glShadowMap.cascades[1].matLightViewProjection);
+      shader.setMatrix4f("lightMatrices[2]", glShadowMap.cascades[2].matLightViewProjection);
+      shader.setMatrix4f("lightMatrices[3]", glShadowMap.cascades[3].matLightViewProjection);
       shader.setVec3f("cameraPosition", camera.position);
       shader.setMatrix4f("matInverseProjection", ctx.matInverseProjection);
       shader.setMatrix4f("matInverseView", ctx.matInverseView);
@@ -883,20 +981,35 @@ namespace Gamma {
   }
 
   /**
-   * @todo description
+   * Renders all non-shadowcasting point and spot lights in a
+   * single screen pass. Lights are assigned to view-space
+   * clusters on the CPU, and each pixel only evaluates the
+   * lights in its own cluster.
    */
-  void OpenGLRenderer::renderSpotLights() {
+  void OpenGLRenderer::renderClusteredLights() {
     auto& camera = *ctx.activeCamera;
-    auto& shader = shaders.spotLight;
+    auto& shader = shaders.clusteredLights;
+
+    lightClusters.update(ctx.pointLights, ctx.spotLights, ctx.matView.transpose(), ctx.matProjection.transpose());
+    lightClusters.bind();
+
+    auto& clusters = lightClusters.getClusters();
 
     shader.use();
+    shader.setVec4f("transform", FULL_SCREEN_TRANSFORM);
     shader.setInt("texColorAndDepth", 0);
     shader.setInt("texNormalAndMaterial", 1);
     shader.setVec3f("cameraPosition", camera.position);
     shader.setMatrix4f("matInverseProjection", ctx.matInverseProjection);
     shader.setMatrix4f("matInverseView", ctx.matInverseView);
+    shader.setInt("clusterTilesX", clusters.tilesX);
+    shader.setInt("clusterTilesY", clusters.tilesY);
+    shader.setInt("clusterSlices", clusters.slices);
+    shader.setFloat("zNear", clusters.bounds.near);
+    shader.setFloat("zFar", clusters.bounds.far);
+    shader.setInt("totalPointLights", lightClusters.getTotalPointLights());
 
-    lightDisc.draw(ctx.spotLights, internalResolution, *ctx.activeCamera);
+    OpenGLScreenQuad::render();
   }
 
   /**
@@ -931,11 +1044,12 @@ namespace Gamma {
   }
 
   /**
-   * @todo description
+   * Renders the glow around non-shadowcasting point lights.
+   * Their illumination is handled by renderClusteredLights().
    */
-  void OpenGLRenderer::renderPointLights() {
+  void OpenGLRenderer::renderPointLightGlow() {
     auto& camera = *ctx.activeCamera;
-    auto& shader = shaders.pointLight;
+    auto& shader = shaders.pointLightGlow;
 
     shader.use();
     shader.setInt("texColorAndDepth", 0);
@@ -1598,6 +1712,12 @@ namespace Gamma {
     // @todo test this to make sure it works!
     switch (light->type) {
       case DIRECTIONAL_SHADOWCASTER:
+        for (auto* shadowMap : glDirectionalShadowMaps) {
+          if (shadowMap->light == light) {
+            shadowMap->staticBuffer.destroy();
+          }
+        }
+
         clear_light_from(glDirectionalShadowMaps, light);
 
         break;
@@ -1636,13 +1756,15 @@ namespace Gamma {
 
     stats.gpuMemoryTotal = total / 1000;
     stats.gpuMemoryUsed = (total - available) / 1000;
-    stats.totalDrawCalls = OpenGLMesh::totalDrawCalls + OpenGLScreenQuad::totalDrawCalls + OpenGLLightDisc::totalDrawCalls;
+    stats.totalDrawCalls = OpenGLMesh::totalDrawCalls + OpenGLScreenQuad::totalDrawCalls + OpenGLLightDisc::totalDrawCalls + OpenGLText::totalDrawCalls;
     stats.isVSynced = SDL_GL_GetSwapInterval() == 1;
 
     return stats;
   }
 
   void OpenGLRenderer::present() {
+    text.flush(gmContext->window.size);
+
     SDL_GL_SwapWindow(gmContext->window.sdl_window);
   }
 
@@ -1712,6 +1834,9 @@ namespace Gamma {
     float scaleY = -1.0f * h / (float)window.size.height;
     int format = surface->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB;
 
+    // Draw any text batched so far beneath the surface
+    text.flush(window.size);
+
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, screenTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, format, surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE, surface->pixels);
@@ -1730,12 +1855,8 @@ namespace Gamma {
   }
 
   void OpenGLRenderer::renderText(TTF_Font* font, const char* message, u32 x, u32 y, const Vec3f& color, const Vec4f& background) {
-    SDL_Surface* text = TTF_RenderText_Blended_Wrapped(font, message, { 255, 255, 255 }, gmContext->window.size.width);
-
     // @todo support scaling
-    renderSurface(text, x, y, text->w, text->h, color, background);
-
-    SDL_FreeSurface(text);
+    text.write(font, message, x, y, gmContext->window.size.width, color, background);
   }
 
   void OpenGLRenderer::resetShadowMaps() {
@@ -7,13 +7,16 @@
 
 #include "math/vector.h"
 #include "opengl/framebuffer.h"
+#include "opengl/OpenGLLightClusters.h"
 #include "opengl/OpenGLLightDisc.h"
 #include "opengl/OpenGLMesh.h"
+#include "opengl/OpenGLText.h"
 #include "opengl/OpenGLTexture.h"
 #include "opengl/shader.h"
 #include "opengl/shadowmaps.h"
 #include "system/AbstractRenderer.h"
 #include "system/lights_objects_meshes.h"
+#include "system/shadow_casters.h"
 #include "system/type_aliases.h"
 
 namespace Gamma {
@@ -25,6 +28,12 @@ namespace Gamma {
     OpenGLFrameBuffer accumulation2;
   };
 
+  enum ShadowCasterFilter {
+    ALL_CASTERS,
+    STATIC_CASTERS,
+    DYNAMIC_CASTERS
+  };
+
   struct RendererShaders {
     // Rendering pipeline shaders
     OpenGLShader geometry;
@@ -34,8 +43,8 @@ namespace Gamma {
     OpenGLShader particle;
     OpenGLShader lightingPrepass;
     OpenGLShader directionalLight;
-    OpenGLShader spotLight;
-    OpenGLShader pointLight;
+    OpenGLShader clusteredLights;
+    OpenGLShader pointLightGlow;
     OpenGLShader indirectLight;
     OpenGLShader indirectLightComposite;
     OpenGLShader skybox;
@@ -112,7 +121,12 @@ namespace Gamma {
     RendererBuffers buffers;
     RendererShaders shaders;
     RendererContext ctx;
+    OpenGLLightClusters lightClusters;
+    ShadowCasterCache shadowCasterCache;
+    // Objects of the current mesh within a shadow cascade
+    std::vector<u16> cascadeCasterIndices;
     OpenGLLightDisc lightDisc;
+    OpenGLText text;
     OpenGLShader screen;
     GLuint screenTexture = 0;
     u32 frame = 0;
@@ -123,18 +137,20 @@ namespace Gamma {
     std::vector<OpenGLSpotShadowMap*> glSpotShadowMaps;
     std::map<std::string, OpenGLCubeMap*> glProbes;
     bool areProbesRendered = false;
+    bool areLightArraysShadowed = false;
  
     void renderSceneToGBuffer();
     void renderDirectionalShadowMaps();
+    void renderCascadeCasters(u32 mapIndex, u8 cascadeIndex, const Matrix4f& matCascade, ShadowCasterFilter filter);
     void renderPointShadowMaps();
     void renderSpotShadowMaps();
     void prepareLightingPass();
     void renderLightingPrepass();
     void renderDirectionalLights();
     void renderDirectionalShadowcasters();
-    void renderSpotLights();
+    void renderClusteredLights();
     void renderSpotShadowcasters();
-    void renderPointLights();
+    void renderPointLightGlow();
     void renderPointShadowcasters();
     void copyEmissiveObjects();
     void renderIndirectLight();
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+#include "glew.h"
+
+#include "opengl/OpenGLText.h"
+#include "performance/memory.h"
+#include "system/console.h"
+
+#define GLYPH_ATLAS_SIZE 1024
+
+namespace Gamma {
+  enum GLAttribute {
+    VERTEX_POSITION,
+    VERTEX_UV,
+    VERTEX_COLOR
+  };
+
+  u32 OpenGLText::totalDrawCalls = 0;
+
+  void OpenGLText::init() {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // Define vertex attributes
+    glEnableVertexAttribArray(GLAttribute::VERTEX_POSITION);
+    glVertexAttribPointer(GLAttribute::VERTEX_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, position));
+
+    glEnableVertexAttribArray(GLAttribute::VERTEX_UV);
+    glVertexAttribPointer(GLAttribute::VERTEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, uv));
+
+    glEnableVertexAttribArray(GLAttribute::VERTEX_COLOR);
+    glVertexAttribPointer(GLAttribute::VERTEX_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, color));
+
+    // Initialize the atlas texture
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    Gm_TrackAllocation(MEMORY_UI, GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE);
+
+    Gm_ResetGlyphAtlas(atlas, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE);
+
+    // Reserve a solid block for backgrounds, sampling only
+    // its center so filtering never reaches the empty edges
+    const u8 solid[9] = { 255, 255, 255, 255, 255, 255, 255, 255, 255 };
+    GlyphRegion solidBlock;
+
+    Gm_PackGlyphRegion(atlas, 3, 3, solidBlock);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, solidBlock.x, solidBlock.y, 3, 3, GL_RED, GL_UNSIGNED_BYTE, solid);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    solidRegion.x = solidBlock.x + 1;
+    solidRegion.y = solidBlock.y + 1;
+    solidRegion.w = 1;
+    solidRegion.h = 1;
+
+    shader.init();
+    shader.vertex("./gamma/opengl/shaders/text.vert.glsl");
+    shader.fragment("./gamma/opengl/shaders/text.frag.glsl");
+    shader.link();
+  }
+
+  void OpenGLText::destroy() {
+    for (auto& [ font, glyphFont ] : fonts) {
+      delete glyphFont;
+    }
+
+    fonts.clear();
+    vertices.clear();
+
+    shader.destroy();
+
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+
+    Gm_TrackFree(MEMORY_UI, GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE);
+  }
+
+  /**
+   * OpenGLText::flush
+   * -----------------
+   *
+   * Draws all text written since the last flush in a single
+   * draw call. Text should be flushed before anything else is
+   * drawn over it, and before the frame is presented.
+   */
+  void OpenGLText::flush(const Area<u32>& screenSize) {
+    if (vertices.size() == 0) {
+      return;
+    }
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(TextVertex) * vertices.size(), vertices.data(), GL_STREAM_DRAW);
+
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    shader.use();
+    shader.setInt("glyphAtlas", 0);
+    shader.setVec2f("screenSize", { (float)screenSize.width, (float)screenSize.height });
+
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+
+    totalDrawCalls++;
+
+    vertices.clear();
+  }
+
+  /**
+   * OpenGLText::write
+   * -----------------
+   *
+   * Lays out a string at a window pixel position and adds it
+   * to the current batch, loading any glyphs it needs which
+   * aren't yet in the atlas. Backgrounds are only drawn when
+   * their alpha is greater than 0.
+   */
+  void OpenGLText::write(TTF_Font* font, const char* message, u32 x, u32 y, u32 wrapWidth, const Vec3f& color, const Vec4f& background) {
+    auto& glyphFont = getGlyphFont(font);
+
+    for (const char* c = message; *c != '\0'; c++) {
+      if (*c != '\n' && !glyphFont.glyphs[(u8)*c].isLoaded) {
+        loadGlyph(glyphFont, font, (u8)*c);
+      }
+    }
+
+    Gm_LayoutText(glyphFont, message, wrapWidth, layout);
+
+    if (background.w > 0.f && layout.width > 0) {
+      addQuad((float)x, (float)y, (float)layout.width, (float)layout.height, solidRegion, background);
+    }
+
+    Vec4f glyphColor = Vec4f(color.x, color.y, color.z, 1.f);
+
+    for (auto& quad : layout.quads) {
+      addQuad((float)x + quad.x, (float)y + quad.y, quad.region.w, quad.region.h, quad.region, glyphColor);
+    }
+  }
+
+  void OpenGLText::addQuad(float x, float y, float w, float h, const GlyphRegion& region, const Vec4f& color) {
+    float u1 = region.x / (float)atlas.width;
+    float v1 = region.y / (float)atlas.height;
+    float u2 = (region.x + region.w) / (float)atlas.width;
+    float v2 = (region.y + region.h) / (float)atlas.height;
+
+    TextVertex topLeft = { Vec2f(x, y), Vec2f(u1, v1), color };
+    TextVertex topRight = { Vec2f(x + w, y), Vec2f(u2, v1), color };
+    TextVertex bottomLeft = { Vec2f(x, y + h), Vec2f(u1, v2), color };
+    TextVertex bottomRight = { Vec2f(x + w, y + h), Vec2f(u2, v2), color };
+
+    vertices.push_back(topLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomRight);
+    vertices.push_back(bottomLeft);
+  }
+
+  GlyphFont& OpenGLText::getGlyphFont(TTF_Font* font) {
+    auto* glyphFont = fonts[font];
+
+    if (glyphFont == nullptr) {
+      glyphFont = new GlyphFont();
+      glyphFont->height = (u16)TTF_FontHeight(font);
+      glyphFont->lineSkip = (u16)TTF_FontLineSkip(font);
+
+      fonts[font] = glyphFont;
+    }
+
+    return *glyphFont;
+  }
+
+  /**
+   * OpenGLText::loadGlyph
+   * ---------------------
+   *
+   * Rasterizes a glyph, crops it to its visible pixels and
+   * uploads it into the atlas. Glyphs are only ever loaded
+   * once, even if they're missing from the font or there's
+   * no room left in the atlas.
+   */
+  void OpenGLText::loadGlyph(GlyphFont& glyphFont, TTF_Font* font, u8 character) {
+    auto& glyph = glyphFont.glyphs[character];
+    int minX, maxX, minY, maxY, advance;
+
+    glyph.isLoaded = true;
+
+    if (TTF_GlyphMetrics(font, character, &minX, &maxX, &minY, &maxY, &advance) != 0) {
+      return;
+    }
+
+    glyph.advance = (s16)advance;
+
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(font, character, { 255, 255, 255, 255 });
+
+    if (surface == nullptr) {
+      return;
+    }
+
+    // Extract the glyph's coverage from its alpha channel
+    auto* format = surface->format;
+    u16 w = (u16)surface->w;
+    u16 h = (u16)surface->h;
+    std::vector<u8> coverage(w * h);
+
+    for (u16 y = 0; y < h; y++) {
+      auto* row = (u8*)surface->pixels + y * surface->pitch;
+
+      for (u16 x = 0; x < w; x++) {
+        u32 pixel = *(u32*)(row + x * format->BytesPerPixel);
+
+        coverage[y * w + x] = (u8)((pixel & format->Amask) >> format->Ashift);
+      }
+    }
+
+    SDL_FreeSurface(surface);
+
+    GlyphRegion bounds = Gm_GetGlyphCoverageBounds(coverage.data(), w, h);
+
+    // Rendered glyphs are shifted right by any negative left bearing
+    glyph.offsetX = (s16)(std::min(minX, 0) + bounds.x);
+    glyph.offsetY = (s16)bounds.y;
+
+    if (!Gm_PackGlyphRegion(atlas, bounds.w, bounds.h, glyph.region)) {
+      if (!isAtlasFull) {
+        Console::warn("[Gamma] Glyph atlas is full; some text will not be displayed");
+
+        isAtlasFull = true;
+      }
+
+      glyph.region = GlyphRegion();
+
+      return;
+    }
+
+    if (glyph.region.w == 0 || glyph.region.h == 0) {
+      return;
+    }
+
+    // Copy the cropped glyph into a contiguous block for upload
+    std::vector<u8> pixels(bounds.w * bounds.h);
+
+    for (u16 y = 0; y < bounds.h; y++) {
+      for (u16 x = 0; x < bounds.w; x++) {
+        pixels[y * bounds.w + x] = coverage[(bounds.y + y) * w + bounds.x + x];
+      }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, glyph.region.x, glyph.region.y, bounds.w, bounds.h, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
+}
\ No newline at end of file
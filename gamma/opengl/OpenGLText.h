@@ -0,0 +1,58 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "math/plane.h"
+#include "math/vector.h"
+#include "opengl/shader.h"
+#include "system/glyph_atlas.h"
+#include "system/traits.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  struct TextVertex {
+    Vec2f position;
+    Vec2f uv;
+    Vec4f color;
+  };
+
+  /**
+   * OpenGLText
+   * ----------
+   *
+   * Renders text from a shared glyph atlas texture. Each glyph
+   * is rasterized and uploaded to the atlas once, the first
+   * time it's used, and text written during a frame is batched
+   * into a single vertex buffer which is drawn on flush().
+   */
+  class OpenGLText : public Initable, public Destroyable {
+  public:
+    static u32 totalDrawCalls;
+
+    virtual void init() override;
+    virtual void destroy() override;
+    void flush(const Area<u32>& screenSize);
+    void write(TTF_Font* font, const char* message, u32 x, u32 y, u32 wrapWidth, const Vec3f& color, const Vec4f& background);
+
+  private:
+    GLuint vao;
+    GLuint vbo;
+    GLuint texture;
+    OpenGLShader shader;
+    GlyphAtlas atlas;
+    // A solid region of the atlas used for text backgrounds
+    GlyphRegion solidRegion;
+    // Glyphs are cached per font for the lifetime of the context,
+    // since fonts are opened with it and closed when it's destroyed.
+    // A font closed earlier would leave stale entries behind.
+    std::map<TTF_Font*, GlyphFont*> fonts;
+    TextLayout layout;
+    std::vector<TextVertex> vertices;
+    bool isAtlasFull = false;
+
+    void addQuad(float x, float y, float w, float h, const GlyphRegion& region, const Vec4f& color);
+    GlyphFont& getGlyphFont(TTF_Font* font);
+    void loadGlyph(GlyphFont& glyphFont, TTF_Font* font, u8 character);
+  };
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "SDL_image.h"
 
 #include "opengl/OpenGLTexture.h"
+#include "performance/memory.h"
 #include "system/assert.h"
 #include "system/flags.h"
 
@@ -21,7 +22,7 @@ namespace Gamma {
 
     #if GAMMA_DEVELOPER_MODE
       Gm_WatchFile(path, [=]() {
-        glDeleteTextures(1, &id);
+        release();
         initialize(enableMipmaps);
 
         Console::log("[Gamma] Hot-reloaded texture:", path);
@@ -30,7 +31,7 @@ namespace Gamma {
   }
 
   OpenGLTexture::~OpenGLTexture() {
-    glDeleteTextures(1, &id);
+    release();
   }
 
   void OpenGLTexture::bind() {
@@ -59,6 +60,15 @@ namespace Gamma {
 
     glTexImage2D(GL_TEXTURE_2D, 0, format, surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE, surface->pixels);
 
+    size = u64(surface->w) * u64(surface->h) * surface->format->BytesPerPixel;
+
+    if (enableMipmaps) {
+      // A full mip chain adds roughly a third to the base level
+      size += size / 3;
+    }
+
+    Gm_TrackAllocation(MEMORY_TEXTURES, size);
+
     if (enableMipmaps) {
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -74,4 +84,14 @@ namespace Gamma {
   const std::string& OpenGLTexture::getPath() const {
     return path;
   }
+
+  void OpenGLTexture::release() {
+    glDeleteTextures(1, &id);
+
+    if (size > 0) {
+      Gm_TrackFree(MEMORY_TEXTURES, size);
+
+      size = 0;
+    }
+  }
 }
\ No newline at end of file
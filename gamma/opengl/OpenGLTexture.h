@@ -17,7 +17,10 @@ namespace Gamma {
     GLuint id;
     GLenum unit;
     std::string path;
+    // Estimated size of the texture and its mipmaps, in bytes
+    u64 size = 0;
 
     void initialize(bool enableMipmaps);
+    void release();
   };
 }
\ No newline at end of file
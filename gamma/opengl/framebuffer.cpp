@@ -109,6 +109,25 @@ namespace Gamma {
     delete[] attachments;
   }
 
+  /**
+   * OpenGLFrameBuffer::copyColorAttachment
+   * --------------------------------------
+   *
+   * Copies the contents of a color attachment into a color
+   * attachment of another frame buffer with the same size
+   * and format.
+   */
+  void OpenGLFrameBuffer::copyColorAttachment(u32 attachment, const OpenGLFrameBuffer& target, u32 targetAttachment) const {
+    auto sourceTextureId = colorAttachments[attachment].textureId;
+    auto targetTextureId = target.colorAttachments[targetAttachment].textureId;
+
+    glCopyImageSubData(
+      sourceTextureId, GL_TEXTURE_2D, 0, 0, 0, 0,
+      targetTextureId, GL_TEXTURE_2D, 0, 0, 0, 0,
+      size.width, size.height, 1
+    );
+  }
+
   void OpenGLFrameBuffer::read(u32 offset) {
     for (u32 i = 0; i < colorAttachments.size(); i++) {
       glActiveTexture(GL_TEXTURE0 + colorAttachments[i].textureUnit + offset);
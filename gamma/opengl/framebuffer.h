@@ -35,6 +35,7 @@ namespace Gamma {
     void addDepthAttachment();
     void addDepthStencilAttachment();
     void bindColorAttachments();
+    void copyColorAttachment(u32 attachment, const OpenGLFrameBuffer& target, u32 targetAttachment) const;
     void read(u32 offset = 0);
     void setSize(const Area<u32>& size);
     void shareDepthStencilAttachment(const OpenGLFrameBuffer& target);
@@ -91,15 +91,15 @@ namespace Gamma {
     shaders.directionalLight.fragment("./gamma/opengl/shaders/directional-light-without-shadow.frag.glsl");
     shaders.directionalLight.link();
 
-    shaders.spotLight.init();
-    shaders.spotLight.vertex("./gamma/opengl/shaders/light-disc.vert.glsl");
-    shaders.spotLight.fragment("./gamma/opengl/shaders/spot-light-without-shadow.frag.glsl");
-    shaders.spotLight.link();
+    shaders.clusteredLights.init();
+    shaders.clusteredLights.vertex("./gamma/opengl/shaders/quad.vert.glsl");
+    shaders.clusteredLights.fragment("./gamma/opengl/shaders/clustered-lights.frag.glsl");
+    shaders.clusteredLights.link();
 
-    shaders.pointLight.init();
-    shaders.pointLight.vertex("./gamma/opengl/shaders/light-disc.vert.glsl");
-    shaders.pointLight.fragment("./gamma/opengl/shaders/point-light-without-shadow.frag.glsl");
-    shaders.pointLight.link();
+    shaders.pointLightGlow.init();
+    shaders.pointLightGlow.vertex("./gamma/opengl/shaders/light-disc.vert.glsl");
+    shaders.pointLightGlow.fragment("./gamma/opengl/shaders/point-light-glow.frag.glsl");
+    shaders.pointLightGlow.link();
 
     shaders.directionalShadowcaster.init();
     shaders.directionalShadowcaster.vertex("./gamma/opengl/shaders/quad.vert.glsl");
@@ -209,8 +209,8 @@ namespace Gamma {
     shaders.gpuParticle.destroy();
     shaders.lightingPrepass.destroy();
     shaders.directionalLight.destroy();
-    shaders.spotLight.destroy();
-    shaders.pointLight.destroy();
+    shaders.clusteredLights.destroy();
+    shaders.pointLightGlow.destroy();
     shaders.directionalShadowcaster.destroy();
     shaders.spotShadowcaster.destroy();
     shaders.pointShadowcaster.destroy();
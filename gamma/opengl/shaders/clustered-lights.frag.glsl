@@ -0,0 +1,163 @@
+#version 460 core
+
+struct Light {
+  vec3 position;
+  float radius;
+  vec3 color;
+  float power;
+  vec3 direction;
+  float fov;
+};
+
+struct ClusterRange {
+  uint offset;
+  uint count;
+};
+
+layout (std430, binding = 0) readonly buffer ClusterLights {
+  Light lights[];
+};
+
+layout (std430, binding = 1) readonly buffer ClusterRanges {
+  ClusterRange ranges[];
+};
+
+layout (std430, binding = 2) readonly buffer ClusterLightIndices {
+  uint lightIndices[];
+};
+
+uniform sampler2D texColorAndDepth;
+uniform sampler2D texNormalAndMaterial;
+uniform vec3 cameraPosition;
+uniform mat4 matInverseProjection;
+uniform mat4 matInverseView;
+uniform int clusterTilesX;
+uniform int clusterTilesY;
+uniform int clusterSlices;
+uniform float zNear;
+uniform float zFar;
+// Lights before this index are point lights,
+// and the remaining lights are spot lights
+uniform int totalPointLights;
+
+noperspective in vec2 fragUv;
+
+layout (location = 0) out vec4 out_color_and_depth;
+
+#include "utils/conversion.glsl";
+
+/**
+ * Equivalent to inline/point-light.glsl, without the light
+ * disc glow (see point-light-glow.frag.glsl).
+ */
+vec3 getPointLightRadiance(Light light, vec3 position, vec3 frag_color, vec3 frag_normal, float emissivity, float roughness) {
+  vec3 surface_to_light = light.position - position;
+  float light_distance = length(surface_to_light);
+  vec3 normalized_surface_to_light = surface_to_light / light_distance;
+  float incidence = max(dot(normalized_surface_to_light, frag_normal), 0.0);
+
+  if (incidence == 0.0 || light_distance > light.radius) {
+    return vec3(0);
+  }
+
+  vec3 normalized_surface_to_camera = normalize(cameraPosition - position);
+  vec3 half_vector = normalize(normalized_surface_to_light + normalized_surface_to_camera);
+  float attenuation = pow(1.0 / light_distance, 2);
+  float specularity = pow(max(dot(half_vector, frag_normal), 0.0), 50) * (1.0 - roughness);
+
+  float hack_diffuse_radial_influence = (1.0 - pow(clamp(light_distance / light.radius, 0.0, 1.0), 2));
+  float hack_specular_radial_influence = (1.0 - pow(clamp(light_distance / light.radius, 0.0, 1.0), 10));
+  float hack_soft_tapering = (20.0 * (light_distance / light.radius));
+
+  vec3 radiant_flux = light.color * light.power * light.radius;
+  vec3 diffuse_term = frag_color * radiant_flux * incidence * attenuation * hack_diffuse_radial_influence * hack_soft_tapering * (1.0 - specularity) * sqrt(roughness);
+  vec3 specular_term = 5.0 * radiant_flux * specularity * attenuation * hack_specular_radial_influence;
+
+  return (diffuse_term + specular_term) * (1.0 - min(1.0, emissivity));
+}
+
+/**
+ * Equivalent to inline/spot-light.glsl.
+ */
+vec3 getSpotLightRadiance(Light light, vec3 position, vec3 frag_color, vec3 frag_normal, float emissivity, float roughness) {
+  vec3 surface_to_light = light.position - position;
+  float light_distance = length(surface_to_light);
+
+  if (light_distance > light.radius) {
+    return vec3(0);
+  }
+
+  vec3 normalized_surface_to_light = surface_to_light / light_distance;
+  float fragment_alignment = dot(normalized_surface_to_light * -1, light.direction);
+  float cone_edge_alignment = 1.0 - (light.fov / 180.0);
+
+  if (fragment_alignment < cone_edge_alignment) {
+    return vec3(0);
+  }
+
+  float cone_edge_range = 1.0 - cone_edge_alignment;
+  float cone_edge_proximity = fragment_alignment - cone_edge_alignment;
+  float spot_factor = pow(cone_edge_proximity / cone_edge_range, 0.7);
+
+  vec3 normalized_surface_to_camera = normalize(cameraPosition - position);
+  vec3 half_vector = normalize(normalized_surface_to_light + normalized_surface_to_camera);
+  float incidence = max(dot(normalized_surface_to_light, frag_normal), 0.0);
+  float attenuation = pow(1.0 / light_distance, 2);
+  float specularity = pow(max(dot(half_vector, frag_normal), 0.0), 50) * (1.0 - roughness);
+
+  float hack_radial_influence = max(1.0 - light_distance / light.radius, 0.0);
+  float hack_soft_tapering = (20.0 * (light_distance / light.radius));
+
+  vec3 radiant_flux = light.color * light.power * light.radius;
+  vec3 diffuse_term = frag_color * radiant_flux * incidence * attenuation * hack_radial_influence * hack_soft_tapering * (1.0 - specularity) * sqrt(roughness);
+  vec3 specular_term = 5.0 * radiant_flux * specularity * attenuation;
+
+  return (diffuse_term + specular_term) * (1.0 - min(1.0, emissivity)) * spot_factor;
+}
+
+/**
+ * Mirrors Gm_GetLightClusterIndex() and Gm_GetLightClusterSlice().
+ */
+uint getClusterIndex(vec2 uv, float depth) {
+  float linear_depth = getLinearizedDepth(depth, zNear, zFar);
+  float slice = log(max(linear_depth, zNear) / zNear) / log(zFar / zNear) * float(clusterSlices);
+
+  int tile_x = clamp(int(uv.x * float(clusterTilesX)), 0, clusterTilesX - 1);
+  int tile_y = clamp(int(uv.y * float(clusterTilesY)), 0, clusterTilesY - 1);
+  int tile_z = clamp(int(slice), 0, clusterSlices - 1);
+
+  return uint((tile_z * clusterTilesY + tile_y) * clusterTilesX + tile_x);
+}
+
+void main() {
+  vec4 frag_color_and_depth = texture(texColorAndDepth, fragUv);
+  vec4 frag_normal_and_material = texture(texNormalAndMaterial, fragUv);
+  vec3 position = getWorldPosition(frag_color_and_depth.w, fragUv, matInverseProjection, matInverseView);
+  vec3 frag_color = frag_color_and_depth.rgb;
+  vec3 frag_normal = frag_normal_and_material.xyz;
+
+  // @todo refactor
+  float material = frag_normal_and_material.w;
+  float emissivity = floor(material) / 10.0;
+  float roughness = fract(material);
+
+  ClusterRange range = ranges[getClusterIndex(fragUv, frag_color_and_depth.w)];
+  vec3 illuminated_color = vec3(0);
+
+  if (range.count == 0) {
+    discard;
+  }
+
+  for (uint i = range.offset; i < range.offset + range.count; i++) {
+    uint index = lightIndices[i];
+    Light light = lights[index];
+
+    if (index < uint(totalPointLights)) {
+      illuminated_color += getPointLightRadiance(light, position, frag_color, frag_normal, emissivity, roughness);
+    } else {
+      illuminated_color += getSpotLightRadiance(light, position, frag_color, frag_normal, emissivity, roughness);
+    }
+  }
+
+  out_color_and_depth = vec4(illuminated_color, frag_color_and_depth.w);
+}
\ No newline at end of file
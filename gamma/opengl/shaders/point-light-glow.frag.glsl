@@ -24,6 +24,10 @@ layout (location = 0) out vec4 out_colorAndDepth;
 
 #include "utils/conversion.glsl";
 
+/**
+ * Renders the glow around point lights, whose illumination
+ * is otherwise handled by the clustered lighting pass.
+ */
 void main() {
   #include "inline/point-light.glsl";
 
@@ -39,5 +43,5 @@ void main() {
     glow_factor *= pow(light_distance_from_camera / (light.radius * 3.0), 3);
   }
 
-  out_colorAndDepth = vec4(illuminated_color + light.color * glow_factor, frag_color_and_depth.w);
+  out_colorAndDepth = vec4(light.color * glow_factor, frag_color_and_depth.w);
 }
\ No newline at end of file
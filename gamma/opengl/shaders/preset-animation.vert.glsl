@@ -7,7 +7,6 @@ layout (location = 1) in vec3 vertexNormal;
 layout (location = 2) in vec3 vertexTangent;
 layout (location = 3) in vec2 vertexUv;
 layout (location = 4) in uint modelColor;
-layout (location = 5) in mat4 modelMatrix;
 
 flat out vec3 fragColor;
 out vec3 fragPosition;
@@ -17,6 +16,7 @@ out vec3 fragBitangent;
 out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instance-transform.glsl";
 #include "utils/preset-animation.glsl";
 
 /**
@@ -46,8 +46,7 @@ vec3 unpack(uint color) {
 
 void main() {
   // @hack invert Z
-  vec4 world_position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
-  mat3 normal_matrix = transpose(inverse(mat3(modelMatrix)));
+  vec4 world_position = glVec4(getInstanceWorldPosition(vertexPosition));
 
   // @todo make a utility for this
   switch (animation.type) {
@@ -73,8 +72,8 @@ void main() {
   fragColor = unpack(modelColor);
   // @hack invert Z
   fragPosition = glVec3(world_position.xyz);
-  fragNormal = normal_matrix * vertexNormal;
-  fragTangent = normal_matrix * vertexTangent;
+  fragNormal = getInstanceWorldNormal(vertexNormal);
+  fragTangent = getInstanceWorldNormal(vertexTangent);
   fragBitangent = getFragBitangent(fragNormal, fragTangent);
   fragUv = vertexUv;
 }
\ No newline at end of file
@@ -7,16 +7,16 @@ layout (location = 1) in vec3 vertexNormal;
 layout (location = 2) in vec3 vertexTangent;
 layout (location = 3) in vec2 vertexUv;
 layout (location = 4) in uint modelColor;
-layout (location = 5) in mat4 modelMatrix;
 
 out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instance-transform.glsl";
 #include "utils/preset-animation.glsl";
 
 void main() {
   // @hack invert Z
-  vec4 world_position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
+  vec4 world_position = glVec4(getInstanceWorldPosition(vertexPosition));
 
   // @todo make a utility for this
   switch (animation.type) {
@@ -0,0 +1,20 @@
+#version 460 core
+
+uniform sampler2D glyphAtlas;
+
+noperspective in vec2 fragUv;
+flat in vec4 fragColor;
+
+layout (location = 0) out vec4 out_color;
+
+/**
+ * A shader for rendering batched text quads. The glyph atlas
+ * only stores coverage, which is used as the alpha of each
+ * quad's color. Background quads sample a solid region of the
+ * atlas, and are drawn beneath the glyphs they belong to.
+ */
+void main() {
+  float coverage = texture(glyphAtlas, fragUv).r;
+
+  out_color = vec4(fragColor.rgb, fragColor.a * coverage);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 460 core
+
+uniform vec2 screenSize;
+
+layout (location = 0) in vec2 vertexPosition;
+layout (location = 1) in vec2 vertexUv;
+layout (location = 2) in vec4 vertexColor;
+
+noperspective out vec2 fragUv;
+flat out vec4 fragColor;
+
+/**
+ * Converts window pixel coordinates, with the origin at the
+ * top-left corner, into normalized device coordinates.
+ */
+void main() {
+  vec2 position = vertexPosition / screenSize * 2.0 - 1.0;
+
+  gl_Position = vec4(position.x, -position.y, 0.0, 1.0);
+  fragUv = vertexUv;
+  fragColor = vertexColor;
+}
\ No newline at end of file
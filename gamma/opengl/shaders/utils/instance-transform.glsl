@@ -0,0 +1,54 @@
+#define FULL_MATRIX 0u
+
+/**
+ * Instance transforms are either full model matrices or compact
+ * position/rotation/scale transforms, depending on the mesh's
+ * instance format. instanceFormat is constant for each draw call.
+ */
+layout (location = 5) in mat4 modelMatrix;
+layout (location = 9) in vec3 instancePosition;
+layout (location = 10) in vec4 instanceRotation;
+layout (location = 11) in vec3 instanceScale;
+layout (location = 12) in uint instanceFormat;
+
+vec3 rotateByQuaternion(vec3 vector, vec4 q) {
+  return vector + 2.0 * cross(q.xyz, cross(q.xyz, vector) + q.w * vector);
+}
+
+/**
+ * Transforms a vertex position into world space (not
+ * yet inverted along Z).
+ */
+vec3 getInstanceWorldPosition(vec3 vertex_position) {
+  if (instanceFormat == FULL_MATRIX) {
+    return (modelMatrix * vec4(vertex_position, 1.0)).xyz;
+  }
+
+  return instancePosition + rotateByQuaternion(vertex_position * instanceScale, instanceRotation);
+}
+
+/**
+ * Transforms a normal or tangent vector into world space.
+ * Compact transforms avoid inverting the model matrix, since
+ * the inverse transpose of rotation * scale is just rotation
+ * * (1 / scale).
+ */
+vec3 getInstanceWorldNormal(vec3 normal) {
+  if (instanceFormat == FULL_MATRIX) {
+    return transpose(inverse(mat3(modelMatrix))) * normal;
+  }
+
+  return rotateByQuaternion(normal / instanceScale, instanceRotation);
+}
+
+/**
+ * Returns the scaled y axis of the instance in world space,
+ * i.e. the second column of its model matrix.
+ */
+vec3 getInstanceUpAxis() {
+  if (instanceFormat == FULL_MATRIX) {
+    return modelMatrix[1].xyz;
+  }
+
+  return rotateByQuaternion(vec3(0, instanceScale.y, 0), instanceRotation);
+}
\ No newline at end of file
@@ -33,6 +33,15 @@ namespace Gamma {
     buffer.addDepthAttachment();
     buffer.bindColorAttachments();
 
+    staticBuffer.init();
+    staticBuffer.setSize({ 2048, 2048 });
+    staticBuffer.addColorAttachment(ColorFormat::R);
+    staticBuffer.addColorAttachment(ColorFormat::R);
+    staticBuffer.addColorAttachment(ColorFormat::R);
+    staticBuffer.addColorAttachment(ColorFormat::R);
+    staticBuffer.addDepthAttachment();
+    staticBuffer.bindColorAttachments();
+
     #if GAMMA_DEVELOPER_MODE
       Console::log("[Gamma] OpenGLDirectionalShadowMap created");
     #endif
@@ -153,4 +162,25 @@ namespace Gamma {
 
     return (matProjection * matView).transpose();
   }
+
+  /**
+   * Gm_ShouldUpdateShadowCascade
+   * ----------------------------
+   *
+   * Determines whether a directional shadow cascade should be
+   * re-rendered on a given frame. The far cascades cover large
+   * areas at low resolution, where changes are hard to notice,
+   * so they're only updated every second and fourth frame,
+   * on frames which don't coincide.
+   */
+  bool Gm_ShouldUpdateShadowCascade(u8 cascade, u32 frame) {
+    switch (cascade) {
+      case 2:
+        return frame % 2 == 0;
+      case 3:
+        return frame % 4 == 1;
+      default:
+        return true;
+    }
+  }
 }
\ No newline at end of file
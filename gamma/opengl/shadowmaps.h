@@ -6,15 +6,43 @@
 #include "opengl/shader.h"
 #include "system/camera.h"
 #include "system/lights_objects_meshes.h"
+#include "system/shadow_casters.h"
 
 namespace Gamma {
   struct OpenGLBaseShadowMap {
     const Light* light = nullptr;
     bool isRendered = false;
+    ShadowCasterList casters;
+  };
+
+  /**
+   * OpenGLShadowCascade
+   * -------------------
+   *
+   * The state of a single directional shadow map cascade. The
+   * cascade's last rendered matrix is retained so the cascade
+   * can be sampled correctly on frames where it isn't updated.
+   */
+  struct OpenGLShadowCascade {
+    // Transposed light view-projection matrix the cascade was last rendered with
+    Matrix4f matLightViewProjection;
+    // Transposed light view-projection matrix the static caster layer was rendered with
+    Matrix4f matStaticLightViewProjection;
+    u32 staticGeneration = 0;
+    bool hasStaticLayer = false;
+    bool isRendered = false;
   };
 
   struct OpenGLDirectionalShadowMap : public OpenGLBaseShadowMap {
     OpenGLFrameBuffer buffer;
+    /**
+     * Static casters for each cascade, which are copied into
+     * 'buffer' before dynamic casters are rendered over them,
+     * for as long as the cascade and its static casters are
+     * unchanged.
+     */
+    OpenGLFrameBuffer staticBuffer;
+    OpenGLShadowCascade cascades[4];
 
     OpenGLDirectionalShadowMap(const Light* light);
   };
@@ -32,4 +60,5 @@ namespace Gamma {
   };
 
   Matrix4f Gm_CreateCascadedLightViewProjectionMatrixGL(u8 cascade, const Vec3f& lightDirection, const Camera& camera);
+  bool Gm_ShouldUpdateShadowCascade(u8 cascade, u32 frame);
 }
\ No newline at end of file
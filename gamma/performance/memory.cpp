@@ -0,0 +1,151 @@
+#include <atomic>
+#include <cstdio>
+
+#include "performance/benchmark.h"
+#include "performance/memory.h"
+#include "system/console.h"
+
+namespace Gamma {
+  struct MemoryCounters {
+    std::atomic<u64> live = 0;
+    std::atomic<u64> peak = 0;
+    std::atomic<u64> totalAllocated = 0;
+    std::atomic<u64> totalFreed = 0;
+    std::atomic<u32> liveAllocations = 0;
+  };
+
+  const static char* CATEGORY_NAMES[] = {
+    "Meshes",
+    "Pools",
+    "Textures",
+    "Collision",
+    "Animation",
+    "Procedural",
+    "Editor",
+    "UI"
+  };
+
+  static MemoryCounters counters[MEMORY_TOTAL_CATEGORIES];
+  static MemoryStats stats[MEMORY_TOTAL_CATEGORIES];
+  static u64 lastTotalsAllocated[MEMORY_TOTAL_CATEGORIES] = { 0 };
+  static u64 lastRateUpdateTime = 0;
+
+  static inline float toMegabytes(u64 bytes) {
+    return float(bytes) / 1000000.f;
+  }
+
+  /**
+   * Gm_DumpMemoryStats
+   * ------------------
+   *
+   * Logs the live, peak and cumulative memory usage of each
+   * category to the console.
+   */
+  void Gm_DumpMemoryStats() {
+    Gm_UpdateMemoryStats();
+
+    char line[200];
+
+    Console::log("[Gamma] Tracked memory:", toMegabytes(Gm_GetTotalTrackedMemory()), "MB");
+
+    for (u32 i = 0; i < MEMORY_TOTAL_CATEGORIES; i++) {
+      auto& category = stats[i];
+
+      std::snprintf(
+        line, sizeof(line),
+        "[Gamma] %s: %.2fMB live in %u allocations, %.2fMB peak, %.2fMB allocated, %.2fMB freed, %.2fMB/s",
+        category.name,
+        toMegabytes(category.live),
+        category.liveAllocations,
+        toMegabytes(category.peak),
+        toMegabytes(category.totalAllocated),
+        toMegabytes(category.totalFreed),
+        category.allocationRate / 1000000.f
+      );
+
+      Console::log(line);
+    }
+  }
+
+  const MemoryStats& Gm_GetMemoryStats(MemoryCategory category) {
+    return stats[category];
+  }
+
+  u64 Gm_GetTotalTrackedMemory() {
+    u64 total = 0;
+
+    for (auto& category : counters) {
+      total += category.live.load(std::memory_order_relaxed);
+    }
+
+    return total;
+  }
+
+  /**
+   * Gm_TrackAllocation
+   * ------------------
+   *
+   * Counts an allocation towards a memory category. Safe to
+   * call from multiple threads.
+   */
+  void Gm_TrackAllocation(MemoryCategory category, u64 bytes) {
+    auto& counter = counters[category];
+    u64 live = counter.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    u64 peak = counter.peak.load(std::memory_order_relaxed);
+
+    while (live > peak && !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+    counter.totalAllocated.fetch_add(bytes, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Gm_TrackFree(MemoryCategory category, u64 bytes) {
+    auto& counter = counters[category];
+
+    counter.live.fetch_sub(bytes, std::memory_order_relaxed);
+    counter.totalFreed.fetch_add(bytes, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Gm_UpdateMemoryStats
+   * --------------------
+   *
+   * Copies the current memory counters into each category's
+   * stats, and recalculates allocation rates once a second.
+   */
+  void Gm_UpdateMemoryStats() {
+    u64 time = Gm_GetMicroseconds();
+
+    if (lastRateUpdateTime == 0) {
+      lastRateUpdateTime = time;
+    }
+
+    u64 elapsed = time - lastRateUpdateTime;
+    bool shouldUpdateRates = elapsed >= 1000000;
+
+    for (u32 i = 0; i < MEMORY_TOTAL_CATEGORIES; i++) {
+      auto& counter = counters[i];
+      auto& category = stats[i];
+
+      category.name = CATEGORY_NAMES[i];
+      category.live = counter.live.load(std::memory_order_relaxed);
+      category.peak = counter.peak.load(std::memory_order_relaxed);
+      category.totalAllocated = counter.totalAllocated.load(std::memory_order_relaxed);
+      category.totalFreed = counter.totalFreed.load(std::memory_order_relaxed);
+      category.liveAllocations = counter.liveAllocations.load(std::memory_order_relaxed);
+
+      if (shouldUpdateRates) {
+        u64 allocated = category.totalAllocated - lastTotalsAllocated[i];
+
+        category.allocationRate = float(allocated) * 1000000.f / float(elapsed);
+
+        lastTotalsAllocated[i] = category.totalAllocated;
+      }
+    }
+
+    if (shouldUpdateRates) {
+      lastRateUpdateTime = time;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  enum MemoryCategory {
+    MEMORY_MESHES,
+    MEMORY_POOLS,
+    MEMORY_TEXTURES,
+    MEMORY_COLLISION,
+    MEMORY_ANIMATION,
+    MEMORY_PROCEDURAL,
+    MEMORY_EDITOR,
+    MEMORY_UI,
+    MEMORY_TOTAL_CATEGORIES
+  };
+
+  /**
+   * MemoryStats
+   * -----------
+   */
+  struct MemoryStats {
+    const char* name = nullptr;
+    // Bytes currently allocated
+    u64 live = 0;
+    // The most bytes allocated at any one time
+    u64 peak = 0;
+    u64 totalAllocated = 0;
+    u64 totalFreed = 0;
+    u32 liveAllocations = 0;
+    // Bytes allocated per second, measured over the last second
+    float allocationRate = 0.f;
+  };
+
+  void Gm_DumpMemoryStats();
+  const MemoryStats& Gm_GetMemoryStats(MemoryCategory category);
+  u64 Gm_GetTotalTrackedMemory();
+  void Gm_TrackAllocation(MemoryCategory category, u64 bytes);
+  void Gm_TrackFree(MemoryCategory category, u64 bytes);
+  void Gm_UpdateMemoryStats();
+
+  /**
+   * TrackedAllocator
+   * ----------------
+   *
+   * A standard allocator which counts the memory owned by a
+   * container towards a given memory category.
+   */
+  template<typename T, MemoryCategory C>
+  struct TrackedAllocator {
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+      typedef TrackedAllocator<U, C> other;
+    };
+
+    TrackedAllocator() = default;
+
+    template<typename U>
+    TrackedAllocator(const TrackedAllocator<U, C>&) {}
+
+    T* allocate(size_t n) {
+      Gm_TrackAllocation(C, n * sizeof(T));
+
+      return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* pointer, size_t n) {
+      Gm_TrackFree(C, n * sizeof(T));
+
+      std::allocator<T>().deallocate(pointer, n);
+    }
+
+    template<typename U>
+    bool operator==(const TrackedAllocator<U, C>&) const {
+      return true;
+    }
+
+    template<typename U>
+    bool operator!=(const TrackedAllocator<U, C>&) const {
+      return false;
+    }
+  };
+
+  template<typename T, MemoryCategory C>
+  using TrackedVector = std::vector<T, TrackedAllocator<T, C>>;
+}
\ No newline at end of file
@@ -95,7 +95,7 @@ namespace Gamma {
       }
     }
 
-    signal("command", command);
+    signal(commandEvent, command);
 
     resetCurrentCommand();
   }
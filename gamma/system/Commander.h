@@ -21,6 +21,7 @@ namespace Gamma {
   private:
     bool isEnteringCommand = false;
     std::string currentCommand = "";
+    u32 commandEvent = registerEvent<std::string>("command");
 
     bool currentCommandIncludes(std::string match);
     void processCurrentCommand();
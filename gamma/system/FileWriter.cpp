@@ -0,0 +1,140 @@
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+#include "system/FileWriter.h"
+
+namespace Gamma {
+  FileWriter::FileWriter(const std::string& path) {
+    this->path = path;
+
+    temporaryPath = path + ".tmp";
+
+    // Ensure the directory exists
+    auto directory = std::filesystem::path(path).parent_path();
+
+    if (!directory.empty()) {
+      std::filesystem::create_directories(directory);
+    }
+
+    file.open(temporaryPath, std::ios::binary | std::ios::trunc);
+
+    isOpen = file.is_open();
+  }
+
+  FileWriter::~FileWriter() {
+    close();
+  }
+
+  /**
+   * FileWriter::close
+   * -----------------
+   *
+   * Flushes any buffered output and moves the temporary file
+   * into place. Returns false if the file could not be written.
+   */
+  bool FileWriter::close() {
+    if (!isOpen) {
+      return false;
+    }
+
+    isOpen = false;
+
+    flush();
+    file.close();
+
+    if (file.fail()) {
+      std::filesystem::remove(temporaryPath);
+
+      return false;
+    }
+
+    std::error_code error;
+
+    std::filesystem::rename(temporaryPath, path, error);
+
+    return !error;
+  }
+
+  void FileWriter::flush() {
+    if (size > 0) {
+      file.write(buffer, size);
+
+      size = 0;
+    }
+  }
+
+  void FileWriter::reserve(u32 bytes) {
+    if (size + bytes > BUFFER_SIZE) {
+      flush();
+    }
+  }
+
+  FileWriter& FileWriter::write(char c) {
+    reserve(1);
+
+    buffer[size++] = c;
+
+    return *this;
+  }
+
+  FileWriter& FileWriter::write(const std::string& string) {
+    return write(string.data(), (u32)string.size());
+  }
+
+  /**
+   * Writes raw bytes, e.g. for binary data files.
+   */
+  FileWriter& FileWriter::write(const void* data, u32 bytes) {
+    if (bytes > BUFFER_SIZE) {
+      flush();
+
+      file.write((const char*)data, bytes);
+    } else {
+      reserve(bytes);
+
+      memcpy(buffer + size, data, bytes);
+
+      size += bytes;
+    }
+
+    return *this;
+  }
+
+  /**
+   * Writes floats with 6 decimal places, matching the
+   * output of std::to_string().
+   */
+  FileWriter& FileWriter::write(float f) {
+    // Large enough for any float in fixed notation
+    reserve(64);
+
+    auto result = std::to_chars(buffer + size, buffer + BUFFER_SIZE, f, std::chars_format::fixed, 6);
+
+    size = u32(result.ptr - buffer);
+
+    return *this;
+  }
+
+  FileWriter& FileWriter::write(u32 u) {
+    reserve(16);
+
+    auto result = std::to_chars(buffer + size, buffer + BUFFER_SIZE, u);
+
+    size = u32(result.ptr - buffer);
+
+    return *this;
+  }
+
+  FileWriter& FileWriter::write(const Vec3f& v) {
+    return write(v.x).write(',').write(v.y).write(',').write(v.z);
+  }
+
+  FileWriter& FileWriter::write(const Quaternion& q) {
+    return write(q.w).write(',').write(q.x).write(',').write(q.y).write(',').write(q.z);
+  }
+
+  FileWriter& FileWriter::write(const pVec4& p) {
+    return write((u32)p.r).write(',').write((u32)p.g).write(',').write((u32)p.b).write(',').write((u32)p.a);
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include "math/vector.h"
+#include "math/Quaternion.h"
+#include "system/packed_data.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * FileWriter
+   * ----------
+   *
+   * A buffered file writer which formats numbers in place
+   * with std::to_chars, avoiding intermediate strings. Output
+   * is written to a temporary file which replaces the target
+   * file on close(), so the target file is never left in a
+   * partially-written state.
+   */
+  class FileWriter {
+  public:
+    FileWriter(const std::string& path);
+    ~FileWriter();
+
+    bool close();
+    FileWriter& write(char c);
+    FileWriter& write(const std::string& string);
+    FileWriter& write(const void* data, u32 bytes);
+    FileWriter& write(float f);
+    FileWriter& write(u32 u);
+    FileWriter& write(const Vec3f& v);
+    FileWriter& write(const Quaternion& q);
+    FileWriter& write(const pVec4& p);
+
+  private:
+    constexpr static u32 BUFFER_SIZE = 64 * 1024;
+
+    std::string path;
+    std::string temporaryPath;
+    std::ofstream file;
+    char buffer[BUFFER_SIZE];
+    u32 size = 0;
+    bool isOpen = false;
+
+    void flush();
+    void reserve(u32 bytes);
+  };
+}
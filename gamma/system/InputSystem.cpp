@@ -182,7 +182,7 @@ namespace Gamma {
       Key key = controllerButtonMap.at(button);
 
       if (!isKeyHeld(key)) {
-        signal("keystart", key);
+        signal(keyStartEvent, key);
 
         pressedKeyState |= (u64)key;
       }
@@ -190,7 +190,7 @@ namespace Gamma {
       heldKeyState |= (u64)key;
       lastKeyDown = (u64)key;
 
-      signal("keydown", key);
+      signal(keyDownEvent, key);
     }
   }
 
@@ -202,7 +202,7 @@ namespace Gamma {
       pressedKeyState &= ~(u64)key;
       releasedKeyState |= (u64)key;
 
-      signal("keyup", key);
+      signal(keyUpEvent, key);
     }
   }
 
@@ -212,7 +212,7 @@ namespace Gamma {
       Key key = keyMap.at(code);
 
       if (!isKeyHeld(key)) {
-        signal("keystart", key);
+        signal(keyStartEvent, key);
 
         pressedKeyState |= (u64)key;
       }
@@ -220,7 +220,7 @@ namespace Gamma {
       heldKeyState |= (u64)key;
       lastKeyDown = (u64)key;
 
-      signal("keydown", key);
+      signal(keyDownEvent, key);
     }
   }
 
@@ -232,7 +232,7 @@ namespace Gamma {
       pressedKeyState &= ~(u64)key;
       releasedKeyState |= (u64)key;
 
-      signal("keyup", key);
+      signal(keyUpEvent, key);
     }
   }
 
@@ -242,7 +242,7 @@ namespace Gamma {
     buttonEvent.position.x = event.x;
     buttonEvent.position.y = event.y;
 
-    signal("mousedown", buttonEvent);
+    signal(mouseDownEvent, buttonEvent);
 
     didClickMouseThisFrame = true;
     didRightClickThisFrame = event.button == SDL_BUTTON_RIGHT;
@@ -255,7 +255,7 @@ namespace Gamma {
     buttonEvent.position.x = event.x;
     buttonEvent.position.y = event.y;
 
-    signal("mouseup", buttonEvent);
+    signal(mouseUpEvent, buttonEvent);
 
     didReleaseMouseThisFrame = true;
     isMouseButtonHeldDown = false;
@@ -267,7 +267,7 @@ namespace Gamma {
     moveEvent.deltaX = event.xrel;
     moveEvent.deltaY = event.yrel;
 
-    signal("mousemove", moveEvent);
+    signal(mouseMoveEvent, moveEvent);
 
     mouseDelta.x = event.xrel;
     mouseDelta.y = event.yrel;
@@ -280,14 +280,14 @@ namespace Gamma {
       ? MouseWheelEvent::DOWN
       : MouseWheelEvent::UP;
 
-    signal("mousewheel", wheelEvent);
+    signal(mouseWheelEvent, wheelEvent);
 
     didMoveMouseWheelThisFrame = true;
     mousewheelDirection = wheelEvent.direction;
   }
 
   void InputSystem::handleTextInput(char character) {
-    signal("input", character);
+    signal(inputEvent, character);
   }
 
   bool InputSystem::isKeyHeld(Key key) const {
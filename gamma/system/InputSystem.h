@@ -119,6 +119,14 @@ namespace Gamma {
     bool isMouseButtonHeldDown = false;
     Point<int> mouseDelta = { 0, 0 };
     MouseWheelEvent::Direction mousewheelDirection;
+    u32 keyStartEvent = registerEvent<Key>("keystart");
+    u32 keyDownEvent = registerEvent<Key>("keydown");
+    u32 keyUpEvent = registerEvent<Key>("keyup");
+    u32 mouseDownEvent = registerEvent<MouseButtonEvent>("mousedown");
+    u32 mouseUpEvent = registerEvent<MouseButtonEvent>("mouseup");
+    u32 mouseMoveEvent = registerEvent<MouseMoveEvent>("mousemove");
+    u32 mouseWheelEvent = registerEvent<MouseWheelEvent>("mousewheel");
+    u32 inputEvent = registerEvent<char>("input");
 
     void handleControllerButtonDown(Uint8 button);
     void handleControllerButtonUp(Uint8 button);
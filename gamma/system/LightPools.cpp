@@ -0,0 +1,150 @@
+#include "system/assert.h"
+#include "system/LightPools.h"
+
+#define LIGHT_CHUNK_SIZE 64
+
+namespace Gamma {
+  /**
+   * LightSlot
+   * ---------
+   *
+   * Storage for a single Light, along with its position in
+   * the light arrays. The Light must remain the first member
+   * so that a Light pointer can be converted back to its slot.
+   */
+  struct LightSlot {
+    Light light;
+    LightType type = LightType::POINT;
+    u32 lightIndex = 0;
+    u32 poolIndex = 0;
+  };
+
+  static inline LightSlot* getSlot(Light* light) {
+    return reinterpret_cast<LightSlot*>(light);
+  }
+
+  /**
+   * LightPools
+   * ----------
+   */
+  Light* LightPools::operator[](u32 index) const {
+    return lights[index];
+  }
+
+  std::vector<Light*>::const_iterator LightPools::begin() const {
+    return lights.begin();
+  }
+
+  Light& LightPools::createLight(LightType type) {
+    if (freeSlots.size() == 0) {
+      auto* chunk = new LightSlot[LIGHT_CHUNK_SIZE];
+
+      chunks.push_back(chunk);
+
+      // Push slots in reverse so they're used in order
+      for (u32 i = LIGHT_CHUNK_SIZE; i > 0; i--) {
+        freeSlots.push_back(&chunk[i - 1]);
+      }
+    }
+
+    auto* slot = freeSlots.back();
+
+    freeSlots.pop_back();
+
+    slot->light = Light();
+    slot->light.type = type;
+    slot->lightIndex = (u32)lights.size();
+
+    lights.push_back(&slot->light);
+
+    addToPool(slot, type);
+
+    changed = true;
+
+    return slot->light;
+  }
+
+  std::vector<Light*>::const_iterator LightPools::end() const {
+    return lights.end();
+  }
+
+  void LightPools::free() {
+    for (auto* chunk : chunks) {
+      delete[] chunk;
+    }
+
+    for (auto& pool : pools) {
+      pool.clear();
+    }
+
+    lights.clear();
+    chunks.clear();
+    freeSlots.clear();
+
+    changed = true;
+  }
+
+  const std::vector<Light*>& LightPools::getLightsByType(LightType type) const {
+    return pools[type];
+  }
+
+  /**
+   * LightPools::removeLight
+   * -----------------------
+   *
+   * Removes a light by swapping the last light into its
+   * place, and returns its slot for reuse. Any iteration
+   * over the light pools must account for this reordering.
+   */
+  void LightPools::removeLight(Light* light) {
+    auto* slot = getSlot(light);
+    auto* lastLight = lights.back();
+
+    assert(lights[slot->lightIndex] == light, "Attempted to remove a light not in the light pools");
+
+    lights[slot->lightIndex] = lastLight;
+    getSlot(lastLight)->lightIndex = slot->lightIndex;
+    lights.pop_back();
+
+    removeFromPool(slot);
+
+    freeSlots.push_back(slot);
+
+    changed = true;
+  }
+
+  void LightPools::setType(Light* light, LightType type) {
+    auto* slot = getSlot(light);
+
+    light->type = type;
+
+    if (slot->type != type) {
+      removeFromPool(slot);
+      addToPool(slot, type);
+
+      changed = true;
+    }
+  }
+
+  u32 LightPools::size() const {
+    return (u32)lights.size();
+  }
+
+  void LightPools::addToPool(LightSlot* slot, LightType type) {
+    auto& pool = pools[type];
+
+    slot->type = type;
+    slot->poolIndex = (u32)pool.size();
+
+    pool.push_back(&slot->light);
+  }
+
+  void LightPools::removeFromPool(LightSlot* slot) {
+    auto& pool = pools[slot->type];
+    auto* lastLight = pool.back();
+
+    pool[slot->poolIndex] = lastLight;
+    getSlot(lastLight)->poolIndex = slot->poolIndex;
+    pool.pop_back();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "system/lights_objects_meshes.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  struct LightSlot;
+
+  /**
+   * LightPools
+   * ----------
+   *
+   * A collection of Lights, stored in fixed-size chunks so
+   * that Light pointers remain stable as lights are added
+   * and removed, and grouped into dense per-type pools so
+   * lights of a given type can be retrieved without
+   * scanning every light in the scene.
+   *
+   * A light's type should only be changed via setType(),
+   * which moves it into the appropriate pool.
+   */
+  class LightPools {
+  public:
+    /**
+     * Determines whether any lights were added, removed or
+     * changed type, and if categorized light arrays need to
+     * be rebuilt.
+     */
+    bool changed = false;
+
+    Light* operator[](u32 index) const;
+
+    std::vector<Light*>::const_iterator begin() const;
+    Light& createLight(LightType type);
+    std::vector<Light*>::const_iterator end() const;
+    void free();
+    const std::vector<Light*>& getLightsByType(LightType type) const;
+    void removeLight(Light* light);
+    void setType(Light* light, LightType type);
+    u32 size() const;
+
+  private:
+    // All active lights, in no particular order
+    std::vector<Light*> lights;
+    // Active lights by type, indexed by LightType
+    std::vector<Light*> pools[6];
+    std::vector<LightSlot*> chunks;
+    std::vector<LightSlot*> freeSlots;
+
+    void addToPool(LightSlot* slot, LightType type);
+    void removeFromPool(LightSlot* slot);
+  };
+}
\ No newline at end of file
@@ -1,11 +1,41 @@
+#include <algorithm>
+#include <new>
+
+#include "performance/memory.h"
 #include "system/assert.h"
-#include "system/camera.h"
 #include "system/lights_objects_meshes.h"
 #include "system/ObjectPool.h"
+#include "system/virtual_memory.h"
 
 #define UNUSED_OBJECT_INDEX 0xffff
+#define TOTAL_OBJECT_IDS 0x10000
+#define OBJECT_COMMIT_SIZE 256
+#define OBJECT_ID_COMMIT_SIZE 2048
 
 namespace Gamma {
+  static inline u64 getPoolSizeInBytes(u32 size) {
+    return size * (sizeof(Object) + sizeof(Matrix4f) + sizeof(pVec4));
+  }
+
+  static inline u64 alignToPageSize(u64 bytes) {
+    const static u64 pageSize = Gm_GetPageSize();
+
+    return (bytes + pageSize - 1) / pageSize * pageSize;
+  }
+
+  /**
+   * Commits the pages spanning elements [start, end) of an
+   * array in reserved address space.
+   */
+  static void commitArrayRange(void* array, u64 elementSize, u32 start, u32 end) {
+    const static u64 pageSize = Gm_GetPageSize();
+
+    u64 from = (start * elementSize) / pageSize * pageSize;
+    u64 to = alignToPageSize(end * elementSize);
+
+    Gm_CommitMemory((u8*)array + from, to - from);
+  }
+
   /**
    * ObjectPool
    * ----------
@@ -19,11 +49,27 @@ namespace Gamma {
   }
 
   Object& ObjectPool::createObject() {
-    u16 id = runningId++;
-
     assert(max() > totalActive(), "Object Pool out of space: " + std::to_string(max()) + " objects allowed in this pool");
-    // @todo cycle through indices until an unoccupied slot is found
-    assert(indices[id] == UNUSED_OBJECT_INDEX, "Attempted to create an Object in an occupied slot");
+
+    if (totalActiveObjects == totalCommittedObjects) {
+      commitObjects();
+    }
+
+    // Objects may be removed and recreated without resetting
+    // the pool (e.g. when regenerating dynamic mesh pieces), so
+    // cycle through IDs until an unoccupied slot is found
+    while (
+      runningId == UNUSED_OBJECT_INDEX ||
+      (runningId < totalCommittedIds && indices[runningId] != UNUSED_OBJECT_INDEX)
+    ) {
+      runningId++;
+    }
+
+    if (runningId >= totalCommittedIds) {
+      commitIds(runningId);
+    }
+
+    u16 id = runningId++;
 
     if (runningId > highestId) {
       highestId = runningId;
@@ -44,41 +90,93 @@ namespace Gamma {
     indices[id] = index;
 
     totalActiveObjects++;
-    totalVisibleObjects++;
+
+    // New objects are visible until the pool is culled again
+    if (hasStaleVisibleIndices) {
+      visibleRecords.push_back(object._record);
+    } else if (culled) {
+      visibleIndices.push_back(index);
+    }
 
     changed = true;
+    version++;
 
     return object;
   }
 
+  /**
+   * ObjectPool::editVisibleIndices
+   * ------------------------------
+   *
+   * Returns the list of visible object indices for culling
+   * to modify, starting with every active object if the pool
+   * wasn't already culled. Since objects aren't changed by
+   * culling, only 'changed' is set and 'version' is left as-is.
+   */
+  std::vector<u16>& ObjectPool::editVisibleIndices() {
+    if (!culled) {
+      visibleIndices.resize(totalActiveObjects);
+
+      for (u16 i = 0; i < totalActiveObjects; i++) {
+        visibleIndices[i] = i;
+      }
+
+      culled = true;
+    } else {
+      resolveVisibleIndices();
+    }
+
+    changed = true;
+
+    return visibleIndices;
+  }
+
   Object* ObjectPool::end() const {
     return &objects[totalActiveObjects];
   }
 
   void ObjectPool::free() {
-    for (u16 i = 0; i < USHRT_MAX; i++) {
-      indices[i] = UNUSED_OBJECT_INDEX;
+    if (objects != nullptr) {
+      Gm_ReleaseMemory(objects, alignToPageSize(maxObjects * sizeof(Object)));
+      Gm_ReleaseMemory(matrices, alignToPageSize(maxObjects * sizeof(Matrix4f)));
+      Gm_ReleaseMemory(colors, alignToPageSize(maxObjects * sizeof(pVec4)));
     }
 
-    if (objects != nullptr) {
-      delete[] objects;
+    if (indices != nullptr) {
+      Gm_ReleaseMemory(indices, TOTAL_OBJECT_IDS * sizeof(u16));
     }
 
-    if (matrices != nullptr) {
-      delete[] matrices;
+    for (u32 i = 0; i < totalCommittedObjects; i += OBJECT_COMMIT_SIZE) {
+      Gm_TrackFree(MEMORY_POOLS, getPoolSizeInBytes(std::min(totalCommittedObjects - i, (u32)OBJECT_COMMIT_SIZE)));
     }
 
-    if (colors != nullptr) {
-      delete[] colors;
+    for (u32 i = 0; i < totalCommittedIds; i += OBJECT_ID_COMMIT_SIZE) {
+      Gm_TrackFree(MEMORY_POOLS, OBJECT_ID_COMMIT_SIZE * sizeof(u16));
     }
 
     objects = nullptr;
     matrices = nullptr;
     colors = nullptr;
+    indices = nullptr;
+    maxObjects = 0;
+    totalCommittedObjects = 0;
+    totalCommittedIds = 0;
+    totalActiveObjects = 0;
+    runningId = 0;
+    highestId = 0;
+    visibleIndices.clear();
+    visibleRecords.clear();
+    culled = false;
+    hasStaleVisibleIndices = false;
     changed = true;
+    version++;
   }
 
   Object* ObjectPool::getById(u16 objectId) const {
+    if (objectId >= totalCommittedIds) {
+      return nullptr;
+    }
+
     u16 index = indices[objectId];
 
     return index == UNUSED_OBJECT_INDEX ? nullptr : &objects[index];
@@ -106,81 +204,25 @@ namespace Gamma {
     return matrices;
   }
 
-  u16 ObjectPool::max() const {
-    return maxObjects;
-  }
-
-  u16 ObjectPool::partitionByDistance(u16 start, float distance, const Vec3f& cameraPosition, bool checkAllObjects) {
-    u16 current = start;
-    u16 end = checkAllObjects ? totalActive() : totalVisible();
-
-    while (end > current) {
-      float currentObjectDistance = (objects[current].position - cameraPosition).magnitude();
-
-      if (currentObjectDistance <= distance) {
-        current++;
-      } else {
-        float endObjectDistance;
-
-        do {
-          endObjectDistance = (objects[--end].position - cameraPosition).magnitude();
-        } while (endObjectDistance > distance && end > current);
-
-        if (current != end) {
-          swapObjects(current, end);
-        }
-
-        // @optimize we can increment 'current' here if endObjectDistance < distance
-        // to avoid recalculating the same distance on the next while loop cycle
-        // @todo test this out and make sure it works
-      }
-    }
-
-    changed = true;
+  const std::vector<u16>& ObjectPool::getVisibleIndices() {
+    resolveVisibleIndices();
 
-    return current;
+    return visibleIndices;
   }
 
-  void ObjectPool::partitionByVisibility(const Camera& camera, float distanceThreshold, float fovDivisor) {
-    const float visibilityDotThreshold = 1.f - camera.fov / fovDivisor;
-
-    u16 current = 0;
-    u16 end = totalActive();
-    Vec3f cameraDirection = camera.orientation.getDirection();
-
-    while (end > current) {
-      Vec3f cameraToObject = objects[current].position - camera.position;
-      float distance = cameraToObject.magnitude();
-      Vec3f unitCameraToObject = cameraToObject / distance;
-
-      if (Vec3f::dot(cameraDirection, unitCameraToObject) >= visibilityDotThreshold || distance < distanceThreshold) {
-        current++;
-      } else {
-        float endDistance = 0.f;
-        Vec3f endUnitCameraToObject;
-
-        do {
-          Vec3f endCameraToObject = (objects[--end].position - camera.position);
-          endDistance = endCameraToObject.magnitude();
-          endUnitCameraToObject = endCameraToObject / endDistance;
-        } while (
-          Vec3f::dot(cameraDirection, endUnitCameraToObject) < visibilityDotThreshold &&
-          endDistance > distanceThreshold &&
-          end > current
-        );
-
-        if (current != end) {
-          swapObjects(current, end);
-        }
-      }
-    }
-
-    changed = true;
+  bool ObjectPool::isCulled() const {
+    return culled;
+  }
 
-    totalVisibleObjects = current;
+  u16 ObjectPool::max() const {
+    return maxObjects;
   }
 
   void ObjectPool::removeById(u16 objectId) {
+    if (objectId >= totalCommittedIds) {
+      return;
+    }
+
     u16 index = indices[objectId];
 
     if (index == UNUSED_OBJECT_INDEX) {
@@ -188,10 +230,21 @@ namespace Gamma {
     }
 
     totalActiveObjects--;
-    totalVisibleObjects--;
 
     u16 lastIndex = totalActiveObjects;
 
+    if (culled && !hasStaleVisibleIndices) {
+      // Track visible objects by record until the list is next
+      // read, rather than patching it up after every removal
+      visibleRecords.resize(visibleIndices.size());
+
+      for (u32 i = 0; i < visibleIndices.size(); i++) {
+        visibleRecords[i] = objects[visibleIndices[i]]._record;
+      }
+
+      hasStaleVisibleIndices = true;
+    }
+
     // Move last object/matrix/color into removed index
     objects[index] = objects[lastIndex];
     matrices[index] = matrices[lastIndex];
@@ -202,6 +255,7 @@ namespace Gamma {
     indices[objectId] = UNUSED_OBJECT_INDEX;
 
     changed = true;
+    version++;
   }
 
   void ObjectPool::reset() {
@@ -210,64 +264,141 @@ namespace Gamma {
     }
 
     totalActiveObjects = 0;
-    totalVisibleObjects = 0;
     runningId = 0;
+    culled = false;
+    hasStaleVisibleIndices = false;
     changed = true;
+    version++;
   }
 
+  /**
+   * ObjectPool::reserve
+   * -------------------
+   *
+   * Sets the maximum number of objects in the pool, reserving
+   * enough address space for them without committing memory.
+   */
   void ObjectPool::reserve(u16 size) {
     free();
 
     maxObjects = size;
-    totalActiveObjects = 0;
-    totalVisibleObjects = 0;
-    objects = new Object[size];
-    matrices = new Matrix4f[size];
-    colors = new pVec4[size];
-    changed = true;
+
+    if (size > 0) {
+      objects = (Object*)Gm_ReserveMemory(alignToPageSize(size * sizeof(Object)));
+      matrices = (Matrix4f*)Gm_ReserveMemory(alignToPageSize(size * sizeof(Matrix4f)));
+      colors = (pVec4*)Gm_ReserveMemory(alignToPageSize(size * sizeof(pVec4)));
+    }
+
+    indices = (u16*)Gm_ReserveMemory(TOTAL_OBJECT_IDS * sizeof(u16));
   }
 
   void ObjectPool::showAll() {
-    totalVisibleObjects = totalActiveObjects;
+    culled = false;
+    hasStaleVisibleIndices = false;
     changed = true;
   }
 
-  void ObjectPool::swapObjects(u16 indexA, u16 indexB) {
-    Object objectA = objects[indexA];
-    Matrix4f matrixA = matrices[indexA];
-    pVec4 colorA = colors[indexA];
+  /**
+   * ObjectPool::commitIds
+   * ---------------------
+   *
+   * Commits blocks of the ID -> index lookup table up to and
+   * including a given ID, marking the new IDs as unoccupied.
+   */
+  void ObjectPool::commitIds(u16 objectId) {
+    while (totalCommittedIds <= objectId) {
+      u32 start = totalCommittedIds;
+      u32 end = start + OBJECT_ID_COMMIT_SIZE;
 
-    objects[indexA] = objects[indexB];
-    matrices[indexA] = matrices[indexB];
-    colors[indexA] = colors[indexB];
+      commitArrayRange(indices, sizeof(u16), start, end);
 
-    objects[indexB] = objectA;
-    matrices[indexB] = matrixA;
-    colors[indexB] = colorA;
+      std::fill(indices + start, indices + end, (u16)UNUSED_OBJECT_INDEX);
 
-    indices[objects[indexA]._record.id] = indexA;
-    indices[objects[indexB]._record.id] = indexB;
+      Gm_TrackAllocation(MEMORY_POOLS, OBJECT_ID_COMMIT_SIZE * sizeof(u16));
+
+      totalCommittedIds = end;
+    }
+  }
+
+  /**
+   * ObjectPool::commitObjects
+   * -------------------------
+   *
+   * Commits the next block of object, matrix and color storage.
+   */
+  void ObjectPool::commitObjects() {
+    u32 start = totalCommittedObjects;
+    u32 end = std::min(start + OBJECT_COMMIT_SIZE, (u32)maxObjects);
+
+    commitArrayRange(objects, sizeof(Object), start, end);
+    commitArrayRange(matrices, sizeof(Matrix4f), start, end);
+    commitArrayRange(colors, sizeof(pVec4), start, end);
+
+    for (u32 i = start; i < end; i++) {
+      new (&objects[i]) Object();
+    }
+
+    Gm_TrackAllocation(MEMORY_POOLS, getPoolSizeInBytes(end - start));
+
+    totalCommittedObjects = end;
+  }
+
+  /**
+   * ObjectPool::resolveVisibleIndices
+   * ---------------------------------
+   *
+   * Rebuilds the visible index list from the records of the
+   * visible objects, dropping any which have been removed.
+   * Order is preserved, since level of detail partitioning
+   * depends on it.
+   */
+  void ObjectPool::resolveVisibleIndices() {
+    if (!hasStaleVisibleIndices) {
+      return;
+    }
+
+    // A removed object's ID may have been reused by a new object
+    // with a matching generation, which would then be listed twice
+    std::vector<bool> isListed(totalActiveObjects, false);
+
+    visibleIndices.clear();
+
+    for (auto& record : visibleRecords) {
+      auto* object = getByRecord(record);
+
+      if (object != nullptr) {
+        u16 index = u16(object - objects);
+
+        if (!isListed[index]) {
+          visibleIndices.push_back(index);
+
+          isListed[index] = true;
+        }
+      }
+    }
+
+    hasStaleVisibleIndices = false;
   }
 
   void ObjectPool::setColorById(u16 objectId, const pVec4& color) {
     colors[indices[objectId]] = color;
     changed = true;
-  }
-
-  void ObjectPool::setTotalVisible(u16 total) {
-    totalVisibleObjects = total;
+    version++;
   }
 
   u16 ObjectPool::totalActive() const {
     return totalActiveObjects;
   }
 
-  u16 ObjectPool::totalVisible() const {
-    return totalVisibleObjects;
+  u16 ObjectPool::totalVisible() {
+    resolveVisibleIndices();
+
+    return culled ? (u16)visibleIndices.size() : totalActiveObjects;
   }
 
   void ObjectPool::transformById(u16 objectId, const Matrix4f& matrix) {
     matrices[indices[objectId]] = matrix;
     changed = true;
+    version++;
   }
 }
\ No newline at end of file
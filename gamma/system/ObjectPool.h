@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "math/matrix.h"
 #include "system/packed_data.h"
 #include "system/type_aliases.h"
@@ -7,7 +9,6 @@
 namespace Gamma {
   struct Object;
   struct ObjectRecord;
-  struct Camera;
 
   /**
    * ObjectPool
@@ -16,6 +17,20 @@ namespace Gamma {
    * A collection of Objects tied to a given Mesh, designed
    * to facilitate instanced/batched rendering.
    *
+   * reserve() only reserves address space for the maximum
+   * number of objects; memory is committed in blocks as
+   * objects are created, so pools with generous limits only
+   * cost as much as the objects they actually contain. The
+   * object, matrix and color arrays stay contiguous, and
+   * object addresses remain stable until the pool is freed.
+   *
+   * Culling never reorders objects. Instead, a culled pool
+   * holds a list of the indices of its visible objects, which
+   * the renderer gathers instance data from. Since removals
+   * move objects to new indices, the list is tracked by object
+   * record after a removal, and only resolved back to indices
+   * the next time it's read.
+   *
    * @todo u16 -> u32 to support >65K objects per pool
    */
   class ObjectPool {
@@ -25,45 +40,59 @@ namespace Gamma {
      * and if new instance data needs to be buffered to the GPU.
      */
     bool changed = false;
+    /**
+     * Incremented whenever any of the mesh instances are changed.
+     * Unlike 'changed', this is never reset, so changes can be
+     * tracked independently by several consumers.
+     */
+    u32 version = 0;
 
     Object& operator[](u32 index);
 
     Object* begin() const;
     Object& createObject();
     Object* end() const;
+    std::vector<u16>& editVisibleIndices();
     void free();
     Object* getById(u16 objectId) const;
     Object* getByRecord(const ObjectRecord& record) const;
     pVec4* getColors() const;
     u16 getHighestId() const;
     Matrix4f* getMatrices() const;
+    const std::vector<u16>& getVisibleIndices();
+    bool isCulled() const;
     u16 max() const;
-    u16 partitionByDistance(u16 start, float distance, const Vec3f& cameraPosition, bool checkAllObjects = false);
-    void partitionByVisibility(const Camera& camera, float distanceThreshold = 0.f, float fovDivisor = 90.f);
     void removeById(u16 objectId);
     void reset();
     void reserve(u16 size);
     void setColorById(u16 objectId, const pVec4& color);
-    void setTotalVisible(u16 total);
     void showAll();
     u16 totalActive() const;
-    u16 totalVisible() const;
+    u16 totalVisible();
     void transformById(u16 objectId, const Matrix4f& matrix);
 
   private:
     Object* objects = nullptr;
     Matrix4f* matrices = nullptr;
     pVec4* colors = nullptr;
-    // @todo if we cycle through indices to find unoccupied slots
-    // when creating new objects, we needn't preallocate the entire
-    // indices array up to USHRT_MAX/0xffff
-    u16 indices[0xffff];
+    // Object indices by ID, committed in blocks as IDs are
+    // used. IDs beyond totalCommittedIds are unoccupied.
+    u16* indices = nullptr;
+    u32 totalCommittedObjects = 0;
+    u32 totalCommittedIds = 0;
     u16 maxObjects = 0;
     u16 totalActiveObjects = 0;
-    u16 totalVisibleObjects = 0;
+    // Indices of visible objects, if the pool has been culled
+    std::vector<u16> visibleIndices;
+    // Records of visible objects while visibleIndices is stale
+    std::vector<ObjectRecord> visibleRecords;
+    bool culled = false;
+    bool hasStaleVisibleIndices = false;
     u16 runningId = 0;
     u16 highestId = 0;
 
-    void swapObjects(u16 indexA, u16 indexB);
+    void commitIds(u16 objectId);
+    void commitObjects();
+    void resolveVisibleIndices();
   };
 }
\ No newline at end of file
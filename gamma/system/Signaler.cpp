@@ -0,0 +1,152 @@
+#include "system/assert.h"
+#include "system/Signaler.h"
+
+namespace Gamma {
+  /**
+   * Signaler
+   * --------
+   */
+  Signaler::~Signaler() {
+    for (auto& event : events) {
+      for (auto& listener : event.listeners) {
+        listener.destroy(listener.target);
+      }
+    }
+  }
+
+  /**
+   * Signaler::dispatchQueuedEvents
+   * ------------------------------
+   *
+   * Signals all queued events, in the order they were queued.
+   * Events queued during dispatch are deferred until the next
+   * call.
+   */
+  void Signaler::dispatchQueuedEvents() {
+    {
+      std::scoped_lock lock(queueMutex);
+
+      if (queuedEvents.size() == 0) {
+        return;
+      }
+
+      queuedEvents.swap(dispatchingEvents);
+      queuedData.swap(dispatchingData);
+    }
+
+    for (auto& [ eventId, offset ] : dispatchingEvents) {
+      dispatch(eventId, dispatchingData.data() + offset);
+    }
+
+    dispatchingEvents.clear();
+    dispatchingData.clear();
+  }
+
+  void Signaler::off(u32 listenerId) {
+    for (auto& event : events) {
+      for (auto& listener : event.listeners) {
+        if (listener.id == listenerId) {
+          listener.id = 0;
+          hasRemovedListeners = true;
+        }
+      }
+    }
+
+    removeListeners();
+  }
+
+  void Signaler::off(const std::string& eventName) {
+    for (auto& event : events) {
+      if (event.name == eventName) {
+        for (auto& listener : event.listeners) {
+          listener.id = 0;
+          hasRemovedListeners = true;
+        }
+      }
+    }
+
+    removeListeners();
+  }
+
+  void Signaler::assertEventType(u32 eventId, const void* type) const {
+    if (eventId >= events.size() || events[eventId].type != type) {
+      assert(false, "Signaler: mismatched event data type");
+    }
+  }
+
+  /**
+   * Signaler::dispatch
+   * ------------------
+   *
+   * Invokes each of an event's listeners. Listeners bound
+   * during dispatch aren't invoked until the next dispatch,
+   * and listeners removed during dispatch are skipped.
+   */
+  void Signaler::dispatch(u32 eventId, const void* data) {
+    auto& listeners = events[eventId].listeners;
+    u32 totalListeners = (u32)listeners.size();
+
+    dispatchDepth++;
+
+    for (u32 i = 0; i < totalListeners; i++) {
+      // Re-index each time in case a listener bound another
+      // listener and the array was reallocated
+      auto& listener = listeners[i];
+
+      if (listener.id != 0) {
+        listener.invoke(listener.target, data);
+      }
+    }
+
+    dispatchDepth--;
+
+    removeListeners();
+  }
+
+  u32 Signaler::findEvent(const std::string& eventName, const void* type) const {
+    for (u32 i = 0; i < events.size(); i++) {
+      if (events[i].name == eventName) {
+        if (events[i].type != type) {
+          assert(false, "Signaler: mismatched listener type for event '" + eventName + "'");
+        }
+
+        return i;
+      }
+    }
+
+    assert(false, "Signaler: unknown event '" + eventName + "'");
+
+    return 0;
+  }
+
+  /**
+   * Signaler::removeListeners
+   * -------------------------
+   *
+   * Destroys and compacts away any removed listeners, unless
+   * an event is being dispatched, in which case removal is
+   * deferred until dispatch finishes.
+   */
+  void Signaler::removeListeners() {
+    if (!hasRemovedListeners || dispatchDepth > 0) {
+      return;
+    }
+
+    for (auto& event : events) {
+      auto& listeners = event.listeners;
+      u32 total = 0;
+
+      for (u32 i = 0; i < listeners.size(); i++) {
+        if (listeners[i].id == 0) {
+          listeners[i].destroy(listeners[i].target);
+        } else {
+          listeners[total++] = listeners[i];
+        }
+      }
+
+      listeners.resize(total);
+    }
+
+    hasRemovedListeners = false;
+  }
+}
\ No newline at end of file
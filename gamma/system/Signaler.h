@@ -1,49 +1,164 @@
 #pragma once
 
-#include <functional>
-#include <map>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "system/type_aliases.h"
+
 namespace Gamma {
+  /**
+   * A unique address per event data type, used to verify that
+   * listeners and signals match the type an event was
+   * registered with.
+   */
   template<typename T>
-  struct Event {
-    T data;
+  inline const char SIGNALER_EVENT_TYPE = 0;
+
+  /**
+   * SignalerListener
+   * ----------------
+   *
+   * A listener bound to a single event. The listener callable
+   * is allocated once on subscription, and invoked through a
+   * function pointer specialized for its event data type.
+   */
+  struct SignalerListener {
+    // 0 once a listener has been removed
+    u32 id = 0;
+    void* target = nullptr;
+    void (*invoke)(void* target, const void* data) = nullptr;
+    void (*destroy)(void* target) = nullptr;
+  };
 
-    Event(T data): data(data) {};
+  struct SignalerEvent {
+    std::string name;
+    const void* type = nullptr;
+    std::vector<SignalerListener> listeners;
   };
 
-  // @todo? use a lock for listener binding/dispatch thread-safety
-  // @todo off(), off(eventName), off(eventName, listener)
+  struct QueuedSignalerEvent {
+    u32 eventId;
+    u32 offset;
+  };
+
+  /**
+   * Signaler
+   * --------
+   *
+   * Dispatches events to listeners. Events are registered by
+   * subclasses up front, resolving each event name to an ID
+   * which is then used to signal the event, and listeners are
+   * stored in a flat array per event.
+   *
+   * Listener binding and signal() are not thread-safe, and
+   * should only happen on the main thread. Other threads can
+   * queue() events, which are dispatched on the main thread
+   * whenever dispatchQueuedEvents() is called.
+   */
   class Signaler {
   public:
-    ~Signaler() {
-      for (auto& [key, listeners] : listenerMap) {
-        listeners.clear();
-      }
+    Signaler() {};
+    Signaler(const Signaler&) = delete;
+    ~Signaler();
+
+    void dispatchQueuedEvents();
+    void off(u32 listenerId);
+    void off(const std::string& eventName);
+
+    /**
+     * Signaler::on
+     * ------------
+     *
+     * Binds a listener to an event, returning an ID which
+     * can be used to unbind it with off().
+     */
+    template<typename T, typename F>
+    u32 on(const std::string& eventName, F&& listener) {
+      using Listener = std::decay_t<F>;
+
+      auto& event = events[findEvent(eventName, &SIGNALER_EVENT_TYPE<T>)];
+      SignalerListener signalerListener;
+
+      signalerListener.id = ++totalListenerIds;
+      signalerListener.target = new Listener(std::forward<F>(listener));
+
+      signalerListener.invoke = [](void* target, const void* data) {
+        (*(Listener*)target)(*(const T*)data);
+      };
+
+      signalerListener.destroy = [](void* target) {
+        delete (Listener*)target;
+      };
+
+      event.listeners.push_back(signalerListener);
 
-      listenerMap.clear();
+      return signalerListener.id;
     }
 
+    /**
+     * Signaler::queue
+     * ---------------
+     *
+     * Queues an event to be signaled on the next call to
+     * dispatchQueuedEvents(). Safe to call from any thread.
+     */
     template<typename T>
-    void on(std::string eventName, const std::function<void(T)>& listener) {
-      listenerMap[eventName].push_back([=](void* event) {
-        listener(((Event<T>*)event)->data);
-      });
+    void queue(u32 eventId, const T& data) {
+      static_assert(std::is_trivially_copyable_v<T>, "Queued event data must be trivially copyable");
+
+      assertEventType(eventId, &SIGNALER_EVENT_TYPE<T>);
+
+      std::scoped_lock lock(queueMutex);
+
+      // Keep each event's data aligned for dispatch
+      u32 offset = (u32)((queuedData.size() + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1));
+
+      queuedData.resize(offset + sizeof(T));
+      memcpy(queuedData.data() + offset, &data, sizeof(T));
+      queuedEvents.push_back({ eventId, offset });
     }
 
   protected:
     template<typename T>
-    void signal(std::string eventName, T data) {
-      Event<T> event(data);
-      auto& listeners = listenerMap[eventName];
+    u32 registerEvent(const std::string& eventName) {
+      SignalerEvent event;
+
+      event.name = eventName;
+      event.type = &SIGNALER_EVENT_TYPE<T>;
+
+      events.push_back(event);
 
-      for (auto& listener : listeners) {
-        listener(&event);
-      }
+      return (u32)events.size() - 1;
+    }
+
+    template<typename T>
+    void signal(u32 eventId, const T& data) {
+      assertEventType(eventId, &SIGNALER_EVENT_TYPE<T>);
+
+      dispatch(eventId, &data);
     }
 
   private:
-    std::map<std::string, std::vector<std::function<void(void*)>>> listenerMap;
+    std::vector<SignalerEvent> events;
+    u32 totalListenerIds = 0;
+    u32 dispatchDepth = 0;
+    bool hasRemovedListeners = false;
+    std::mutex queueMutex;
+    std::vector<QueuedSignalerEvent> queuedEvents;
+    std::vector<u8> queuedData;
+    // Queued events being dispatched, swapped with the queue
+    // so it can be refilled during dispatch without allocating
+    std::vector<QueuedSignalerEvent> dispatchingEvents;
+    std::vector<u8> dispatchingData;
+
+    void assertEventType(u32 eventId, const void* type) const;
+    void dispatch(u32 eventId, const void* data);
+    u32 findEvent(const std::string& eventName, const void* type) const;
+    void removeListeners();
   };
 }
\ No newline at end of file
@@ -1,41 +1,432 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
 #include "system/console.h"
 
-#include "SDL.h"
+/**
+ * The number of messages the ring buffer can hold before
+ * the background thread writes them out. Must be a power
+ * of 2.
+ */
+#define CONSOLE_RING_SIZE 1024
+#define CONSOLE_OVERLAY_SIZE 5
 
 namespace Gamma {
-  std::stringstream Console::output;
-  ConsoleMessage* Console::firstMessage = nullptr;
-  ConsoleMessage* Console::lastMessage = nullptr;
-  u32 Console::messageCounter = 0;
+  enum ConsoleWorkerState : u8 {
+    WORKER_STOPPED,
+    WORKER_STARTING,
+    WORKER_RUNNING,
+    WORKER_STOPPING,
+    // The console has been shut down, and the worker
+    // is never restarted
+    WORKER_SHUT_DOWN
+  };
+
+  /**
+   * ConsoleSlot
+   * -----------
+   *
+   * A ring buffer slot. The sequence number determines whether
+   * the slot is free to be written at a given write position
+   * (sequence == position), or holds a message ready to be read
+   * at a given read position (sequence == position + 1).
+   */
+  struct ConsoleSlot {
+    std::atomic<u32> sequence;
+    ConsoleMessage message;
+  };
+
+  /**
+   * ConsoleRing
+   * -----------
+   *
+   * A bounded multi-producer, single-consumer queue of console
+   * messages. Producers claim slots by advancing the write
+   * position, and only the background thread reads.
+   */
+  struct ConsoleRing {
+    ConsoleSlot slots[CONSOLE_RING_SIZE];
+    std::atomic<u32> writePosition = 0;
+    std::atomic<u32> processedPosition = 0;
+    std::atomic<u32> totalDropped = 0;
+    u32 readPosition = 0;
+
+    ConsoleRing() {
+      for (u32 i = 0; i < CONSOLE_RING_SIZE; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  static ConsoleRing& getRing() {
+    static ConsoleRing ring;
+
+    return ring;
+  }
+
+  static u64 getConsoleTime() {
+    static auto startTime = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+  }
+
+  static std::atomic<u8> workerState = ConsoleWorkerState::WORKER_STOPPED;
+  static std::atomic<bool> isWorkerStopping = false;
+  static std::atomic<bool> isWorkerWaiting = false;
+  static std::thread* worker = nullptr;
+  static std::mutex workerMutex;
+  static std::condition_variable workerSignal;
+
+  // Sinks, only written to by the background thread
+  static std::mutex logFileMutex;
+  static FILE* logFile = nullptr;
+  static std::mutex overlayMutex;
+  static ConsoleMessage overlayMessages[CONSOLE_OVERLAY_SIZE];
+  static u32 totalOverlayMessages = 0;
+
+  static void writeMessage(const ConsoleMessage& message) {
+    u64 milliseconds = message.time / 1000;
+    char timestamp[32];
+
+    snprintf(timestamp, sizeof(timestamp), "[%02llu:%02llu.%03llu] ", milliseconds / 60000, (milliseconds / 1000) % 60, milliseconds % 1000);
+
+    FILE* output = message.level == ConsoleLevel::CONSOLE_ERROR ? stderr : stdout;
+
+    fputs(timestamp, output);
+    fwrite(message.text, 1, message.length, output);
+    fputc('\n', output);
+
+    {
+      std::scoped_lock lock(logFileMutex);
+
+      if (logFile != nullptr) {
+        fputs(timestamp, logFile);
+        fwrite(message.text, 1, message.length, logFile);
+        fputc('\n', logFile);
+      }
+    }
+
+    {
+      std::scoped_lock lock(overlayMutex);
+
+      if (totalOverlayMessages == CONSOLE_OVERLAY_SIZE) {
+        std::move(overlayMessages + 1, overlayMessages + CONSOLE_OVERLAY_SIZE, overlayMessages);
+
+        totalOverlayMessages--;
+      }
+
+      overlayMessages[totalOverlayMessages++] = message;
+    }
+  }
+
+  /**
+   * Writes out all messages in the ring buffer, returning
+   * the number of messages written.
+   */
+  static u32 drainMessages(ConsoleRing& ring) {
+    ConsoleMessage message;
+    u32 total = 0;
+
+    while (true) {
+      auto& slot = ring.slots[ring.readPosition & (CONSOLE_RING_SIZE - 1)];
+
+      if (slot.sequence.load(std::memory_order_acquire) != ring.readPosition + 1) {
+        break;
+      }
+
+      message.time = slot.message.time;
+      message.level = slot.message.level;
+      message.length = slot.message.length;
+
+      memcpy(message.text, slot.message.text, slot.message.length + 1);
+
+      // Free the slot before writing the message, so
+      // producers aren't held up by slow sinks
+      slot.sequence.store(ring.readPosition + CONSOLE_RING_SIZE, std::memory_order_release);
+      ring.readPosition++;
+
+      writeMessage(message);
+
+      total++;
+    }
+
+    u32 totalDropped = ring.totalDropped.exchange(0, std::memory_order_relaxed);
+
+    if (totalDropped > 0) {
+      message.time = getConsoleTime();
+      message.level = ConsoleLevel::CONSOLE_WARNING;
+      message.length = (u16)snprintf(message.text, CONSOLE_MESSAGE_SIZE, "[Gamma] %u console messages dropped", totalDropped);
+
+      writeMessage(message);
+
+      total++;
+    }
+
+    if (total > 0) {
+      fflush(stdout);
+
+      std::scoped_lock lock(logFileMutex);
+
+      if (logFile != nullptr) {
+        fflush(logFile);
+      }
+    }
+
+    ring.processedPosition.store(ring.readPosition, std::memory_order_release);
+
+    return total;
+  }
+
+  static bool hasPendingMessages(ConsoleRing& ring) {
+    auto& slot = ring.slots[ring.readPosition & (CONSOLE_RING_SIZE - 1)];
+
+    return (
+      slot.sequence.load(std::memory_order_acquire) == ring.readPosition + 1 ||
+      ring.totalDropped.load(std::memory_order_relaxed) > 0
+    );
+  }
+
+  /**
+   * Wakes the background thread if it's waiting for messages.
+   * Producers only take the worker mutex when the thread is
+   * actually asleep, so logging stays lock-free while it's
+   * busy writing.
+   */
+  static void signalWorker() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (isWorkerWaiting.load(std::memory_order_relaxed)) {
+      std::scoped_lock lock(workerMutex);
+
+      workerSignal.notify_one();
+    }
+  }
+
+  static void runWorker() {
+    auto& ring = getRing();
+
+    while (true) {
+      bool isStopping = isWorkerStopping.load(std::memory_order_acquire);
 
+      if (drainMessages(ring) == 0) {
+        if (isStopping) {
+          break;
+        }
+
+        std::unique_lock<std::mutex> lock(workerMutex);
+
+        isWorkerWaiting.store(true, std::memory_order_relaxed);
+
+        // Pairs with the fence in signalWorker(), so that either
+        // the producer sees us waiting, or we see its message
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        workerSignal.wait(lock, [&ring]() {
+          return hasPendingMessages(ring) || isWorkerStopping.load(std::memory_order_acquire);
+        });
+
+        isWorkerWaiting.store(false, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  static void startWorker() {
+    if (workerState.load(std::memory_order_acquire) != ConsoleWorkerState::WORKER_STOPPED) {
+      return;
+    }
+
+    u8 expected = ConsoleWorkerState::WORKER_STOPPED;
+
+    if (workerState.compare_exchange_strong(expected, ConsoleWorkerState::WORKER_STARTING)) {
+      worker = new std::thread(runWorker);
+
+      workerState.store(ConsoleWorkerState::WORKER_RUNNING, std::memory_order_release);
+    }
+  }
+
+  /**
+   * Console
+   * -------
+   */
   void Console::clearMessages() {
-    // @todo
+    std::scoped_lock lock(overlayMutex);
+
+    totalOverlayMessages = 0;
   }
 
-  void Console::storeMessage(const std::string message, bool warning) {
-    auto* consoleMessage = new ConsoleMessage();
+  /**
+   * Console::flush
+   * --------------
+   *
+   * Blocks until all messages logged before the call have
+   * been written out.
+   */
+  void Console::flush() {
+    auto& ring = getRing();
+    u32 target = ring.writePosition.load(std::memory_order_acquire);
+
+    startWorker();
+
+    while (
+      workerState.load(std::memory_order_acquire) == ConsoleWorkerState::WORKER_RUNNING &&
+      (s32)(ring.processedPosition.load(std::memory_order_acquire) - target) < 0
+    ) {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Console::getMessages
+   * --------------------
+   *
+   * Copies up to 'max' of the most recent messages for the
+   * on-screen console, oldest first, and returns the number
+   * of messages copied.
+   */
+  u32 Console::getMessages(ConsoleMessage* messages, u32 max) {
+    std::scoped_lock lock(overlayMutex);
+
+    u32 total = std::min(max, totalOverlayMessages);
+    u32 start = totalOverlayMessages - total;
 
-    // @todo use system time or something we can
-    // determine HH:MM:SS from
-    consoleMessage->time = SDL_GetTicks();
-    consoleMessage->warning = warning;
-    consoleMessage->text = message;
-    consoleMessage->next = nullptr;
+    for (u32 i = 0; i < total; i++) {
+      messages[i] = overlayMessages[start + i];
+    }
+
+    return total;
+  }
+
+  void Console::setLogFile(const char* path) {
+    std::scoped_lock lock(logFileMutex);
 
-    if (firstMessage == nullptr) {
-      firstMessage = consoleMessage;
-    } else {
-      lastMessage->next = consoleMessage;
+    if (logFile != nullptr) {
+      fclose(logFile);
     }
 
-    lastMessage = consoleMessage;
+    logFile = fopen(path, "w");
+  }
 
-    if (++messageCounter > 5) {
-      auto* newFirstMessage = firstMessage->next;
+  /**
+   * Console::shutdown
+   * -----------------
+   *
+   * Writes out any remaining messages, stops the background
+   * thread and closes the log file.
+   */
+  void Console::shutdown() {
+    u8 state = workerState.load(std::memory_order_acquire);
 
-      delete firstMessage;
+    while (true) {
+      if (state == ConsoleWorkerState::WORKER_STARTING) {
+        std::this_thread::yield();
 
-      firstMessage = newFirstMessage;
+        state = workerState.load(std::memory_order_acquire);
+      } else if (
+        state == ConsoleWorkerState::WORKER_STOPPING ||
+        state == ConsoleWorkerState::WORKER_SHUT_DOWN
+      ) {
+        return;
+      } else if (workerState.compare_exchange_weak(state, ConsoleWorkerState::WORKER_STOPPING)) {
+        break;
+      }
     }
+
+    if (worker != nullptr) {
+      {
+        std::scoped_lock lock(workerMutex);
+
+        isWorkerStopping.store(true, std::memory_order_release);
+        workerSignal.notify_one();
+      }
+
+      worker->join();
+
+      delete worker;
+
+      worker = nullptr;
+    }
+
+    {
+      std::scoped_lock lock(logFileMutex);
+
+      if (logFile != nullptr) {
+        fclose(logFile);
+
+        logFile = nullptr;
+      }
+    }
+
+    // Messages logged from here on are ignored, rather
+    // than restarting a worker which is never joined
+    workerState.store(ConsoleWorkerState::WORKER_SHUT_DOWN, std::memory_order_release);
+  }
+
+  void Console::appendText(ConsoleMessage& message, const char* text, u32 length) {
+    u32 available = CONSOLE_MESSAGE_SIZE - 1 - message.length;
+    u32 total = std::min(length, available);
+
+    memcpy(message.text + message.length, text, total);
+
+    message.length += (u16)total;
+  }
+
+  /**
+   * Console::push
+   * -------------
+   *
+   * Timestamps a formatted message and copies it into the
+   * next free ring buffer slot, dropping it if the ring
+   * buffer is full or the console has been shut down.
+   */
+  void Console::push(ConsoleMessage& message) {
+    if (workerState.load(std::memory_order_acquire) == ConsoleWorkerState::WORKER_SHUT_DOWN) {
+      return;
+    }
+
+    auto& ring = getRing();
+    u32 position = ring.writePosition.load(std::memory_order_relaxed);
+    ConsoleSlot* slot;
+
+    message.time = getConsoleTime();
+
+    while (true) {
+      slot = &ring.slots[position & (CONSOLE_RING_SIZE - 1)];
+
+      u32 sequence = slot->sequence.load(std::memory_order_acquire);
+      s32 difference = (s32)(sequence - position);
+
+      if (difference == 0) {
+        if (ring.writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // The ring buffer is full
+        ring.totalDropped.fetch_add(1, std::memory_order_relaxed);
+
+        startWorker();
+        signalWorker();
+
+        return;
+      } else {
+        position = ring.writePosition.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->message.time = message.time;
+    slot->message.level = message.level;
+    slot->message.length = message.length;
+
+    memcpy(slot->message.text, message.text, message.length + 1);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    startWorker();
+    signalWorker();
   }
 }
\ No newline at end of file
@@ -1,66 +1,146 @@
 #pragma once
 
-#include <iostream>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <string>
-#include <tuple>
+#include <string_view>
+#include <type_traits>
 
 #include "system/type_aliases.h"
 
+#define CONSOLE_MESSAGE_SIZE 256
+
 namespace Gamma {
+  enum ConsoleLevel : u8 {
+    CONSOLE_LOG,
+    CONSOLE_WARNING,
+    CONSOLE_ERROR
+  };
+
+  /**
+   * ConsoleMessage
+   * --------------
+   *
+   * A single fixed-size console message. Messages longer than
+   * the text buffer are truncated.
+   */
   struct ConsoleMessage {
-    u32 time;
-    bool warning = false;
-    std::string text;
-    ConsoleMessage* next = nullptr;
+    // Microseconds since the console was first used
+    u64 time = 0;
+    ConsoleLevel level = ConsoleLevel::CONSOLE_LOG;
+    u16 length = 0;
+    char text[CONSOLE_MESSAGE_SIZE];
   };
 
+  /**
+   * Console
+   * -------
+   *
+   * Logs messages to stdout, an optional log file and the
+   * on-screen console. Messages are formatted on the calling
+   * thread into a fixed-size record, which is then pushed
+   * onto a preallocated lock-free ring buffer, so logging is
+   * safe from any thread and never allocates for common
+   * argument types. Timestamps and output to each sink are
+   * handled on a background thread.
+   *
+   * Messages are dropped if the ring buffer is full, and the
+   * number of dropped messages is reported once there's room.
+   */
   class Console {
   public:
     template<typename ...Args>
     static void log(Args&& ...args) {
-      // @todo output time with each console message
-      out(false, args...);
-      std::cout << "\n";
+      write(ConsoleLevel::CONSOLE_LOG, args...);
     }
 
     template<typename ...Args>
     static void warn(Args&& ...args) {
-      out(true, args...);
-      std::cout << "\n";
+      write(ConsoleLevel::CONSOLE_WARNING, args...);
     }
 
-    static void clearMessages();
-
-    static const ConsoleMessage* getFirstMessage() {
-      return Console::firstMessage;
+    template<typename ...Args>
+    static void error(Args&& ...args) {
+      write(ConsoleLevel::CONSOLE_ERROR, args...);
     }
 
+    static void clearMessages();
+    static void flush();
+    static u32 getMessages(ConsoleMessage* messages, u32 max);
+    static void setLogFile(const char* path);
+    static void shutdown();
+
   private:
-    static std::stringstream output;
-    static ConsoleMessage* firstMessage;
-    static ConsoleMessage* lastMessage;
-    static u32 messageCounter;
+    template<typename ...Args>
+    static void write(ConsoleLevel level, const Args& ...args) {
+      ConsoleMessage message;
+
+      message.level = level;
+      message.length = 0;
+
+      append(message, args...);
+
+      message.text[message.length] = '\0';
+
+      push(message);
+    }
 
     template<typename Arg, typename ...Args>
-    static void out(bool warning, Arg& arg, Args&& ...args) {
-      output << arg;
+    static void append(ConsoleMessage& message, const Arg& arg, const Args& ...args) {
+      appendValue(message, arg);
 
       if constexpr (sizeof...(args) > 0) {
-        output << " ";
-        out(warning, args...);
+        appendText(message, " ", 1);
+        append(message, args...);
+      }
+    }
+
+    template<typename Arg>
+    static void appendValue(ConsoleMessage& message, const Arg& arg) {
+      using T = std::decay_t<Arg>;
+
+      if constexpr (std::is_same_v<T, char>) {
+        appendText(message, &arg, 1);
+      } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        appendFormatted(message, "%lld", (long long)arg);
+      } else if constexpr (std::is_integral_v<T>) {
+        appendFormatted(message, "%llu", (unsigned long long)arg);
+      } else if constexpr (std::is_floating_point_v<T>) {
+        appendFormatted(message, "%g", (double)arg);
+      } else if constexpr (std::is_convertible_v<const Arg&, const char*>) {
+        const char* text = arg;
+
+        appendText(message, text, (u32)strlen(text));
+      } else if constexpr (std::is_convertible_v<const Arg&, std::string_view>) {
+        std::string_view text = arg;
+
+        appendText(message, text.data(), (u32)text.size());
       } else {
-        std::string outputString = output.str();
-        std::cout << outputString;
+        // Fall back to stream formatting for any other types
+        thread_local std::ostringstream stream;
+
+        stream.str(std::string());
+        stream.clear();
+        stream << arg;
+
+        std::string text = stream.str();
+
+        appendText(message, text.data(), (u32)text.size());
+      }
+    }
 
-        Console::storeMessage(outputString, warning);
+    template<typename ...Values>
+    static void appendFormatted(ConsoleMessage& message, const char* format, Values ...values) {
+      u32 capacity = CONSOLE_MESSAGE_SIZE - message.length;
+      int length = snprintf(message.text + message.length, capacity, format, values...);
 
-        // Reset output stream
-        output.str(std::string());
-        output.clear();
+      if (length > 0) {
+        message.length += (u16)(length < (int)capacity ? length : capacity - 1);
       }
     }
 
-    static void storeMessage(const std::string message, bool warning = false);
+    static void appendText(ConsoleMessage& message, const char* text, u32 length);
+    static void push(ConsoleMessage& message);
   };
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "opengl/OpenGLRenderer.h"
 #include "performance/benchmark.h"
+#include "performance/memory.h"
 #include "performance/tools.h"
 #include "system/assert.h"
 #include "system/console.h"
@@ -18,8 +19,6 @@
 
 using namespace Gamma;
 
-#define String(value) std::to_string(value)
-
 SDL_Surface* consoleOuterFrame = nullptr;
 SDL_Surface* consoleInnerFrame = nullptr;
 
@@ -42,52 +41,61 @@ static void Gm_DisplayDevtools(GmContext* context) {
   if (Gm_IsFlagEnabled(GammaFlags::ENABLE_DEV_TOOLS)) {
     // Render system-defined debug messages
     {
-      auto fpsLabel = "FPS: "
-        + String(fpsAverager.average())
-        + ", low "
-        + String(fpsAverager.low())
-        + " (V-Sync " + (renderStats.isVSynced ? "ON" : "OFF") + ")";
-
-      auto frameTimeLabel = "Frame time: "
-        + String(averageFrameTime)
-        + "us, high "
-        + String(frameTimeAverager.high())
-        + " ("
-        + String(frameTimeBudget)
-        + "%)";
-
-      u32 objectAllocationTotalInBytes = 0;
-
-      for (auto* mesh : context->scene.meshes) {
-        auto maxInstances = mesh->objects.max();
-
-        objectAllocationTotalInBytes += maxInstances * 52;
-      }
+      auto* fpsLabel = Gm_FrameFormat("FPS: %u, low %u (V-Sync %s)", fpsAverager.average(), fpsAverager.low(), renderStats.isVSynced ? "ON" : "OFF");
+      auto* frameTimeLabel = Gm_FrameFormat("Frame time: %lluus, high %llu (%u%%)", (unsigned long long)averageFrameTime, (unsigned long long)frameTimeAverager.high(), frameTimeBudget);
+
+      auto& frameAllocatorStats = Gm_GetFrameAllocatorStats();
+
+      auto* resolutionLabel = Gm_FrameFormat("Resolution: %u x %u", resolution.width, resolution.height);
+      auto* vertsLabel = Gm_FrameFormat("Verts: %u", sceneStats.verts);
+      auto* trisLabel = Gm_FrameFormat("Tris: %u", sceneStats.tris);
+      auto* totalLightsLabel = Gm_FrameFormat("Lights: %u", sceneStats.totalLights);
+      auto* totalMeshesLabel = Gm_FrameFormat("Meshes: %u", sceneStats.totalMeshes);
+      auto* totalDrawCallsLabel = Gm_FrameFormat("Draw calls: %u", renderStats.totalDrawCalls);
+      auto* trackedMemoryLabel = Gm_FrameFormat("Tracked memory: %.1fMB", float(Gm_GetTotalTrackedMemory()) / 1000000.f);
+      auto* gpuMemoryLabel = Gm_FrameFormat("GPU Memory: %uMB / %uMB", renderStats.gpuMemoryUsed, renderStats.gpuMemoryTotal);
+
+      auto* frameMemoryLabel = Gm_FrameFormat(
+        "Frame memory: %lluKB, peak %lluKB / %lluKB",
+        (unsigned long long)frameAllocatorStats.highWaterMark / 1000,
+        (unsigned long long)frameAllocatorStats.peak / 1000,
+        (unsigned long long)frameAllocatorStats.capacity / 1000
+      );
 
-      float objectAllocationTotalInMegabytes = float(objectAllocationTotalInBytes) / 1000000.f;
+      const Vec3f TEXT_COLOR = Vec3f(1.f);
+      const Vec4f BACKGROUND_COLOR = Vec4f(0.5f, 0, 0, 0.5f);
 
-      auto resolutionLabel = "Resolution: " + String(resolution.width) + " x " + String(resolution.height);
-      auto vertsLabel = "Verts: " + String(sceneStats.verts);
-      auto trisLabel = "Tris: " + String(sceneStats.tris);
-      auto totalLightsLabel = "Lights: " + String(sceneStats.totalLights);
-      auto totalMeshesLabel = "Meshes: " + String(sceneStats.totalMeshes);
-      auto totalDrawCallsLabel = "Draw calls: " + String(renderStats.totalDrawCalls);
-      auto objectAllocationLabel = "Object Allocation: " + Gm_ToDebugString(objectAllocationTotalInMegabytes) + "MB";
-      auto gpuMemoryLabel = "GPU Memory: " + String(renderStats.gpuMemoryUsed) + "MB / " + String(renderStats.gpuMemoryTotal) + "MB";
+      renderer.renderText(font_sm, fpsLabel, 25, 25, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, frameTimeLabel, 25, 50, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, resolutionLabel, 25, 75, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, vertsLabel, 25, 100, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, trisLabel, 25, 125, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, totalLightsLabel, 25, 150, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, totalMeshesLabel, 25, 175, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, totalDrawCallsLabel, 25, 200, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, trackedMemoryLabel, 25, 225, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, gpuMemoryLabel, 25, 250, TEXT_COLOR, BACKGROUND_COLOR);
+      renderer.renderText(font_sm, frameMemoryLabel, 25, 275, TEXT_COLOR, BACKGROUND_COLOR);
+    }
 
+    // Render memory usage by category
+    {
       const Vec3f TEXT_COLOR = Vec3f(1.f);
-      const Vec4f BACKGROUND_COLOR = Vec4f(0.5f, 0, 0, 0.5f);
+      const Vec4f BACKGROUND_COLOR = Vec4f(0, 0, 0.5f, 0.5f);
+
+      for (u32 i = 0; i < MEMORY_TOTAL_CATEGORIES; i++) {
+        auto& stats = Gm_GetMemoryStats((MemoryCategory)i);
+
+        auto* label = Gm_FrameFormat(
+          "%s: %.1fMB (peak %.1fMB, %.2fMB/s)",
+          stats.name,
+          float(stats.live) / 1000000.f,
+          float(stats.peak) / 1000000.f,
+          stats.allocationRate / 1000000.f
+        );
 
-      renderer.renderText(font_sm, fpsLabel.c_str(), 25, 25, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, frameTimeLabel.c_str(), 25, 50, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, resolutionLabel.c_str(), 25, 75, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, vertsLabel.c_str(), 25, 100, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, trisLabel.c_str(), 25, 125, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, totalLightsLabel.c_str(), 25, 150, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, totalMeshesLabel.c_str(), 25, 175, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, totalDrawCallsLabel.c_str(), 25, 200, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, objectAllocationLabel.c_str(), 25, 225, TEXT_COLOR, BACKGROUND_COLOR);
-      renderer.renderText(font_sm, gpuMemoryLabel.c_str(), 25, 250, TEXT_COLOR, BACKGROUND_COLOR);
+        renderer.renderText(font_sm, label, 25, 325 + i * 25, TEXT_COLOR, BACKGROUND_COLOR);
+      }
     }
 
     // Render user-defined debug messages
@@ -98,7 +106,7 @@ static void Gm_DisplayDevtools(GmContext* context) {
       u8 index = 0;
 
       for (auto& message : context->debugMessages) {
-        renderer.renderText(font_sm, message.c_str(), 25, 300 + index++ * 25, TEXT_COLOR, BACKGROUND_COLOR);
+        renderer.renderText(font_sm, message.c_str(), 25, 550 + index++ * 25, TEXT_COLOR, BACKGROUND_COLOR);
       }
     }
 
@@ -107,16 +115,15 @@ static void Gm_DisplayDevtools(GmContext* context) {
       renderer.renderSurface(consoleOuterFrame, 25, window.size.height - 155, consoleOuterFrame->w, consoleOuterFrame->h, Vec3f(1.f), Vec4f(0.f));
       renderer.renderSurface(consoleInnerFrame, 30, window.size.height - 150, consoleInnerFrame->w, consoleInnerFrame->h, Vec3f(1.f), Vec4f(0.f));
 
-      auto* message = Console::getFirstMessage();
-      u8 messageIndex = 0;
+      ConsoleMessage messages[5];
+      u32 totalMessages = Console::getMessages(messages, 5);
 
       // @todo clear messages after a set duration
-      while (message != nullptr) {
-        auto color = message->warning ? Vec3f(0.8f, 0, 0) : Vec3f(1.f);
-
-        renderer.renderText(font_sm, message->text.c_str(), 35, window.size.height - 150 + (messageIndex++) * 25, color);
+      for (u32 i = 0; i < totalMessages; i++) {
+        auto& message = messages[i];
+        auto color = message.level == ConsoleLevel::CONSOLE_LOG ? Vec3f(1.f) : Vec3f(0.8f, 0, 0);
 
-        message = message->next;
+        renderer.renderText(font_sm, message.text, 35, window.size.height - 150 + i * 25, color);
       }
     }
   }
@@ -148,10 +155,16 @@ static void Gm_DisplayDevtools(GmContext* context) {
 GmContext* Gm_CreateContext() {
   auto* context = new GmContext();
 
+  #if GAMMA_DEVELOPER_MODE
+    Console::setLogFile("./console.log");
+  #endif
+
   SDL_Init(SDL_INIT_EVERYTHING);
   TTF_Init();
   IMG_Init(IMG_INIT_PNG);
 
+  Gm_InitFrameAllocator();
+
   SDL_GameControllerAddMappingsFromFile("./controllers.txt");
   SDL_GameControllerOpen(0);
 
@@ -247,11 +260,15 @@ void Gm_HandleFrameStart(GmContext* context) {
     #endif
   }
 
-  if (context->lastTick - context->lastWatchedFilesCheckTime > 1000) {
-    Gm_HandleWatchedFiles();
+  // Dispatch events queued from other threads since the last frame
+  context->scene.input.dispatchQueuedEvents();
 
-    context->lastWatchedFilesCheckTime = context->lastTick;
-  }
+  #if GAMMA_DEVELOPER_MODE
+    context->commander.dispatchQueuedEvents();
+    context->commander.input.dispatchQueuedEvents();
+  #endif
+
+  Gm_HandleWatchedFiles();
 }
 
 void Gm_RenderScene(GmContext* context) {
@@ -286,17 +303,26 @@ void Gm_HandleFrameEnd(GmContext* context) {
 
   context->scene.frame++;
   context->scene.input.resetPerFrameState();
-  context->scene.ui.surfaces.clear();
-  context->scene.ui.texts.clear();
+  // Clearing frame vectors would keep their storage, which
+  // is reclaimed by the frame allocator reset below
+  context->scene.ui.surfaces = FrameVector<RenderSurface>();
+  context->scene.ui.texts = FrameVector<RenderText>();
 
   context->debugMessages.clear();
 
+  // Transient per-frame data must be cleared before this point
+  Gm_ResetFrameAllocator();
+  Gm_UpdateMemoryStats();
+
   Gm_SavePreviousFlags();
 }
 
 void Gm_DestroyContext(GmContext* context) {
   // @todo clear scene
 
+  Gm_StopWatchingFiles();
+  Console::shutdown();
+
   IMG_Quit();
 
   TTF_CloseFont(context->window.font_sm);
@@ -4,6 +4,7 @@
 #include "performance/tools.h"
 #include "system/AbstractRenderer.h"
 #include "system/Commander.h"
+#include "system/frame_allocator.h"
 #include "system/lights_objects_meshes.h"
 #include "system/macros.h"
 #include "system/scene.h"
@@ -26,12 +27,11 @@ struct GmContext {
   u32 lastTick = 0;
   u64 frameStartMicroseconds = 0;
   float contextTime = 0.f;
-  u32 lastWatchedFilesCheckTime = 0;
   // @todo debug-mode only
   Gamma::Averager<5, u32> fpsAverager;
   Gamma::Averager<5, u64> frameTimeAverager;
   Gamma::Commander commander;
-  std::vector<std::string> debugMessages;
+  std::vector<Gamma::FrameString> debugMessages;
 
   struct GmWindow {
     bool closed = false;
@@ -1,34 +1,356 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #define NOGDI
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+  #include <poll.h>
+  #include <sys/inotify.h>
+#endif
+
 #include "system/assert.h"
 #include "system/console.h"
 #include "system/file.h"
 #include "system/string_helpers.h"
 
+/**
+ * How long a watched file must go without further changes
+ * before its change is delivered, so that a single save
+ * (which may involve several writes) only triggers one
+ * handler call
+ */
+#define FILE_CHANGE_DEBOUNCE_MS 100
+
 namespace Gamma {
   struct FileWatcher {
     std::filesystem::path absolutePath;
-    std::filesystem::file_time_type lastWriteTime;
     std::function<void()> handler;
   };
 
+  /**
+   * State for a watched file on the file watching thread.
+   * 'id' is the index of the file's FileWatcher.
+   */
+  struct WatchedFile {
+    u32 id;
+    std::filesystem::path absolutePath;
+    std::filesystem::file_time_type lastWriteTime;
+    // The time of the most recent undelivered change,
+    // or 0 if there isn't one
+    u64 lastChangeTime = 0;
+  };
+
+  // Main thread state
   static std::vector<FileWatcher> fileWatchers;
+  static std::vector<u32> handledFileChanges;
+
+  // State shared with the file watching thread
+  static std::mutex fileWatchMutex;
+  static std::vector<WatchedFile> pendingWatchedFiles;
+  static std::vector<u32> fileChanges;
+  static std::atomic<bool> isFileWatchThreadRunning = false;
+  static std::thread* fileWatchThread = nullptr;
+
+  static u64 getMilliseconds() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static std::filesystem::file_time_type getLastWriteTime(const std::filesystem::path& path) {
+    std::error_code error;
+    auto lastWriteTime = std::filesystem::last_write_time(path, error);
+
+    return error ? std::filesystem::file_time_type::min() : lastWriteTime;
+  }
+
+  /**
+   * Moves newly watched files onto the file watching thread,
+   * returning the number of files added.
+   */
+  static u32 takePendingWatchedFiles(std::vector<WatchedFile>& watchedFiles) {
+    std::scoped_lock lock(fileWatchMutex);
+    u32 total = (u32)pendingWatchedFiles.size();
+
+    watchedFiles.insert(watchedFiles.end(), pendingWatchedFiles.begin(), pendingWatchedFiles.end());
+    pendingWatchedFiles.clear();
+
+    return total;
+  }
+
+  /**
+   * Queues changes to any watched files which haven't
+   * changed again within the debounce window. A file which
+   * is already queued, but hasn't been handled on the main
+   * thread yet, isn't queued again.
+   */
+  static void queueDebouncedFileChanges(std::vector<WatchedFile>& watchedFiles) {
+    u64 now = getMilliseconds();
+
+    for (auto& watchedFile : watchedFiles) {
+      if (watchedFile.lastChangeTime != 0 && now - watchedFile.lastChangeTime >= FILE_CHANGE_DEBOUNCE_MS) {
+        std::scoped_lock lock(fileWatchMutex);
+
+        if (std::find(fileChanges.begin(), fileChanges.end(), watchedFile.id) == fileChanges.end()) {
+          fileChanges.push_back(watchedFile.id);
+        }
+
+        watchedFile.lastChangeTime = 0;
+      }
+    }
+  }
+
+  #if defined(__linux__)
+    /**
+     * Watches files using inotify. The parent directory of
+     * each file is watched rather than the file itself, since
+     * many editors save by replacing files, which would end
+     * a watch on the original file.
+     */
+    static void watchFiles() {
+      int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      std::vector<WatchedFile> watchedFiles;
+      std::map<int, std::filesystem::path> watchedDirectories;
+      alignas(inotify_event) char buffer[4096];
+
+      if (fd == -1) {
+        Console::warn("[Gamma] Failed to initialize inotify; watched files will not be reloaded");
+
+        return;
+      }
+
+      while (isFileWatchThreadRunning) {
+        u32 totalNewFiles = takePendingWatchedFiles(watchedFiles);
 
+        for (u32 i = watchedFiles.size() - totalNewFiles; i < watchedFiles.size(); i++) {
+          auto directory = watchedFiles[i].absolutePath.parent_path();
+          int wd = inotify_add_watch(fd, directory.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+          if (wd != -1) {
+            watchedDirectories[wd] = directory;
+          }
+        }
+
+        pollfd pfd = { fd, POLLIN, 0 };
+
+        if (poll(&pfd, 1, 50) > 0) {
+          ssize_t length;
+
+          while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            u64 now = getMilliseconds();
+
+            for (char* b = buffer; b < buffer + length; b += sizeof(inotify_event) + ((inotify_event*)b)->len) {
+              auto* event = (inotify_event*)b;
+
+              if (event->len == 0 || watchedDirectories.find(event->wd) == watchedDirectories.end()) {
+                continue;
+              }
+
+              auto path = watchedDirectories[event->wd] / event->name;
+
+              for (auto& watchedFile : watchedFiles) {
+                if (watchedFile.absolutePath == path) {
+                  watchedFile.lastChangeTime = now;
+                }
+              }
+            }
+          }
+        }
+
+        queueDebouncedFileChanges(watchedFiles);
+      }
+
+      close(fd);
+    }
+  #else
+    /**
+     * Watches files by periodically checking their last write
+     * times, off the main thread.
+     *
+     * @todo use ReadDirectoryChangesW on Windows
+     */
+    static void watchFiles() {
+      std::vector<WatchedFile> watchedFiles;
+
+      while (isFileWatchThreadRunning) {
+        takePendingWatchedFiles(watchedFiles);
+
+        u64 now = getMilliseconds();
+
+        for (auto& watchedFile : watchedFiles) {
+          auto lastWriteTime = getLastWriteTime(watchedFile.absolutePath);
+
+          if (lastWriteTime != watchedFile.lastWriteTime) {
+            watchedFile.lastWriteTime = lastWriteTime;
+            watchedFile.lastChangeTime = now;
+          }
+        }
+
+        queueDebouncedFileChanges(watchedFiles);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+      }
+    }
+  #endif
+
+  /**
+   * Maps a file into memory, returning nullptr if the file
+   * couldn't be mapped. Files are unmapped with unmapFile().
+   */
+  static const char* mapFile(const std::string& path, u64& size) {
+    #if defined(_WIN32)
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      LARGE_INTEGER fileSize;
+
+      if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+      }
+
+      if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+
+        return nullptr;
+      }
+
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      const char* data = nullptr;
+
+      if (mapping != nullptr) {
+        data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        // The view keeps the mapping open once created
+        CloseHandle(mapping);
+      }
+
+      CloseHandle(file);
+
+      size = fileSize.QuadPart;
+
+      return data;
+    #else
+      int fd = open(path.c_str(), O_RDONLY);
+      struct stat fileStat;
+
+      if (fd == -1) {
+        return nullptr;
+      }
+
+      if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+
+        return nullptr;
+      }
+
+      void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      // The mapping remains valid once the file is closed
+      close(fd);
+
+      size = fileStat.st_size;
+
+      return data == MAP_FAILED ? nullptr : (const char*)data;
+    #endif
+  }
+
+  static void unmapFile(const char* data, u64 size) {
+    #if defined(_WIN32)
+      UnmapViewOfFile(data);
+    #else
+      munmap((void*)data, size);
+    #endif
+  }
+
+  /**
+   * Gm_MapFile
+   * ----------
+   *
+   * Opens a file for reading without copying its contents,
+   * falling back to a single read if the file can't be
+   * mapped. Returns false if the file couldn't be read.
+   */
+  bool Gm_MapFile(const std::string& path, FileBuffer& buffer) {
+    buffer = FileBuffer();
+    buffer.data = mapFile(path, buffer.size);
+
+    if (buffer.data != nullptr) {
+      buffer.isMapped = true;
+
+      return true;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (file.fail()) {
+      return false;
+    }
+
+    buffer.size = (u64)file.tellg();
+
+    if (buffer.size > 0) {
+      auto* data = new char[buffer.size];
+
+      file.seekg(0);
+      file.read(data, buffer.size);
+
+      buffer.data = data;
+    }
+
+    return true;
+  }
+
+  void Gm_UnmapFile(FileBuffer& buffer) {
+    if (buffer.isMapped) {
+      unmapFile(buffer.data, buffer.size);
+    } else {
+      delete[] buffer.data;
+    }
+
+    buffer = FileBuffer();
+  }
+
+  /**
+   * Gm_LoadFileContents
+   * -------------------
+   *
+   * Reads a file into a string in a single pass, normalizing
+   * line endings to '\n' and ensuring the contents end with
+   * a newline.
+   */
   std::string Gm_LoadFileContents(const std::string& path) {
+    FileBuffer buffer;
+
+    assert(Gm_MapFile(path, buffer), "[Gamma] Gm_LoadFileContents failed to load file: " + std::string(path));
+
     std::string source;
-    std::ifstream file(path);
 
-    assert(!file.fail(), "[Gamma] Gm_LoadFileContents failed to load file: " + std::string(path));
+    source.reserve(buffer.size + 1);
 
-    std::string line;
+    for (u64 i = 0; i < buffer.size; i++) {
+      if (buffer.data[i] != '\r') {
+        source.push_back(buffer.data[i]);
+      }
+    }
 
-    while (std::getline(file, line)) {
-      source.append(line + "\n");
+    if (source.size() > 0 && source.back() != '\n') {
+      source.push_back('\n');
     }
 
-    file.close();
+    Gm_UnmapFile(buffer);
 
     return source;
   }
@@ -50,26 +372,82 @@ namespace Gamma {
     file.flush();
   }
 
-  // @todo warn if file is not found
+  /**
+   * Gm_WatchFile
+   * ------------
+   *
+   * Calls a handler on the main thread whenever a file changes.
+   * Files are watched on a background thread, and changes are
+   * delivered by Gm_HandleWatchedFiles().
+   */
   void Gm_WatchFile(const std::string& path, const std::function<void()>& handler) {
     FileWatcher watcher;
+    WatchedFile watchedFile;
 
-    watcher.absolutePath = std::filesystem::current_path() / path;
+    watcher.absolutePath = (std::filesystem::current_path() / path).lexically_normal();
     watcher.handler = handler;
-    watcher.lastWriteTime = std::filesystem::last_write_time(watcher.absolutePath);
+
+    if (!std::filesystem::exists(watcher.absolutePath)) {
+      Console::warn("[Gamma] Gm_WatchFile: file not found:", path);
+    }
+
+    watchedFile.id = (u32)fileWatchers.size();
+    watchedFile.absolutePath = watcher.absolutePath;
+    watchedFile.lastWriteTime = getLastWriteTime(watcher.absolutePath);
 
     fileWatchers.push_back(watcher);
+
+    {
+      std::scoped_lock lock(fileWatchMutex);
+
+      pendingWatchedFiles.push_back(watchedFile);
+    }
+
+    if (!isFileWatchThreadRunning) {
+      isFileWatchThreadRunning = true;
+      fileWatchThread = new std::thread(watchFiles);
+    }
   }
 
+  /**
+   * Gm_HandleWatchedFiles
+   * ---------------------
+   *
+   * Calls the handlers for any watched files which changed
+   * since the last call. Cheap enough to call every frame.
+   */
   void Gm_HandleWatchedFiles() {
-    for (auto& watcher : fileWatchers) {
-      auto lastWriteTime = std::filesystem::last_write_time(watcher.absolutePath);
-
-      if (watcher.lastWriteTime != lastWriteTime) {
-        watcher.handler();
+    {
+      std::scoped_lock lock(fileWatchMutex);
 
-        watcher.lastWriteTime = lastWriteTime;
+      if (fileChanges.size() == 0) {
+        return;
       }
+
+      handledFileChanges.swap(fileChanges);
+    }
+
+    for (u32 id : handledFileChanges) {
+      // Copy the handler, since it may watch other files
+      auto handler = fileWatchers[id].handler;
+
+      handler();
+    }
+
+    handledFileChanges.clear();
+  }
+
+  void Gm_StopWatchingFiles() {
+    if (fileWatchThread == nullptr) {
+      return;
     }
+
+    isFileWatchThreadRunning = false;
+
+    fileWatchThread->join();
+
+    delete fileWatchThread;
+
+    fileWatchThread = nullptr;
   }
 }
\ No newline at end of file
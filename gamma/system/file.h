@@ -2,10 +2,34 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
+
+#include "system/type_aliases.h"
 
 namespace Gamma {
+  /**
+   * FileBuffer
+   * ----------
+   *
+   * A read-only view of a file's contents, memory-mapped where
+   * possible, and otherwise read into memory in a single read.
+   * Should be released with Gm_UnmapFile().
+   */
+  struct FileBuffer {
+    const char* data = nullptr;
+    u64 size = 0;
+    bool isMapped = false;
+
+    std::string_view view() const {
+      return std::string_view(data, (size_t)size);
+    }
+  };
+
+  bool Gm_MapFile(const std::string& path, FileBuffer& buffer);
+  void Gm_UnmapFile(FileBuffer& buffer);
   std::string Gm_LoadFileContents(const std::string& path);
   void Gm_WriteFileContents(const std::string& path, const std::string& contents);
   void Gm_WatchFile(const std::string& path, const std::function<void()>& handler);
   void Gm_HandleWatchedFiles();
+  void Gm_StopWatchingFiles();
 }
\ No newline at end of file
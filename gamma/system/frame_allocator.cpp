@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include "performance/memory.h"
+#include "system/frame_allocator.h"
+
+#define FRAME_ALLOCATOR_INITIAL_SIZE (1 << 20)
+
+namespace Gamma {
+  static u8* arena = nullptr;
+  static u64 arenaSize = 0;
+  static std::atomic<u64> arenaOffset = 0;
+  static std::mutex overflowMutex;
+  static std::vector<void*> overflowAllocations;
+  static u64 overflowBytes = 0;
+  static FrameAllocatorStats stats;
+
+  static inline u64 alignOffset(u64 offset, u64 alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+  }
+
+  /**
+   * Allocates from the heap once the arena is full. Overflow
+   * allocations are freed when the frame allocator is reset,
+   * at which point the arena grows to fit them.
+   */
+  static void* allocateOverflow(u64 size, u64 alignment) {
+    std::lock_guard<std::mutex> lock(overflowMutex);
+
+    // Over-allocate so the returned address can be aligned by
+    // hand, keeping the original pointer around to free later
+    void* allocation = std::malloc(size + alignment - 1);
+
+    overflowAllocations.push_back(allocation);
+    overflowBytes += size;
+
+    return (void*)alignOffset((u64)allocation, alignment);
+  }
+
+  /**
+   * Gm_InitFrameAllocator
+   * ---------------------
+   *
+   * Allocates the frame arena. Called once during context
+   * creation, before any threads can allocate frame memory.
+   * Until then, frame allocations fall back to the heap.
+   */
+  void Gm_InitFrameAllocator() {
+    if (arena != nullptr) {
+      return;
+    }
+
+    arenaSize = FRAME_ALLOCATOR_INITIAL_SIZE;
+    arena = (u8*)std::malloc(arenaSize);
+
+    Gm_TrackAllocation(MEMORY_UI, arenaSize);
+  }
+
+  /**
+   * Gm_FrameAllocate
+   * ----------------
+   *
+   * Allocates memory which remains valid until the end of
+   * the current frame. Safe to call from multiple threads.
+   */
+  void* Gm_FrameAllocate(u64 size, u64 alignment) {
+    u64 base = (u64)arena;
+    u64 offset = arenaOffset.load(std::memory_order_relaxed);
+    u64 start;
+
+    do {
+      // Align the address rather than the offset, since the arena
+      // itself is only guaranteed malloc() alignment
+      start = alignOffset(base + offset, alignment) - base;
+
+      if (start + size > arenaSize) {
+        // Smaller allocations may still fit in the remainder
+        // of the arena, so leave the offset where it is
+        return allocateOverflow(size, alignment);
+      }
+    } while (!arenaOffset.compare_exchange_weak(offset, start + size, std::memory_order_relaxed));
+
+    return arena + start;
+  }
+
+  /**
+   * Gm_FrameFormat
+   * --------------
+   *
+   * Formats a string into frame memory, e.g. for debug
+   * messages or UI labels which only last for one frame.
+   */
+  const char* Gm_FrameFormat(const char* format, ...) {
+    va_list args;
+    va_list argsCopy;
+
+    va_start(args, format);
+    va_copy(argsCopy, args);
+
+    s32 length = std::vsnprintf(nullptr, 0, format, args);
+    char* buffer = (char*)Gm_FrameAllocate(length > 0 ? length + 1 : 1, 1);
+
+    if (length > 0) {
+      std::vsnprintf(buffer, length + 1, format, argsCopy);
+    } else {
+      buffer[0] = '\0';
+    }
+
+    va_end(argsCopy);
+    va_end(args);
+
+    return buffer;
+  }
+
+  const FrameAllocatorStats& Gm_GetFrameAllocatorStats() {
+    stats.used = arenaOffset.load(std::memory_order_relaxed) + overflowBytes;
+    stats.capacity = arenaSize;
+
+    return stats;
+  }
+
+  /**
+   * Gm_ResetFrameAllocator
+   * ----------------------
+   *
+   * Releases all frame memory, recording the frame's total
+   * usage. If the arena overflowed, it's reallocated large
+   * enough to fit the peak usage.
+   */
+  void Gm_ResetFrameAllocator() {
+    u64 used = arenaOffset.load(std::memory_order_relaxed) + overflowBytes;
+
+    stats.highWaterMark = used;
+    stats.peak = std::max(stats.peak, used);
+    stats.overflowAllocations = (u32)overflowAllocations.size();
+
+    if (overflowAllocations.size() > 0) {
+      for (auto* allocation : overflowAllocations) {
+        std::free(allocation);
+      }
+
+      overflowAllocations.clear();
+
+      Gm_TrackFree(MEMORY_UI, arenaSize);
+
+      // Frame memory may have been requested before the arena
+      // was initialized, in which case everything overflowed
+      arenaSize = std::max(arenaSize, (u64)FRAME_ALLOCATOR_INITIAL_SIZE);
+
+      while (arenaSize < stats.peak) {
+        arenaSize *= 2;
+      }
+
+      std::free(arena);
+
+      arena = (u8*)std::malloc(arenaSize);
+
+      Gm_TrackAllocation(MEMORY_UI, arenaSize);
+    }
+
+    overflowBytes = 0;
+
+    arenaOffset.store(0, std::memory_order_relaxed);
+  }
+}
\ No newline at end of file
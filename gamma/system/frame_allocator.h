@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * FrameAllocatorStats
+   * -------------------
+   */
+  struct FrameAllocatorStats {
+    // Bytes allocated so far in the current frame
+    u64 used = 0;
+    // Bytes allocated over the course of the previous frame
+    u64 highWaterMark = 0;
+    // The most bytes allocated in any single frame
+    u64 peak = 0;
+    u64 capacity = 0;
+    // Allocations in the previous frame which didn't fit in the
+    // arena and fell back to the heap
+    u32 overflowAllocations = 0;
+  };
+
+  void Gm_InitFrameAllocator();
+  void* Gm_FrameAllocate(u64 size, u64 alignment = alignof(std::max_align_t));
+  const char* Gm_FrameFormat(const char* format, ...);
+  const FrameAllocatorStats& Gm_GetFrameAllocatorStats();
+  void Gm_ResetFrameAllocator();
+
+  /**
+   * FrameAllocator
+   * --------------
+   *
+   * A standard allocator for containers of transient data,
+   * backed by a linear arena which is reset at the end of
+   * every frame. Deallocation is a no-op, so containers using
+   * it must not outlive the frame they were created in.
+   */
+  template<typename T>
+  struct FrameAllocator {
+    typedef T value_type;
+
+    FrameAllocator() = default;
+
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+      return (T*)Gm_FrameAllocate(n * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const FrameAllocator<U>&) const {
+      return true;
+    }
+
+    template<typename U>
+    bool operator!=(const FrameAllocator<U>&) const {
+      return false;
+    }
+  };
+
+  template<typename T>
+  using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+  typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include "system/glyph_atlas.h"
+
+/**
+ * Empty pixels left between packed glyphs, so that sampling
+ * near the edge of one glyph never picks up its neighbors
+ */
+#define GLYPH_PADDING 1
+
+namespace Gamma {
+  /**
+   * Gm_GetGlyphCoverageBounds
+   * -------------------------
+   *
+   * Returns the smallest region containing every non-zero
+   * pixel of a rasterized glyph's coverage, so that empty
+   * space around the glyph isn't stored in the atlas. Returns
+   * an empty region if the glyph has no visible pixels.
+   */
+  GlyphRegion Gm_GetGlyphCoverageBounds(const u8* coverage, u16 w, u16 h) {
+    u16 minX = w;
+    u16 minY = h;
+    u16 maxX = 0;
+    u16 maxY = 0;
+
+    for (u16 y = 0; y < h; y++) {
+      for (u16 x = 0; x < w; x++) {
+        if (coverage[y * w + x] > 0) {
+          minX = std::min(minX, x);
+          minY = std::min(minY, y);
+          maxX = std::max(maxX, x);
+          maxY = std::max(maxY, y);
+        }
+      }
+    }
+
+    GlyphRegion bounds;
+
+    if (minX <= maxX && minY <= maxY) {
+      bounds.x = minX;
+      bounds.y = minY;
+      bounds.w = maxX - minX + 1;
+      bounds.h = maxY - minY + 1;
+    }
+
+    return bounds;
+  }
+
+  /**
+   * Gm_LayoutText
+   * -------------
+   *
+   * Lays out a string into glyph quads, breaking lines at
+   * newlines and wrapping words onto new lines once they
+   * exceed the wrap width. Words wider than the wrap width
+   * are broken wherever they overflow. A wrap width of 0
+   * disables wrapping.
+   *
+   * Glyphs which haven't been loaded are skipped, so any
+   * glyphs used by the string should be loaded first.
+   */
+  void Gm_LayoutText(const GlyphFont& font, const char* text, u32 wrapWidth, TextLayout& layout) {
+    auto& quads = layout.quads;
+    s32 penX = 0;
+    s32 penY = 0;
+    // The pen position and first quad of the word currently
+    // being laid out, if it was preceded by a space
+    s32 wordX = 0;
+    u32 wordQuadIndex = 0;
+
+    quads.clear();
+
+    layout.width = 0;
+    layout.totalLines = 1;
+
+    for (const char* c = text; *c != '\0'; c++) {
+      if (*c == '\n') {
+        penX = 0;
+        penY += font.lineSkip;
+        wordX = 0;
+
+        layout.totalLines++;
+
+        continue;
+      }
+
+      auto& glyph = font.glyphs[(u8)*c];
+
+      if (!glyph.isLoaded) {
+        continue;
+      }
+
+      if (*c == ' ') {
+        penX += glyph.advance;
+        wordX = penX;
+        wordQuadIndex = (u32)quads.size();
+
+        continue;
+      }
+
+      if (wrapWidth > 0 && penX > 0 && penX + glyph.advance > (s32)wrapWidth) {
+        if (wordX > 0) {
+          // Move the current word onto the next line
+          for (u32 i = wordQuadIndex; i < quads.size(); i++) {
+            quads[i].x -= wordX;
+            quads[i].y += font.lineSkip;
+          }
+
+          penX -= wordX;
+        } else {
+          // Break the word where it overflows
+          penX = 0;
+        }
+
+        penY += font.lineSkip;
+        wordX = 0;
+
+        layout.totalLines++;
+      }
+
+      if (glyph.region.w > 0 && glyph.region.h > 0) {
+        GlyphQuad quad;
+
+        quad.x = penX + glyph.offsetX;
+        quad.y = penY + glyph.offsetY;
+        quad.region = glyph.region;
+
+        quads.push_back(quad);
+      }
+
+      penX += glyph.advance;
+    }
+
+    for (auto& quad : quads) {
+      layout.width = std::max(layout.width, (u32)std::max(quad.x + quad.region.w, 0));
+    }
+
+    layout.height = font.height + (layout.totalLines - 1) * font.lineSkip;
+  }
+
+  /**
+   * Gm_PackGlyphRegion
+   * ------------------
+   *
+   * Finds space for a glyph of a given size in an atlas,
+   * returning false if the atlas is full.
+   */
+  bool Gm_PackGlyphRegion(GlyphAtlas& atlas, u16 w, u16 h, GlyphRegion& region) {
+    if (w == 0 || h == 0) {
+      region = GlyphRegion();
+
+      return true;
+    }
+
+    if (atlas.shelfX + w > atlas.width) {
+      // Start a new shelf beneath the current one
+      atlas.shelfX = 0;
+      atlas.shelfY += atlas.shelfHeight + GLYPH_PADDING;
+      atlas.shelfHeight = 0;
+    }
+
+    if (atlas.shelfX + w > atlas.width || atlas.shelfY + h > atlas.height) {
+      return false;
+    }
+
+    region.x = atlas.shelfX;
+    region.y = atlas.shelfY;
+    region.w = w;
+    region.h = h;
+
+    atlas.shelfX += w + GLYPH_PADDING;
+    atlas.shelfHeight = std::max(atlas.shelfHeight, h);
+
+    return true;
+  }
+
+  void Gm_ResetGlyphAtlas(GlyphAtlas& atlas, u16 width, u16 height) {
+    atlas.width = width;
+    atlas.height = height;
+    atlas.shelfX = 0;
+    atlas.shelfY = 0;
+    atlas.shelfHeight = 0;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * GlyphRegion
+   * -----------
+   *
+   * A rectangle of pixels, either within a glyph's rasterized
+   * image or within a glyph atlas.
+   */
+  struct GlyphRegion {
+    u16 x = 0;
+    u16 y = 0;
+    u16 w = 0;
+    u16 h = 0;
+  };
+
+  /**
+   * Glyph
+   * -----
+   *
+   * A single rasterized character, and where it was packed
+   * in a glyph atlas. Offsets are from the pen position and
+   * the top of the line to the top-left corner of the glyph.
+   * Glyphs without any visible pixels (e.g. spaces) have an
+   * empty region and only advance the pen.
+   */
+  struct Glyph {
+    GlyphRegion region;
+    s16 offsetX = 0;
+    s16 offsetY = 0;
+    s16 advance = 0;
+    bool isLoaded = false;
+  };
+
+  /**
+   * GlyphFont
+   * ---------
+   *
+   * The glyphs and line metrics of a single font at a single
+   * size, indexed by Latin-1 character code. Glyphs are loaded
+   * into the atlas as they're first used.
+   */
+  struct GlyphFont {
+    Glyph glyphs[256];
+    u16 height = 0;
+    u16 lineSkip = 0;
+  };
+
+  /**
+   * GlyphAtlas
+   * ----------
+   *
+   * Packing state for a single atlas texture. Glyphs are placed
+   * left-to-right along horizontal shelves, with a new shelf
+   * started beneath the tallest glyph in the current one once
+   * a row is full.
+   */
+  struct GlyphAtlas {
+    u16 width = 0;
+    u16 height = 0;
+    u16 shelfX = 0;
+    u16 shelfY = 0;
+    u16 shelfHeight = 0;
+  };
+
+  /**
+   * A glyph placed at a pixel position relative to the
+   * top-left corner of a block of text.
+   */
+  struct GlyphQuad {
+    s32 x = 0;
+    s32 y = 0;
+    GlyphRegion region;
+  };
+
+  struct TextLayout {
+    std::vector<GlyphQuad> quads;
+    u32 width = 0;
+    u32 height = 0;
+    u32 totalLines = 0;
+  };
+
+  GlyphRegion Gm_GetGlyphCoverageBounds(const u8* coverage, u16 w, u16 h);
+  void Gm_LayoutText(const GlyphFont& font, const char* text, u32 wrapWidth, TextLayout& layout);
+  bool Gm_PackGlyphRegion(GlyphAtlas& atlas, u16 w, u16 h, GlyphRegion& region);
+  void Gm_ResetGlyphAtlas(GlyphAtlas& atlas, u16 width, u16 height);
+}
\ No newline at end of file
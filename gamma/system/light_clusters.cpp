@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+  #define GAMMA_LIGHT_CLUSTERS_SSE 1
+  #include <emmintrin.h>
+#else
+  #define GAMMA_LIGHT_CLUSTERS_SSE 0
+#endif
+
+#include "math/constants.h"
+#include "system/light_clusters.h"
+
+namespace Gamma {
+  /**
+   * A light transformed into the cluster view space, where
+   * x is right, y is up and z is the depth in front of the
+   * camera.
+   */
+  struct ViewLight {
+    Vec3f position;
+    float radius;
+    Vec3f direction;
+    float coneCos;
+    float coneSin;
+    bool isSpot;
+  };
+
+  static inline float getSliceDepth(const LightClusterBounds& bounds, u32 slices, u32 slice) {
+    return bounds.near * powf(bounds.far / bounds.near, float(slice) / float(slices));
+  }
+
+  static inline bool hasStaleBounds(const LightClusters& clusters, float fov, float aspectRatio, float near, float far) {
+    auto& bounds = clusters.bounds;
+
+    return (
+      bounds.fov != fov ||
+      bounds.aspectRatio != aspectRatio ||
+      bounds.near != near ||
+      bounds.far != far ||
+      bounds.totalClusters != clusters.tilesX * clusters.tilesY * clusters.slices
+    );
+  }
+
+  /**
+   * Recomputes the view-space bounding boxes and spheres
+   * of each cluster. Clusters are bounded by the planes of
+   * their screen tile and by their near and far slice depths.
+   */
+  static void rebuildClusterBounds(LightClusters& clusters, float fov, float aspectRatio, float near, float far) {
+    auto& bounds = clusters.bounds;
+    u32 totalClusters = clusters.tilesX * clusters.tilesY * clusters.slices;
+    // Padded so the last clusters can be loaded four at a time
+    u32 totalPadded = totalClusters + 3;
+
+    bounds.fov = fov;
+    bounds.aspectRatio = aspectRatio;
+    bounds.near = near;
+    bounds.far = far;
+    bounds.totalClusters = totalClusters;
+
+    for (auto* values : {
+      &bounds.minX, &bounds.minY, &bounds.minZ,
+      &bounds.maxX, &bounds.maxY, &bounds.maxZ,
+      &bounds.centerX, &bounds.centerY, &bounds.centerZ,
+      &bounds.radius
+    }) {
+      values->assign(totalPadded, 0.f);
+    }
+
+    float tanY = tanf(fov / 2.f * DEGREES_TO_RADIANS);
+    float tanX = tanY * aspectRatio;
+
+    for (u32 slice = 0; slice < clusters.slices; slice++) {
+      float z1 = getSliceDepth(bounds, clusters.slices, slice);
+      float z2 = getSliceDepth(bounds, clusters.slices, slice + 1);
+
+      for (u32 tileY = 0; tileY < clusters.tilesY; tileY++) {
+        float y1 = (float(tileY) / float(clusters.tilesY) * 2.f - 1.f) * tanY;
+        float y2 = (float(tileY + 1) / float(clusters.tilesY) * 2.f - 1.f) * tanY;
+
+        for (u32 tileX = 0; tileX < clusters.tilesX; tileX++) {
+          float x1 = (float(tileX) / float(clusters.tilesX) * 2.f - 1.f) * tanX;
+          float x2 = (float(tileX + 1) / float(clusters.tilesX) * 2.f - 1.f) * tanX;
+          u32 index = Gm_GetLightClusterIndex(clusters, tileX, tileY, slice);
+
+          bounds.minX[index] = std::min(x1 * z1, x1 * z2);
+          bounds.maxX[index] = std::max(x2 * z1, x2 * z2);
+          bounds.minY[index] = std::min(y1 * z1, y1 * z2);
+          bounds.maxY[index] = std::max(y2 * z1, y2 * z2);
+          bounds.minZ[index] = z1;
+          bounds.maxZ[index] = z2;
+
+          Vec3f min = Vec3f(bounds.minX[index], bounds.minY[index], z1);
+          Vec3f max = Vec3f(bounds.maxX[index], bounds.maxY[index], z2);
+          Vec3f center = (min + max) * 0.5f;
+
+          bounds.centerX[index] = center.x;
+          bounds.centerY[index] = center.y;
+          bounds.centerZ[index] = center.z;
+          bounds.radius[index] = (max - center).magnitude();
+        }
+      }
+    }
+  }
+
+  static inline ViewLight getViewLight(const Light& light, const Matrix4f& matView) {
+    ViewLight viewLight;
+    Vec3f position = matView.transformVec3f(light.position.gl());
+
+    // View space looks down -z, whereas clusters use +z for depth
+    viewLight.position = Vec3f(position.x, position.y, -position.z);
+    viewLight.radius = light.radius;
+    viewLight.isSpot = light.type == LightType::SPOT || light.type == LightType::SPOT_SHADOWCASTER;
+
+    if (viewLight.isSpot) {
+      Vec3f origin = matView.transformVec3f(Vec3f(0.f));
+      Vec3f direction = (matView.transformVec3f(light.direction.gl()) - origin).unit();
+
+      viewLight.direction = Vec3f(direction.x, direction.y, -direction.z);
+      // Matches the cone edge used in the spot light shaders
+      viewLight.coneCos = 1.f - light.fov / 180.f;
+      viewLight.coneSin = sqrtf(std::max(0.f, 1.f - viewLight.coneCos * viewLight.coneCos));
+    }
+
+    return viewLight;
+  }
+
+  /**
+   * Tests a light against four consecutive clusters, returning
+   * a bit mask of the clusters the light may affect. Point lights
+   * are tested as spheres against cluster bounding boxes. Spot
+   * lights are additionally tested as cones against cluster
+   * bounding spheres, unless they're wide enough for the cone
+   * test to be unreliable (> 180 degrees).
+   */
+  static inline u32 testClusters4(const LightClusterBounds& bounds, u32 index, const ViewLight& light) {
+    #if GAMMA_LIGHT_CLUSTERS_SSE
+      const __m128 zero = _mm_setzero_ps();
+
+      __m128 px = _mm_set1_ps(light.position.x);
+      __m128 py = _mm_set1_ps(light.position.y);
+      __m128 pz = _mm_set1_ps(light.position.z);
+      __m128 r = _mm_set1_ps(light.radius);
+
+      __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minX[index]), px), _mm_sub_ps(px, _mm_loadu_ps(&bounds.maxX[index]))), zero);
+      __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minY[index]), py), _mm_sub_ps(py, _mm_loadu_ps(&bounds.maxY[index]))), zero);
+      __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minZ[index]), pz), _mm_sub_ps(pz, _mm_loadu_ps(&bounds.maxZ[index]))), zero);
+      __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+      __m128 result = _mm_cmple_ps(distanceSquared, _mm_mul_ps(r, r));
+
+      if (light.isSpot && light.coneCos > 0.f && _mm_movemask_ps(result) != 0) {
+        __m128 vx = _mm_sub_ps(_mm_loadu_ps(&bounds.centerX[index]), px);
+        __m128 vy = _mm_sub_ps(_mm_loadu_ps(&bounds.centerY[index]), py);
+        __m128 vz = _mm_sub_ps(_mm_loadu_ps(&bounds.centerZ[index]), pz);
+        __m128 sphereRadius = _mm_loadu_ps(&bounds.radius[index]);
+
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 alignment = _mm_add_ps(_mm_add_ps(
+          _mm_mul_ps(vx, _mm_set1_ps(light.direction.x)),
+          _mm_mul_ps(vy, _mm_set1_ps(light.direction.y))),
+          _mm_mul_ps(vz, _mm_set1_ps(light.direction.z))
+        );
+
+        __m128 perpendicular = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lengthSquared, _mm_mul_ps(alignment, alignment)), zero));
+        __m128 coneDistance = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(light.coneCos), perpendicular), _mm_mul_ps(alignment, _mm_set1_ps(light.coneSin)));
+
+        __m128 outsideAngle = _mm_cmpgt_ps(coneDistance, sphereRadius);
+        __m128 beyondRange = _mm_cmpgt_ps(alignment, _mm_add_ps(sphereRadius, r));
+        __m128 behind = _mm_cmplt_ps(alignment, _mm_sub_ps(zero, sphereRadius));
+        __m128 culled = _mm_or_ps(_mm_or_ps(outsideAngle, beyondRange), behind);
+
+        result = _mm_andnot_ps(culled, result);
+      }
+
+      return (u32)_mm_movemask_ps(result);
+    #else
+      u32 mask = 0;
+
+      for (u32 i = 0; i < 4; i++) {
+        u32 c = index + i;
+        auto& p = light.position;
+
+        float dx = std::max(std::max(bounds.minX[c] - p.x, p.x - bounds.maxX[c]), 0.f);
+        float dy = std::max(std::max(bounds.minY[c] - p.y, p.y - bounds.maxY[c]), 0.f);
+        float dz = std::max(std::max(bounds.minZ[c] - p.z, p.z - bounds.maxZ[c]), 0.f);
+
+        if (dx * dx + dy * dy + dz * dz > light.radius * light.radius) {
+          continue;
+        }
+
+        if (light.isSpot && light.coneCos > 0.f) {
+          Vec3f v = Vec3f(bounds.centerX[c], bounds.centerY[c], bounds.centerZ[c]) - p;
+          float sphereRadius = bounds.radius[c];
+          float alignment = Vec3f::dot(v, light.direction);
+          float perpendicular = sqrtf(std::max(Vec3f::dot(v, v) - alignment * alignment, 0.f));
+          float coneDistance = light.coneCos * perpendicular - alignment * light.coneSin;
+
+          if (
+            coneDistance > sphereRadius ||
+            alignment > sphereRadius + light.radius ||
+            alignment < -sphereRadius
+          ) {
+            continue;
+          }
+        }
+
+        mask |= 1 << i;
+      }
+
+      return mask;
+    #endif
+  }
+
+  static inline u32 getTile(float ndc, u32 tiles) {
+    float tile = (ndc * 0.5f + 0.5f) * float(tiles);
+
+    return (u32)std::clamp(tile, 0.f, float(tiles - 1));
+  }
+
+  /**
+   * Gm_BuildLightClusters
+   * ---------------------
+   *
+   * Bins lights into clusters for the current view. matView
+   * should be the untransposed world-to-view matrix, and fov
+   * the vertical field of view in degrees. Each light is only
+   * tested against clusters within its projected screen bounds
+   * and depth range.
+   */
+  void Gm_BuildLightClusters(LightClusters& clusters, const std::vector<Light*>& lights, const Matrix4f& matView, float fov, float aspectRatio, float near, float far) {
+    if (hasStaleBounds(clusters, fov, aspectRatio, near, far)) {
+      rebuildClusterBounds(clusters, fov, aspectRatio, near, far);
+    }
+
+    auto& bounds = clusters.bounds;
+    auto& hits = clusters.hits;
+    float tanY = tanf(fov / 2.f * DEGREES_TO_RADIANS);
+    float tanX = tanY * aspectRatio;
+
+    hits.clear();
+
+    for (u32 i = 0; i < lights.size(); i++) {
+      auto& light = *lights[i];
+
+      if (light.power == 0.f) {
+        continue;
+      }
+
+      auto viewLight = getViewLight(light, matView);
+      auto& position = viewLight.position;
+      float radius = viewLight.radius;
+      float zMin = std::max(position.z - radius, near);
+      float zMax = std::min(position.z + radius, far);
+
+      if (zMin > zMax) {
+        continue;
+      }
+
+      // Screen-space bounds of the light's bounding box
+      float xMin = std::min((position.x - radius) / zMin, (position.x - radius) / zMax) / tanX;
+      float xMax = std::max((position.x + radius) / zMin, (position.x + radius) / zMax) / tanX;
+      float yMin = std::min((position.y - radius) / zMin, (position.y - radius) / zMax) / tanY;
+      float yMax = std::max((position.y + radius) / zMin, (position.y + radius) / zMax) / tanY;
+
+      if (xMin > 1.f || xMax < -1.f || yMin > 1.f || yMax < -1.f) {
+        continue;
+      }
+
+      u32 tileX1 = getTile(xMin, clusters.tilesX);
+      u32 tileX2 = getTile(xMax, clusters.tilesX);
+      u32 tileY1 = getTile(yMin, clusters.tilesY);
+      u32 tileY2 = getTile(yMax, clusters.tilesY);
+      u32 slice1 = Gm_GetLightClusterSlice(clusters, zMin);
+      u32 slice2 = Gm_GetLightClusterSlice(clusters, zMax);
+
+      for (u32 slice = slice1; slice <= slice2; slice++) {
+        for (u32 tileY = tileY1; tileY <= tileY2; tileY++) {
+          u32 rowIndex = Gm_GetLightClusterIndex(clusters, 0, tileY, slice);
+
+          for (u32 tileX = tileX1; tileX <= tileX2; tileX += 4) {
+            u32 mask = testClusters4(bounds, rowIndex + tileX, viewLight);
+
+            for (u32 lane = 0; lane < 4 && tileX + lane <= tileX2; lane++) {
+              if (mask & (1 << lane)) {
+                hits.push_back({ rowIndex + tileX + lane, i });
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Compact the hits into per-cluster index ranges. Lights
+    // were visited in order, so each cluster's light indices
+    // end up sorted.
+    clusters.ranges.assign(bounds.totalClusters, LightClusterRange());
+    clusters.lightIndices.resize(hits.size());
+
+    for (auto& [ cluster, index ] : hits) {
+      clusters.ranges[cluster].count++;
+    }
+
+    u32 offset = 0;
+
+    for (auto& range : clusters.ranges) {
+      range.offset = offset;
+      offset += range.count;
+      range.count = 0;
+    }
+
+    for (auto& [ cluster, index ] : hits) {
+      auto& range = clusters.ranges[cluster];
+
+      clusters.lightIndices[range.offset + range.count++] = index;
+    }
+  }
+
+  u32 Gm_GetLightClusterIndex(const LightClusters& clusters, u32 tileX, u32 tileY, u32 slice) {
+    return (slice * clusters.tilesY + tileY) * clusters.tilesX + tileX;
+  }
+
+  /**
+   * Gm_GetLightClusterSlice
+   * -----------------------
+   *
+   * Returns the depth slice containing a view-space depth.
+   * Mirrored by the clustered lighting shader.
+   */
+  u32 Gm_GetLightClusterSlice(const LightClusters& clusters, float depth) {
+    auto& bounds = clusters.bounds;
+    float slice = logf(std::max(depth, bounds.near) / bounds.near) / logf(bounds.far / bounds.near) * float(clusters.slices);
+
+    return (u32)std::clamp(slice, 0.f, float(clusters.slices - 1));
+  }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "math/matrix.h"
+#include "system/lights_objects_meshes.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  struct LightClusterRange {
+    u32 offset = 0;
+    u32 count = 0;
+  };
+
+  /**
+   * LightClusterBounds
+   * ------------------
+   *
+   * View-space bounds of each cluster, stored as separate
+   * arrays so clusters can be tested four at a time. Bounds
+   * only change with the cluster grid or camera projection,
+   * and are otherwise reused between frames.
+   */
+  struct LightClusterBounds {
+    float fov = 0.f;
+    float aspectRatio = 0.f;
+    float near = 0.f;
+    float far = 0.f;
+    u32 totalClusters = 0;
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> minZ;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+    std::vector<float> maxZ;
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+  };
+
+  /**
+   * LightClusters
+   * -------------
+   *
+   * Point and spot lights binned into a view-space cluster
+   * grid, with screen-space tiles along x/y and exponentially
+   * distributed depth slices along z. Each cluster's range
+   * refers to a run of 'lightIndices', which are indices into
+   * the list of lights the clusters were built from, sorted
+   * in ascending order.
+   */
+  struct LightClusters {
+    u32 tilesX = 16;
+    u32 tilesY = 9;
+    u32 slices = 24;
+    std::vector<LightClusterRange> ranges;
+    std::vector<u32> lightIndices;
+    LightClusterBounds bounds;
+    // (cluster index, light index) pairs, reused between builds
+    std::vector<std::pair<u32, u32>> hits;
+  };
+
+  void Gm_BuildLightClusters(LightClusters& clusters, const std::vector<Light*>& lights, const Matrix4f& matView, float fov, float aspectRatio, float near, float far);
+  u32 Gm_GetLightClusterIndex(const LightClusters& clusters, u32 tileX, u32 tileY, u32 slice);
+  u32 Gm_GetLightClusterSlice(const LightClusters& clusters, float depth);
+}
@@ -8,6 +8,7 @@
 #include "system/assert.h"
 #include "system/lights_objects_meshes.h"
 #include "system/ObjLoader.h"
+#include "system/parallel.h"
 
 namespace Gamma {
   /**
@@ -381,26 +382,44 @@ namespace Gamma {
    *
    * Loads a sequence of .obj model files into a Mesh,
    * treating each consecutive model as a lower level
-   * of detail.
+   * of detail. Each model is parsed in parallel, unless
+   * already on a worker thread, and then appended to the
+   * Mesh in order.
    */
   Mesh* Mesh::Model(const std::vector<std::string>& paths) {
     if (paths.size() == 1) {
       return Mesh::Model(paths[0].c_str());
     }
 
+    struct LodData {
+      std::vector<Vertex> vertices;
+      std::vector<u32> faceElements;
+    };
+
+    std::vector<LodData> lodData(paths.size());
+
+    Gm_ParallelFor((u32)paths.size(), [&](u32 i) {
+      ObjLoader obj(paths[i].c_str());
+
+      Gm_BufferObjData(obj, lodData[i].vertices, lodData[i].faceElements);
+    });
+
     auto* mesh = new Mesh();
 
     mesh->lods.resize(paths.size());
 
     for (u32 i = 0; i < paths.size(); i++) {
-      const char* path = paths[i].c_str();
-
-      ObjLoader obj(path);
+      auto& data = lodData[i];
+      u32 baseVertex = (u32)mesh->vertices.size();
 
       mesh->lods[i].elementOffset = mesh->faceElements.size();
       mesh->lods[i].vertexOffset = mesh->vertices.size();
 
-      Gm_BufferObjData(obj, mesh->vertices, mesh->faceElements);
+      mesh->vertices.insert(mesh->vertices.end(), data.vertices.begin(), data.vertices.end());
+
+      for (auto element : data.faceElements) {
+        mesh->faceElements.push_back(baseVertex + element);
+      }
 
       mesh->lods[i].elementCount = mesh->faceElements.size() - mesh->lods[i].elementOffset;
       mesh->lods[i].vertexCount = mesh->vertices.size() - mesh->lods[i].vertexOffset;
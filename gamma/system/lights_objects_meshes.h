@@ -237,6 +237,34 @@ namespace Gamma {
     float turbulence = 1.f;
   };
 
+  /**
+   * InstanceFormat
+   * --------------
+   *
+   * Formats in which per-instance transforms can be buffered
+   * to the GPU.
+   */
+  enum InstanceFormat {
+    /**
+     * A full 4x4 model matrix per instance (64 bytes).
+     */
+    FULL_MATRIX,
+    /**
+     * A 32-bit float position and scale and a 16-bit
+     * normalized quaternion rotation per instance (32 bytes).
+     *
+     * @see pTransform
+     */
+    COMPACT_TRANSFORM,
+    /**
+     * A 32-bit float position, a 16-bit normalized quaternion
+     * rotation and a 16-bit float scale per instance (28 bytes).
+     *
+     * @see pHalfTransform
+     */
+    COMPACT_HALF_TRANSFORM
+  };
+
   /**
    * MeshAttributes
    * --------------
@@ -318,6 +346,13 @@ namespace Gamma {
      * Controls whether geometry is textured across the xy/zy planes.
      */
     bool useYPlaneTexturing = false;
+    /**
+     * Controls the format of the instance transforms buffered
+     * for the mesh's objects. Compact formats only support
+     * objects transformed by position, rotation and scale, and
+     * don't apply to particle meshes.
+     */
+    InstanceFormat instanceFormat = InstanceFormat::FULL_MATRIX;
   };
 
   /**
@@ -369,6 +404,13 @@ namespace Gamma {
      * @see MeshLod
      */
     std::vector<MeshLod> lods;
+    /**
+     * The distance between levels of detail, if set with
+     * Gm_UseLodByDistance(). Used to select levels of detail
+     * for objects rendered outside of the main view, e.g.
+     * into shadow maps.
+     */
+    float lodDistance = 0.f;
     /**
      * A collection of objects representing unique instances
      * of the mesh.
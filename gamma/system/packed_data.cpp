@@ -1,7 +1,11 @@
+#include <cmath>
+#include <cstring>
+
 #include "system/packed_data.h"
 #include "system/type_aliases.h"
 
 #define CLAMP(f) (f < 0.f ? 0.f : f > 1.f ? 1.f : f)
+#define SNORM16_MAX 32767.f
 
 namespace Gamma {
   /**
@@ -38,4 +42,205 @@ namespace Gamma {
       b / 255.f
     );
   }
+
+  static inline s16 packSnorm16(float value) {
+    value = value < -1.f ? -1.f : value > 1.f ? 1.f : value;
+
+    return s16(roundf(value * SNORM16_MAX));
+  }
+
+  static inline float unpackSnorm16(s16 value) {
+    float f = value / SNORM16_MAX;
+
+    return f < -1.f ? -1.f : f;
+  }
+
+  static void packRotation(const Quaternion& rotation, s16* packed) {
+    float magnitude = sqrtf(
+      rotation.w * rotation.w +
+      rotation.x * rotation.x +
+      rotation.y * rotation.y +
+      rotation.z * rotation.z
+    );
+
+    if (magnitude == 0.f) {
+      // Quaternion::toMatrix4f() treats a zero quaternion
+      // as the identity rotation
+      packed[0] = packed[1] = packed[2] = 0;
+      packed[3] = s16(SNORM16_MAX);
+
+      return;
+    }
+
+    packed[0] = packSnorm16(rotation.x / magnitude);
+    packed[1] = packSnorm16(rotation.y / magnitude);
+    packed[2] = packSnorm16(rotation.z / magnitude);
+    packed[3] = packSnorm16(rotation.w / magnitude);
+  }
+
+  static inline Quaternion unpackRotation(const s16* packed) {
+    return Quaternion(
+      unpackSnorm16(packed[3]),
+      unpackSnorm16(packed[0]),
+      unpackSnorm16(packed[1]),
+      unpackSnorm16(packed[2])
+    );
+  }
+
+  /**
+   * Mirrors the compact instance transform decoding in
+   * utils/instance-transform.glsl.
+   */
+  static inline Vec3f transformByCompactTransform(const Vec3f& vector, const Vec3f& position, const Quaternion& rotation, const Vec3f& scale) {
+    Vec3f q = Vec3f(rotation.x, rotation.y, rotation.z);
+    Vec3f v = vector * scale;
+    Vec3f rotated = v + Vec3f::cross(q, Vec3f::cross(q, v) + v * rotation.w) * 2.f;
+
+    return position + rotated;
+  }
+
+  /**
+   * pTransform
+   * ----------
+   */
+  pTransform::pTransform(const Vec3f& position, const Quaternion& rotation, const Vec3f& scale) {
+    this->position = position;
+    this->scale = scale;
+
+    packRotation(rotation, this->rotation);
+  }
+
+  Quaternion pTransform::getRotation() const {
+    return unpackRotation(rotation);
+  }
+
+  Vec3f pTransform::transformVec3f(const Vec3f& vector) const {
+    return transformByCompactTransform(vector, position, getRotation(), scale);
+  }
+
+  /**
+   * pHalfTransform
+   * --------------
+   */
+  pHalfTransform::pHalfTransform(const Vec3f& position, const Quaternion& rotation, const Vec3f& scale) {
+    this->position = position;
+    this->scale[0] = Gm_FloatToHalf(scale.x);
+    this->scale[1] = Gm_FloatToHalf(scale.y);
+    this->scale[2] = Gm_FloatToHalf(scale.z);
+
+    packRotation(rotation, this->rotation);
+  }
+
+  Quaternion pHalfTransform::getRotation() const {
+    return unpackRotation(rotation);
+  }
+
+  Vec3f pHalfTransform::getScale() const {
+    return Vec3f(
+      Gm_HalfToFloat(scale[0]),
+      Gm_HalfToFloat(scale[1]),
+      Gm_HalfToFloat(scale[2])
+    );
+  }
+
+  Vec3f pHalfTransform::transformVec3f(const Vec3f& vector) const {
+    return transformByCompactTransform(vector, position, getRotation(), getScale());
+  }
+
+  /**
+   * Gm_FloatToHalf
+   * --------------
+   *
+   * Converts a float to an IEEE 754 half-precision float,
+   * rounding to the nearest representable value.
+   */
+  u16 Gm_FloatToHalf(float value) {
+    u32 bits;
+
+    std::memcpy(&bits, &value, sizeof(u32));
+
+    u16 sign = u16((bits >> 16) & 0x8000);
+    s32 exponent = s32((bits >> 23) & 0xFF) - 127 + 15;
+    u32 mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+      // Infinity/NaN
+      return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);
+    }
+
+    if (exponent >= 31) {
+      // Overflow to infinity
+      return sign | 0x7C00;
+    }
+
+    if (exponent <= 0) {
+      if (exponent < -10) {
+        // Underflow to zero
+        return sign;
+      }
+
+      // Subnormal half
+      mantissa |= 0x800000;
+
+      u32 shift = u32(14 - exponent);
+      u32 half = mantissa >> shift;
+      u32 remainder = mantissa & ((1u << shift) - 1);
+      u32 midpoint = 1u << (shift - 1);
+
+      if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+        half++;
+      }
+
+      return sign | u16(half);
+    }
+
+    u32 half = (u32(exponent) << 10) | (mantissa >> 13);
+    u32 remainder = mantissa & 0x1FFF;
+
+    // Round to nearest even. Mantissa overflow carries
+    // into the exponent, which correctly rounds up to
+    // the next power of two (or infinity).
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+      half++;
+    }
+
+    return sign | u16(half);
+  }
+
+  /**
+   * Gm_HalfToFloat
+   * --------------
+   */
+  float Gm_HalfToFloat(u16 value) {
+    u32 sign = u32(value & 0x8000) << 16;
+    u32 exponent = (value >> 10) & 0x1F;
+    u32 mantissa = value & 0x3FF;
+    u32 bits;
+
+    if (exponent == 0) {
+      if (mantissa == 0) {
+        bits = sign;
+      } else {
+        // Normalize subnormal halfs
+        s32 e = -1;
+
+        do {
+          e++;
+          mantissa <<= 1;
+        } while ((mantissa & 0x400) == 0);
+
+        bits = sign | (u32(127 - 15 - e) << 23) | ((mantissa & 0x3FF) << 13);
+      }
+    } else if (exponent == 0x1F) {
+      bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+      bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float result;
+
+    std::memcpy(&result, &bits, sizeof(float));
+
+    return result;
+  }
 }
\ No newline at end of file
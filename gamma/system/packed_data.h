@@ -1,5 +1,6 @@
 #pragma once
 
+#include "math/Quaternion.h"
 #include "math/vector.h"
 #include "system/type_aliases.h"
 
@@ -26,4 +27,68 @@ namespace Gamma {
 
     Vec3f toVec3f() const;
   };
+
+  /**
+   * pTransform
+   * ----------
+   *
+   * A compact instance transform, consisting of a position,
+   * a rotation quaternion packed into four 16-bit normalized
+   * integers, and a scale. Decoded in vertex shaders as:
+   *
+   *   position + rotate(rotation, vertex * scale)
+   *
+   * which is equivalent to transforming the vertex by the
+   * model matrix the transform was packed from.
+   */
+  struct pTransform {
+    Vec3f position;
+    // x, y, z, w
+    s16 rotation[4] = { 0, 0, 0, 32767 };
+    Vec3f scale = Vec3f(1.f);
+
+    pTransform() {};
+    pTransform(const Vec3f& position, const Quaternion& rotation, const Vec3f& scale);
+
+    Quaternion getRotation() const;
+    Vec3f transformVec3f(const Vec3f& vector) const;
+  };
+
+  /**
+   * pHalfTransform
+   * --------------
+   *
+   * A pTransform with its scale stored at half precision.
+   * The fourth scale component is unused padding.
+   */
+  struct pHalfTransform {
+    Vec3f position;
+    // x, y, z, w
+    s16 rotation[4] = { 0, 0, 0, 32767 };
+    u16 scale[4] = { 0x3C00, 0x3C00, 0x3C00, 0 };
+
+    pHalfTransform() {};
+    pHalfTransform(const Vec3f& position, const Quaternion& rotation, const Vec3f& scale);
+
+    Quaternion getRotation() const;
+    Vec3f getScale() const;
+    Vec3f transformVec3f(const Vec3f& vector) const;
+  };
+
+  /**
+   * Byte offsets of the members of pTransform and pHalfTransform,
+   * for defining instance attributes. Vec3f has members in both
+   * itself and its base class, so neither struct is standard-layout
+   * and offsetof() can't be used on them.
+   */
+  constexpr size_t TRANSFORM_POSITION_OFFSET = 0;
+  constexpr size_t TRANSFORM_ROTATION_OFFSET = TRANSFORM_POSITION_OFFSET + sizeof(Vec3f);
+  constexpr size_t TRANSFORM_SCALE_OFFSET = TRANSFORM_ROTATION_OFFSET + 4 * sizeof(s16);
+
+  static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must be tightly packed");
+  static_assert(sizeof(pTransform) == TRANSFORM_SCALE_OFFSET + sizeof(Vec3f), "pTransform must be tightly packed");
+  static_assert(sizeof(pHalfTransform) == TRANSFORM_SCALE_OFFSET + 4 * sizeof(u16), "pHalfTransform must be tightly packed");
+
+  u16 Gm_FloatToHalf(float value);
+  float Gm_HalfToFloat(u16 value);
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "system/parallel.h"
+
+namespace Gamma {
+  static thread_local bool isParallelWorker = false;
+
+  /**
+   * Gm_ParallelFor
+   * --------------
+   *
+   * Calls handler(i) for each i in [0, total) across the
+   * available hardware threads, returning once all calls
+   * have completed. Calls are not guaranteed to run in any
+   * particular order, so handlers should only write to
+   * their own output slots.
+   *
+   * Nested calls made from within a handler run serially
+   * on the calling worker, rather than spawning another
+   * set of threads for each outer call.
+   */
+  void Gm_ParallelFor(u32 total, const ParallelHandler& handler) {
+    Gm_ParallelFor(total, handler, nullptr);
+  }
+
+  /**
+   * Gm_ParallelFor
+   * --------------
+   *
+   * Calls onProgress(completed, total) on the calling thread
+   * as calls complete.
+   */
+  void Gm_ParallelFor(u32 total, const ParallelHandler& handler, const ParallelProgressHandler& onProgress) {
+    if (total == 0) {
+      return;
+    }
+
+    if (isParallelWorker) {
+      for (u32 i = 0; i < total; i++) {
+        handler(i);
+
+        if (onProgress != nullptr) {
+          onProgress(i + 1, total);
+        }
+      }
+
+      return;
+    }
+
+    u32 totalWorkers = std::min(std::max(std::thread::hardware_concurrency(), 1u), total);
+    std::atomic<u32> nextIndex(0);
+    std::atomic<u32> totalCompleted(0);
+    std::vector<std::future<void>> workers;
+
+    workers.reserve(totalWorkers);
+
+    for (u32 i = 0; i < totalWorkers; i++) {
+      workers.push_back(std::async(std::launch::async, [&]() {
+        u32 index;
+
+        isParallelWorker = true;
+
+        while ((index = nextIndex++) < total) {
+          handler(index);
+
+          totalCompleted++;
+        }
+
+        // std::async() may reuse pooled threads
+        isParallelWorker = false;
+      }));
+    }
+
+    if (onProgress != nullptr) {
+      u32 lastReportedCompleted = 0;
+      bool isDone = false;
+
+      while (!isDone) {
+        isDone = true;
+
+        for (auto& worker : workers) {
+          if (worker.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+            isDone = false;
+
+            break;
+          }
+        }
+
+        u32 completed = totalCompleted;
+
+        if (completed != lastReportedCompleted) {
+          onProgress(completed, total);
+
+          lastReportedCompleted = completed;
+        }
+
+        if (!isDone) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+      }
+    }
+
+    // Rethrow any exceptions raised by a handler
+    for (auto& worker : workers) {
+      worker.get();
+    }
+  }
+}
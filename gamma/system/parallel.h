@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  typedef std::function<void(u32)> ParallelHandler;
+  typedef std::function<void(u32, u32)> ParallelProgressHandler;
+
+  void Gm_ParallelFor(u32 total, const ParallelHandler& handler);
+  void Gm_ParallelFor(u32 total, const ParallelHandler& handler, const ParallelProgressHandler& onProgress);
+}
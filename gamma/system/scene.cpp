@@ -6,7 +6,7 @@
 #include "system/console.h"
 #include "system/context.h"
 #include "system/flags.h"
-#include "system/vector_helpers.h"
+#include "system/visibility.h"
 #include "system/yaml_parser.h"
 
 using namespace Gamma;
@@ -69,13 +69,7 @@ void Gm_AddProbe(GmContext* context, const std::string& probeName, const Gamma::
 }
 
 Gamma::Light& Gm_CreateLight(GmContext* context, Gamma::LightType type) {
-  auto& lights = context->scene.lights;
-
-  lights.push_back(new Light());
-
-  auto& light = *lights.back();
-
-  light.type = type;
+  auto& light = context->scene.lights.createLight(type);
 
   if (
     type == LightType::POINT_SHADOWCASTER ||
@@ -89,27 +83,26 @@ Gamma::Light& Gm_CreateLight(GmContext* context, Gamma::LightType type) {
 }
 
 void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
-  auto& scene = Gm_ParseYamlFile(filename.c_str());
+  auto& document = Gm_ParseYamlFile(filename.c_str());
+  auto& scene = *document.root;
 
   // Load meshes
-  for (auto& [ key, property ] : *scene["meshes"].object) {
-    auto& meshConfig = *property.object;
+  for (auto& meshConfig : Gm_GetYamlProperty(scene, "meshes")) {
     u32 maxInstances = Gm_ReadYamlProperty<u32>(meshConfig, "max");
     Mesh* mesh = nullptr;
 
     if (Gm_HasYamlProperty(meshConfig, "plane")) {
       u32 size = Gm_ReadYamlProperty<u32>(meshConfig, "plane.size");
-      bool useLoopingTexture = Gm_ReadYamlProperty<u32>(meshConfig, "plane.useLoopingTexture");
+      bool useLoopingTexture = Gm_ReadYamlProperty<bool>(meshConfig, "plane.useLoopingTexture");
 
       mesh = Mesh::Plane(size, useLoopingTexture);
     } else if (Gm_HasYamlProperty(meshConfig, "cube")) {
       mesh = Mesh::Cube();
     } else if (Gm_HasYamlProperty(meshConfig, "model")) {
       std::vector<std::string> filepaths;
-      auto paths = Gm_ReadYamlProperty<YamlArray<std::string*>>(meshConfig, "model");
 
-      for (auto* path : paths) {
-        filepaths.push_back(*path);
+      for (auto& path : Gm_GetYamlProperty(meshConfig, "model")) {
+        filepaths.push_back(Gm_ReadYamlValue<std::string>(path));
       }
 
       mesh = Mesh::Model(filepaths);
@@ -129,7 +122,7 @@ void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
       }
 
       if (Gm_HasYamlProperty(meshConfig, "type")) {
-        std::string type = Gm_ReadYamlProperty<std::string>(meshConfig, "type");
+        auto type = Gm_ReadYamlProperty<std::string_view>(meshConfig, "type");
 
         // @todo use a map
         if (type == "REFRACTIVE") {
@@ -142,13 +135,13 @@ void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
         }
       }
 
-      Gm_AddMesh(context, key, maxInstances, mesh);
+      Gm_AddMesh(context, std::string(meshConfig.key), maxInstances, mesh);
     }
   }
 
   // @todo skybox settings, what else?
 
-  Gm_FreeYamlObject(&scene);
+  Gm_FreeYamlDocument(&document);
 }
 
 // @todo refactor with Gm_CreateObjectFrom(GmContext*, u16)
@@ -292,9 +285,33 @@ void Gm_RemoveLight(GmContext* context, Gamma::Light* light) {
     renderer->destroyShadowMap(light);
   }
 
-  Gm_VectorRemove(scene.lights, light);
+  scene.lights.removeLight(light);
+}
+
+void Gm_SetLightType(GmContext* context, Gamma::Light* light, Gamma::LightType type) {
+  auto& renderer = context->renderer;
+
+  if (light->type == type) {
+    return;
+  }
+
+  if (
+    light->type == LightType::DIRECTIONAL_SHADOWCASTER ||
+    light->type == LightType::POINT_SHADOWCASTER ||
+    light->type == LightType::SPOT_SHADOWCASTER
+  ) {
+    renderer->destroyShadowMap(light);
+  }
+
+  context->scene.lights.setType(light, type);
 
-  delete light;
+  if (
+    type == LightType::DIRECTIONAL_SHADOWCASTER ||
+    type == LightType::POINT_SHADOWCASTER ||
+    type == LightType::SPOT_SHADOWCASTER
+  ) {
+    renderer->createShadowMap(light);
+  }
 }
 
 // @incomplete (needs testing)
@@ -317,8 +334,6 @@ void Gm_ResetScene(GmContext* context) {
     ) {
       context->renderer->destroyShadowMap(light);
     }
-
-    delete light;
   }
 
   for (auto& [ name, position ] : scene.probeMap) {
@@ -326,7 +341,7 @@ void Gm_ResetScene(GmContext* context) {
   }
 
   scene.meshes.clear();
-  scene.lights.clear();
+  scene.lights.free();
   scene.meshMap.clear();
   scene.probeMap.clear();
   scene.objectStore.clear();
@@ -416,7 +431,9 @@ void Gm_UseFrustumCulling(GmContext* context, const std::initializer_list<std::s
   auto fovDivisor = 90.f + 70.f * Gm_Minf(1.f, distanceThreshold / 10000.f);
 
   for (auto& meshName : meshNames) {
-    meshMap[meshName]->objects.partitionByVisibility(context->scene.camera, distanceThreshold, fovDivisor);
+    auto& objects = meshMap[meshName]->objects;
+
+    Gm_CullObjectsByFrustum(objects, context->scene.camera, distanceThreshold, fovDivisor, objects.editVisibleIndices());
   }
 }
 
@@ -426,9 +443,12 @@ void Gm_UseDistanceCulling(GmContext* context, float distance, const std::initia
 
   for (auto& meshName : meshNames) {
     auto& objects = meshMap[meshName]->objects;
-    auto totalVisible = objects.partitionByDistance(0, distance, camera.position, true /* checkAllObjects */);
 
-    objects.setTotalVisible(totalVisible);
+    // Check all objects, rather than just the ones
+    // which were visible as of the last culling pass
+    objects.showAll();
+
+    Gm_CullObjectsByDistance(objects, camera.position, distance, objects.editVisibleIndices());
   }
 }
 
@@ -436,46 +456,38 @@ void Gm_UseDistanceAndFrustumCulling(GmContext* context, float distance, const s
   auto& meshMap = context->scene.meshMap;
   auto& camera = get_camera();
 
-  // Do frustum culling
-  for (auto& meshName : meshNames) {
-    meshMap[meshName]->objects.partitionByVisibility(context->scene.camera, 0.f, 100.f);
-  }
-
-  // Do distance culling on remaining visible instances
   for (auto& meshName : meshNames) {
     auto& objects = meshMap[meshName]->objects;
-    auto totalVisible = objects.partitionByDistance(0, distance, camera.position, false /* checkAllObjects */);
+    auto& indices = objects.editVisibleIndices();
 
-    objects.setTotalVisible(totalVisible);
+    // Do frustum culling, followed by distance
+    // culling on the remaining visible instances
+    Gm_CullObjectsByFrustum(objects, camera, 0.f, 100.f, indices);
+    Gm_CullObjectsByDistance(objects, camera.position, distance, indices);
   }
 }
 
 void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames) {
   auto& meshMap = context->scene.meshMap;
   auto& camera = get_camera();
+  std::vector<u32> lodOffsets;
 
   for (auto& meshName : meshNames) {
     auto& mesh = *meshMap[meshName];
+    auto& indices = mesh.objects.editVisibleIndices();
 
-    u32 instanceOffset = 0;
+    // Group visible objects by level of detail, and use the
+    // group boundaries as the instance ranges for each LoD
+    Gm_PartitionObjectsByLod(mesh.objects, indices, (u32)mesh.lods.size(), distance, camera.position, lodOffsets);
 
     for (u32 lodIndex = 0; lodIndex < mesh.lods.size(); lodIndex++) {
-      mesh.lods[lodIndex].instanceOffset = instanceOffset;
-
-      if (lodIndex < mesh.lods.size() - 1) {
-        // Group all objects within the distance threshold
-        // in front of those outside it, and use the pivot
-        // defining that boundary to determine our instance
-        // count for this LoD set
-        instanceOffset = (u32)mesh.objects.partitionByDistance((u16)instanceOffset, distance * float(lodIndex + 1), camera.position);
-
-        mesh.lods[lodIndex].instanceCount = instanceOffset - mesh.lods[lodIndex].instanceOffset;
-      } else {
-        // The final LoD can just use the remaining set
-        // of objects beyond the last LoD distance threshold
-        mesh.lods[lodIndex].instanceCount = (u32)mesh.objects.totalVisible() - instanceOffset;
-      }
+      mesh.lods[lodIndex].instanceOffset = lodOffsets[lodIndex];
+      mesh.lods[lodIndex].instanceCount = lodOffsets[lodIndex + 1] - lodOffsets[lodIndex];
     }
+
+    // Shadow views select levels of detail for their own
+    // casters using the same distance
+    mesh.lodDistance = distance;
   }
 }
 
@@ -483,6 +495,6 @@ void Gm_RenderImage(GmContext* context, SDL_Surface* image, u32 x, u32 y, u32 w,
   context->scene.ui.surfaces.push_back({ image, x, y, w, h });
 }
 
-void Gm_RenderText(GmContext* context, TTF_Font* font, std::string text, u32 x, u32 y) {
-  context->scene.ui.texts.push_back({ font, text, x, y });
+void Gm_RenderText(GmContext* context, TTF_Font* font, const char* text, u32 x, u32 y) {
+  context->scene.ui.texts.push_back({ font, Gamma::FrameString(text), x, y });
 }
\ No newline at end of file
@@ -8,7 +8,9 @@
 #include <vector>
 
 #include "system/camera.h"
+#include "system/frame_allocator.h"
 #include "system/InputSystem.h"
+#include "system/LightPools.h"
 #include "system/lights_objects_meshes.h"
 #include "system/Signaler.h"
 #include "system/traits.h"
@@ -44,7 +46,7 @@
 #define get_scene_time() context->scene.sceneTime
 #define time_since(time) (context->scene.sceneTime - time)
 
-#define add_debug_message(message) context->debugMessages.push_back(message)
+#define add_debug_message(message) context->debugMessages.emplace_back(message)
 
 #define copy_object_properties(a, b) \
     a.position = b.position;\
@@ -71,7 +73,7 @@ struct RenderSurface {
 
 struct RenderText {
   TTF_Font* font = nullptr;
-  std::string text;
+  Gamma::FrameString text;
   u32 x;
   u32 y;
 };
@@ -85,7 +87,7 @@ struct GmScene {
   Gamma::Camera camera;
   Gamma::InputSystem input;
   std::vector<Gamma::Mesh*> meshes;
-  std::vector<Gamma::Light*> lights;
+  Gamma::LightPools lights;
   std::map<std::string, Gamma::Mesh*> meshMap;
   std::map<std::string, Gamma::Vec3f> probeMap;
   std::map<std::string, Gamma::ObjectRecord> objectStore;
@@ -116,8 +118,8 @@ struct GmScene {
   } fx;
 
   struct GmUI {
-    std::vector<RenderSurface> surfaces;
-    std::vector<RenderText> texts;
+    Gamma::FrameVector<RenderSurface> surfaces;
+    Gamma::FrameVector<RenderText> texts;
   } ui;
 };
 
@@ -139,6 +141,7 @@ Gamma::Object* Gm_GetObjectByRecord(GmContext* context, const Gamma::ObjectRecor
 Gamma::Light& Gm_GetLight(GmContext* context, const std::string& lightName);
 void Gm_RemoveObject(GmContext* context, const Gamma::Object& object);
 void Gm_RemoveLight(GmContext* context, Gamma::Light* light);
+void Gm_SetLightType(GmContext* context, Gamma::Light* light, Gamma::LightType type);
 void Gm_ResetScene(GmContext* context);
 
 void Gm_PointCameraAt(GmContext* context, const Gamma::Object& object, bool upsideDown = false);
@@ -153,4 +156,4 @@ void Gm_UseDistanceAndFrustumCulling(GmContext* context, float distance, const s
 void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames);
 
 void Gm_RenderImage(GmContext* context, SDL_Surface* image, u32 x, u32 y, u32 w, u32 h);
-void Gm_RenderText(GmContext* context, TTF_Font* font, std::string text, u32 x, u32 y);
\ No newline at end of file
+void Gm_RenderText(GmContext* context, TTF_Font* font, const char* text, u32 x, u32 y);
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "system/shadow_casters.h"
+
+/**
+ * The number of frames a mesh's objects must remain unchanged
+ * before it's cached in directional shadow static caster layers
+ */
+#define STATIC_SHADOW_CASTER_FRAMES 60
+
+namespace Gamma {
+  static inline u32 hashFloat(u32 hash, float value) {
+    u32 bits;
+
+    std::memcpy(&bits, &value, sizeof(u32));
+
+    // FNV-1a, one 32-bit word at a time
+    return (hash ^ bits) * 16777619u;
+  }
+
+  static inline u32 hashObjectTransform(const Object& object) {
+    u32 hash = 2166136261u;
+
+    hash = hashFloat(hash, object.position.x);
+    hash = hashFloat(hash, object.position.y);
+    hash = hashFloat(hash, object.position.z);
+    hash = hashFloat(hash, object.scale.x);
+    hash = hashFloat(hash, object.scale.y);
+    hash = hashFloat(hash, object.scale.z);
+    hash = hashFloat(hash, object.rotation.w);
+    hash = hashFloat(hash, object.rotation.x);
+    hash = hashFloat(hash, object.rotation.y);
+    hash = hashFloat(hash, object.rotation.z);
+
+    return hash;
+  }
+
+  static float getMeshRadius(const Mesh& mesh) {
+    float radius = 0.f;
+
+    for (auto& vertex : mesh.vertices) {
+      radius = std::max(radius, vertex.position.magnitude());
+    }
+
+    // Meshes without CPU-side geometry are assumed to be unit-sized
+    return radius > 0.f ? radius : 1.f;
+  }
+
+  static inline float getObjectRadius(const Object& object, float meshRadius) {
+    return meshRadius * std::max({ object.scale.x, object.scale.y, object.scale.z });
+  }
+
+  /**
+   * Determines whether an object's bounding sphere can affect
+   * a light's shadow map. Spot light shadow maps only cover the
+   * area in front of the light, so objects entirely behind the
+   * light are excluded.
+   */
+  static inline bool isObjectInRange(const Object& object, float meshRadius, const Light& light, const Vec3f& lightDirection) {
+    float objectRadius = getObjectRadius(object, meshRadius);
+    Vec3f lightToObject = object.position - light.position;
+    float maxDistance = light.radius + objectRadius;
+
+    if (lightToObject.magnitude() > maxDistance) {
+      return false;
+    }
+
+    if (light.type == LightType::SPOT_SHADOWCASTER) {
+      return Vec3f::dot(lightToObject, lightDirection) >= -objectRadius;
+    }
+
+    return true;
+  }
+
+  /**
+   * Collects the indices of a mesh's objects in range of a light,
+   * and returns an order-independent checksum of their transforms,
+   * so that reordering objects (e.g. when one is removed) doesn't
+   * count as a change. Returns 0 if there are no such objects.
+   */
+  static u32 getMeshChecksum(const Mesh& mesh, float meshRadius, const Light& light, const Vec3f& lightDirection, std::vector<u16>& objectIndices) {
+    auto& objects = mesh.objects;
+    u32 sum = 0;
+    u32 total = 0;
+
+    objectIndices.clear();
+
+    for (u16 i = 0; i < objects.totalActive(); i++) {
+      auto& object = *(objects.begin() + i);
+
+      if (isObjectInRange(object, meshRadius, light, lightDirection)) {
+        sum += hashObjectTransform(object);
+        total++;
+
+        objectIndices.push_back(i);
+      }
+    }
+
+    if (total == 0) {
+      return 0;
+    }
+
+    u32 checksum = (sum ^ (total * 2654435761u)) * 16777619u;
+
+    return checksum == 0 ? 1 : checksum;
+  }
+
+  /**
+   * Determines whether a mesh's shadow can change without any
+   * changes to its objects, e.g. from per-frame vertex updates
+   * or time-based vertex animation.
+   */
+  static inline bool isAnimatedShadowCaster(const Mesh& mesh, bool usesPresetAnimations) {
+    return (
+      mesh.transformedVertices.size() > 0 ||
+      (mesh.type == MeshType::PARTICLES && mesh.particles.useGpuParticles) ||
+      (usesPresetAnimations && mesh.animation.type != PresetAnimationType::NONE)
+    );
+  }
+
+  /**
+   * Determines whether a world-space (GL) sphere overlaps the box
+   * of an orthographic light view-projection matrix. The sphere
+   * radius is scaled into clip space along each axis using the
+   * lengths of the matrix rows.
+   */
+  static inline bool isSphereInCascade(const Vec3f& center, float radius, const Matrix4f& matrix, const Vec3f& axisScales) {
+    Vec4f clip = matrix * center;
+
+    return (
+      fabsf(clip.x) <= 1.f + radius * axisScales.x &&
+      fabsf(clip.y) <= 1.f + radius * axisScales.y &&
+      fabsf(clip.z) <= 1.f + radius * axisScales.z
+    );
+  }
+
+  static void updateMeshBounds(ShadowCasterCache& cache, const Mesh& mesh) {
+    auto& objects = mesh.objects;
+    u16 index = mesh.index;
+    float meshRadius = cache.meshRadii[index];
+
+    if (objects.totalActive() == 0) {
+      cache.boundsRadii[index] = -1.f;
+
+      return;
+    }
+
+    Vec3f min = objects.begin()->position.gl();
+    Vec3f max = min;
+
+    for (u16 i = 1; i < objects.totalActive(); i++) {
+      Vec3f position = (objects.begin() + i)->position.gl();
+
+      min.x = std::min(min.x, position.x);
+      min.y = std::min(min.y, position.y);
+      min.z = std::min(min.z, position.z);
+      max.x = std::max(max.x, position.x);
+      max.y = std::max(max.y, position.y);
+      max.z = std::max(max.z, position.z);
+    }
+
+    Vec3f center = (min + max) / 2.f;
+    float radius = 0.f;
+
+    for (u16 i = 0; i < objects.totalActive(); i++) {
+      auto& object = *(objects.begin() + i);
+      float distance = (object.position.gl() - center).magnitude();
+
+      radius = std::max(radius, distance + getObjectRadius(object, meshRadius));
+    }
+
+    cache.boundsCenters[index] = center;
+    cache.boundsRadii[index] = radius;
+  }
+
+  /**
+   * Gm_GetShadowCastersInCascade
+   * ----------------------------
+   *
+   * Collects the indices of a mesh's objects which fall within
+   * a directional shadow cascade, and returns true if there are
+   * any. matLightViewProjection should be the untransposed
+   * cascade matrix.
+   */
+  bool Gm_GetShadowCastersInCascade(const ShadowCasterCache& cache, const Mesh& mesh, const Matrix4f& matLightViewProjection, std::vector<u16>& objectIndices) {
+    u16 index = mesh.index;
+
+    objectIndices.clear();
+
+    if (index >= cache.boundsRadii.size() || cache.boundsRadii[index] < 0.f) {
+      return false;
+    }
+
+    auto& m = matLightViewProjection.m;
+
+    Vec3f axisScales = Vec3f(
+      Vec3f(m[0], m[1], m[2]).magnitude(),
+      Vec3f(m[4], m[5], m[6]).magnitude(),
+      Vec3f(m[8], m[9], m[10]).magnitude()
+    );
+
+    if (!isSphereInCascade(cache.boundsCenters[index], cache.boundsRadii[index], matLightViewProjection, axisScales)) {
+      return false;
+    }
+
+    auto& objects = mesh.objects;
+    float meshRadius = cache.meshRadii[index];
+
+    for (u16 i = 0; i < objects.totalActive(); i++) {
+      auto& object = *(objects.begin() + i);
+
+      if (isSphereInCascade(object.position.gl(), getObjectRadius(object, meshRadius), matLightViewProjection, axisScales)) {
+        objectIndices.push_back(i);
+      }
+    }
+
+    return objectIndices.size() > 0;
+  }
+
+  bool Gm_IsStaticShadowCaster(const ShadowCasterCache& cache, const Mesh& mesh) {
+    return mesh.index < cache.meshIsStatic.size() && cache.meshIsStatic[mesh.index];
+  }
+
+  /**
+   * Gm_UpdateShadowCasterCache
+   * --------------------------
+   *
+   * Updates the bounds of any changed meshes, and determines
+   * which meshes are static. A mesh is static once its objects
+   * have gone unchanged for a number of frames, and it isn't
+   * animated independently of its objects.
+   */
+  void Gm_UpdateShadowCasterCache(ShadowCasterCache& cache, const std::vector<Mesh*>& meshes, u32 frame) {
+    if (cache.meshVersions.size() != meshes.size()) {
+      cache.meshVersions.assign(meshes.size(), 0);
+      cache.meshCastsShadows.assign(meshes.size(), false);
+      cache.meshIsStatic.assign(meshes.size(), false);
+      cache.lastChangedFrames.assign(meshes.size(), frame);
+      cache.meshRadii.resize(meshes.size());
+      cache.boundsCenters.resize(meshes.size());
+      cache.boundsRadii.resize(meshes.size());
+
+      for (u32 i = 0; i < meshes.size(); i++) {
+        auto& mesh = *meshes[i];
+
+        cache.meshVersions[i] = mesh.objects.version;
+        cache.meshRadii[i] = getMeshRadius(mesh);
+
+        updateMeshBounds(cache, mesh);
+      }
+
+      cache.staticGeneration++;
+    }
+
+    for (u16 i = 0; i < meshes.size(); i++) {
+      auto& mesh = *meshes[i];
+      u8 castsShadows = mesh.canCastShadows && !mesh.disabled;
+
+      if (cache.meshVersions[i] != mesh.objects.version || cache.meshCastsShadows[i] != castsShadows) {
+        cache.meshVersions[i] = mesh.objects.version;
+        cache.meshCastsShadows[i] = castsShadows;
+        cache.lastChangedFrames[i] = frame;
+
+        updateMeshBounds(cache, mesh);
+      }
+
+      u8 isStatic = (
+        castsShadows &&
+        !isAnimatedShadowCaster(mesh, true) &&
+        frame - cache.lastChangedFrames[i] >= STATIC_SHADOW_CASTER_FRAMES
+      );
+
+      if (isStatic != cache.meshIsStatic[i]) {
+        cache.meshIsStatic[i] = isStatic;
+        cache.staticGeneration++;
+      }
+    }
+  }
+
+  const std::vector<u16>& Gm_GetShadowCasterIndices(const ShadowCasterList& list, u16 meshIndex) {
+    return list.meshObjectIndices[meshIndex];
+  }
+
+  bool Gm_IsShadowCaster(const ShadowCasterList& list, u16 meshIndex) {
+    return meshIndex < list.meshChecksums.size() && list.meshChecksums[meshIndex] != 0;
+  }
+
+  /**
+   * Gm_UpdateShadowCasterList
+   * -------------------------
+   *
+   * Updates a light's list of shadowcasting meshes, and returns
+   * true if its shadow map needs to be re-rendered, either
+   * because the light itself changed or because objects within
+   * its range were added, removed or transformed.
+   */
+  bool Gm_UpdateShadowCasterList(ShadowCasterList& list, const Light& light, const std::vector<Mesh*>& meshes) {
+    Vec3f lightDirection = light.direction.unit();
+    bool hasMeshCountChanged = list.meshVersions.size() != meshes.size();
+
+    bool hasLightChanged = (
+      hasMeshCountChanged ||
+      list.lightPosition != light.position ||
+      list.lightDirection != lightDirection ||
+      list.lightRadius != light.radius ||
+      list.lightType != light.type
+    );
+
+    bool hasChanged = hasLightChanged;
+
+    if (hasMeshCountChanged) {
+      list.meshVersions.assign(meshes.size(), 0);
+      list.meshChecksums.assign(meshes.size(), 0);
+      list.meshCastsShadows.assign(meshes.size(), false);
+      list.meshObjectIndices.resize(meshes.size());
+      list.meshRadii.resize(meshes.size());
+
+      for (u32 i = 0; i < meshes.size(); i++) {
+        list.meshRadii[i] = getMeshRadius(*meshes[i]);
+      }
+    }
+
+    list.meshIndices.clear();
+
+    for (u16 i = 0; i < meshes.size(); i++) {
+      auto& mesh = *meshes[i];
+      u8 castsShadows = mesh.canCastShadows && !mesh.disabled;
+
+      if (
+        hasLightChanged ||
+        list.meshVersions[i] != mesh.objects.version ||
+        list.meshCastsShadows[i] != castsShadows
+      ) {
+        auto& objectIndices = list.meshObjectIndices[i];
+        u32 checksum = 0;
+
+        if (castsShadows) {
+          checksum = getMeshChecksum(mesh, list.meshRadii[i], light, lightDirection, objectIndices);
+        } else {
+          objectIndices.clear();
+        }
+
+        if (checksum != list.meshChecksums[i]) {
+          hasChanged = true;
+        }
+
+        list.meshVersions[i] = mesh.objects.version;
+        list.meshChecksums[i] = checksum;
+        list.meshCastsShadows[i] = castsShadows;
+      }
+
+      if (list.meshChecksums[i] != 0) {
+        list.meshIndices.push_back(i);
+
+        // Only spot light shadow maps use preset animations
+        if (isAnimatedShadowCaster(mesh, light.type == LightType::SPOT_SHADOWCASTER)) {
+          hasChanged = true;
+        }
+      }
+    }
+
+    list.lightPosition = light.position;
+    list.lightDirection = lightDirection;
+    list.lightRadius = light.radius;
+    list.lightType = light.type;
+
+    return hasChanged;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "system/lights_objects_meshes.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * ShadowCasterList
+   * ----------------
+   *
+   * The meshes and objects inside a shadowcasting point or
+   * spot light's range, along with the state used to determine
+   * when the light's shadow map has to be re-rendered.
+   *
+   * Per-mesh state is indexed by Mesh::index. A mesh is only
+   * re-checked when its object pool version changes, and only
+   * causes the shadow map to be invalidated if the transforms
+   * of its in-range objects actually changed.
+   */
+  struct ShadowCasterList {
+    // Indices of meshes with at least one object in range
+    std::vector<u16> meshIndices;
+    // Indices of each mesh's objects in range, which stay
+    // valid until the mesh's object pool version changes
+    std::vector<std::vector<u16>> meshObjectIndices;
+    std::vector<u32> meshVersions;
+    // Order-independent checksums of in-range object transforms,
+    // or 0 if a mesh has no objects in range
+    std::vector<u32> meshChecksums;
+    // Object-space bounding radii of each mesh
+    std::vector<float> meshRadii;
+    std::vector<u8> meshCastsShadows;
+    // Light state as of the last update
+    Vec3f lightPosition;
+    Vec3f lightDirection;
+    float lightRadius = 0.f;
+    u32 lightType = LightType::POINT;
+  };
+
+  /**
+   * ShadowCasterCache
+   * -----------------
+   *
+   * Per-mesh state shared by the cascades of directional light
+   * shadow maps: bounding spheres of each mesh's objects,
+   * used to cull meshes per cascade, and how recently each mesh
+   * changed, which determines whether it can be cached in each
+   * cascade's static caster layer.
+   *
+   * Per-mesh state is indexed by Mesh::index.
+   */
+  struct ShadowCasterCache {
+    std::vector<u32> meshVersions;
+    std::vector<u8> meshCastsShadows;
+    std::vector<u8> meshIsStatic;
+    std::vector<u32> lastChangedFrames;
+    // Object-space bounding radii of each mesh
+    std::vector<float> meshRadii;
+    // World-space (GL) bounding spheres of each mesh's objects,
+    // with a negative radius if there are none
+    std::vector<Vec3f> boundsCenters;
+    std::vector<float> boundsRadii;
+    // Incremented whenever a mesh starts or stops being static,
+    // invalidating any static caster layers
+    u32 staticGeneration = 0;
+  };
+
+  bool Gm_GetShadowCastersInCascade(const ShadowCasterCache& cache, const Mesh& mesh, const Matrix4f& matLightViewProjection, std::vector<u16>& objectIndices);
+  bool Gm_IsStaticShadowCaster(const ShadowCasterCache& cache, const Mesh& mesh);
+  void Gm_UpdateShadowCasterCache(ShadowCasterCache& cache, const std::vector<Mesh*>& meshes, u32 frame);
+  const std::vector<u16>& Gm_GetShadowCasterIndices(const ShadowCasterList& list, u16 meshIndex);
+  bool Gm_IsShadowCaster(const ShadowCasterList& list, u16 meshIndex);
+  bool Gm_UpdateShadowCasterList(ShadowCasterList& list, const Light& light, const std::vector<Mesh*>& meshes);
+}
\ No newline at end of file
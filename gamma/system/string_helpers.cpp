@@ -1,3 +1,5 @@
+#include <charconv>
+
 #include "system/string_helpers.h"
 #include "system/type_aliases.h"
 
@@ -85,6 +87,110 @@ bool Gm_StringContains(const std::string& str, const std::string& term) {
   return str.find(term) != std::string::npos;
 }
 
+/**
+ * Gm_NextLine
+ * -----------
+ *
+ * Takes the next line from the front of a string view without
+ * copying it, stripping any trailing carriage return. Returns
+ * false once there are no lines remaining.
+ */
+bool Gm_NextLine(std::string_view& remaining, std::string_view& line) {
+  if (remaining.size() == 0) {
+    return false;
+  }
+
+  auto end = remaining.find('\n');
+
+  if (end == std::string_view::npos) {
+    line = remaining;
+    remaining = std::string_view();
+  } else {
+    line = remaining.substr(0, end);
+    remaining.remove_prefix(end + 1);
+  }
+
+  if (line.size() > 0 && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+
+  return true;
+}
+
+/**
+ * Gm_SplitFields
+ * --------------
+ *
+ * Splits a string into up to maxFields views based on a
+ * delimiter, without allocating, and returns the number of
+ * fields. Any fields beyond maxFields are ignored.
+ */
+u32 Gm_SplitFields(std::string_view str, char delimiter, std::string_view* fields, u32 maxFields) {
+  u32 total = 0;
+  u32 offset = 0;
+
+  while (total < maxFields) {
+    auto found = str.find(delimiter, offset);
+
+    if (found == std::string_view::npos) {
+      fields[total++] = str.substr(offset);
+
+      break;
+    }
+
+    fields[total++] = str.substr(offset, found - offset);
+    offset = (u32)found + 1;
+  }
+
+  return total;
+}
+
+static std::string_view trimNumber(std::string_view str) {
+  while (str.size() > 0 && (str[0] == ' ' || str[0] == '\t' || str[0] == '+')) {
+    str.remove_prefix(1);
+  }
+
+  while (str.size() > 0 && (str.back() == ' ' || str.back() == '\t')) {
+    str.remove_suffix(1);
+  }
+
+  return str;
+}
+
+/**
+ * Gm_ParseFloat
+ * -------------
+ *
+ * Parses a float from a string view without allocating.
+ * Returns 0 if the string isn't a valid number.
+ */
+float Gm_ParseFloat(std::string_view str) {
+  str = trimNumber(str);
+
+  float value = 0.f;
+
+  std::from_chars(str.data(), str.data() + str.size(), value);
+
+  return value;
+}
+
+/**
+ * Gm_ParseInt
+ * -----------
+ *
+ * Parses an integer from a string view without allocating.
+ * Returns 0 if the string isn't a valid integer.
+ */
+s32 Gm_ParseInt(std::string_view str) {
+  str = trimNumber(str);
+
+  s32 value = 0;
+
+  std::from_chars(str.data(), str.data() + str.size(), value);
+
+  return value;
+}
+
 std::string Gm_Serialize(const Vec3f& v) {
   return std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z);
 }
@@ -115,8 +221,10 @@ std::string Gm_ToDebugString(const Quaternion& q) {
   return "{ w: "+ Gm_ToDebugString(q.w) + ", x: " + Gm_ToDebugString(q.x) + ", y: " + Gm_ToDebugString(q.y) + ", z: " + Gm_ToDebugString(q.z) + " }";
 }
 
-Gamma::Vec3f Gm_ParseVec3f(const std::string& str) {
-  auto parts = Gm_SplitString(str, ",");
+Gamma::Vec3f Gm_ParseVec3f(std::string_view str) {
+  std::string_view parts[3];
+
+  Gm_SplitFields(str, ',', parts, 3);
 
-  return Vec3f(stof(parts[0]), stof(parts[1]), stof(parts[2]));
+  return Vec3f(Gm_ParseFloat(parts[0]), Gm_ParseFloat(parts[1]), Gm_ParseFloat(parts[2]));
 }
\ No newline at end of file
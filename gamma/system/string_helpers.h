@@ -1,11 +1,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "math/vector.h"
 #include "math/Quaternion.h"
 #include "system/packed_data.h"
+#include "system/type_aliases.h"
 
 std::vector<std::string> Gm_SplitString(const std::string& str, const std::string& delimiter);
 std::string Gm_JoinString(const std::vector<std::string>& segments, const std::string& delimiter);
@@ -13,6 +15,11 @@ std::string Gm_TrimString(const std::string& str);
 bool Gm_StringStartsWith(const std::string& str, const std::string& start);
 bool Gm_StringContains(const std::string& str, const std::string& term);
 
+bool Gm_NextLine(std::string_view& remaining, std::string_view& line);
+u32 Gm_SplitFields(std::string_view str, char delimiter, std::string_view* fields, u32 maxFields);
+float Gm_ParseFloat(std::string_view str);
+s32 Gm_ParseInt(std::string_view str);
+
 std::string Gm_Serialize(const Gamma::Vec3f& v);
 std::string Gm_Serialize(const Gamma::Quaternion& q);
 std::string Gm_Serialize(const Gamma::pVec4& p);
@@ -21,4 +28,4 @@ std::string Gm_ToDebugString(float v);
 std::string Gm_ToDebugString(const Gamma::Vec3f& v);
 std::string Gm_ToDebugString(const Gamma::Quaternion& q);
 
-Gamma::Vec3f Gm_ParseVec3f(const std::string& str);
\ No newline at end of file
+Gamma::Vec3f Gm_ParseVec3f(std::string_view str);
\ No newline at end of file
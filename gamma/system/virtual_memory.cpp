@@ -0,0 +1,79 @@
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #define NOGDI
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include "system/assert.h"
+#include "system/virtual_memory.h"
+
+namespace Gamma {
+  /**
+   * Gm_CommitMemory
+   * ---------------
+   *
+   * Backs a page-aligned range of reserved address space
+   * with zero-initialized memory.
+   */
+  void Gm_CommitMemory(void* address, u64 size) {
+    #if defined(_WIN32)
+      bool committed = VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+    #else
+      bool committed = mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+    #endif
+
+    if (!committed) {
+      assert(false, "[Gamma] Failed to commit " + std::to_string(size) + " bytes of memory");
+    }
+  }
+
+  u64 Gm_GetPageSize() {
+    #if defined(_WIN32)
+      SYSTEM_INFO info;
+
+      GetSystemInfo(&info);
+
+      return info.dwPageSize;
+    #else
+      return (u64)sysconf(_SC_PAGESIZE);
+    #endif
+  }
+
+  void Gm_ReleaseMemory(void* address, u64 size) {
+    #if defined(_WIN32)
+      VirtualFree(address, 0, MEM_RELEASE);
+    #else
+      munmap(address, size);
+    #endif
+  }
+
+  /**
+   * Gm_ReserveMemory
+   * ----------------
+   *
+   * Reserves a range of address space without allocating
+   * any memory for it. Pages within the range must be
+   * committed with Gm_CommitMemory() before use.
+   */
+  void* Gm_ReserveMemory(u64 size) {
+    #if defined(_WIN32)
+      void* address = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+    #else
+      void* address = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+      if (address == MAP_FAILED) {
+        address = nullptr;
+      }
+    #endif
+
+    if (address == nullptr) {
+      assert(false, "[Gamma] Failed to reserve " + std::to_string(size) + " bytes of address space");
+    }
+
+    return address;
+  }
+}
\ No newline at end of file
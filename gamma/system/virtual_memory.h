@@ -0,0 +1,10 @@
+#pragma once
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  void Gm_CommitMemory(void* address, u64 size);
+  u64 Gm_GetPageSize();
+  void Gm_ReleaseMemory(void* address, u64 size);
+  void* Gm_ReserveMemory(u64 size);
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <algorithm>
+
+#include "system/camera.h"
+#include "system/lights_objects_meshes.h"
+#include "system/ObjectPool.h"
+#include "system/visibility.h"
+
+namespace Gamma {
+  /**
+   * Packs the transforms and copies the colors of a list of
+   * objects into contiguous arrays, as the compact transform
+   * type T. Transforms are packed straight from each object's
+   * position, rotation and scale, which Gm_Commit() keeps in
+   * sync with the object's matrix.
+   */
+  template<typename T>
+  static void gatherCompactObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<T>& transforms, std::vector<pVec4>& colors) {
+    auto* sourceObjects = objects.begin();
+    auto* sourceColors = objects.getColors();
+
+    transforms.resize(indices.size());
+    colors.resize(indices.size());
+
+    for (u32 i = 0; i < indices.size(); i++) {
+      auto& object = sourceObjects[indices[i]];
+
+      transforms[i] = T(object.position, object.rotation, object.scale);
+      colors[i] = sourceColors[indices[i]];
+    }
+  }
+
+  /**
+   * Gm_CullObjectsByDistance
+   * ------------------------
+   *
+   * Removes the indices of objects further than a given
+   * distance from a position, preserving the order of the
+   * remaining indices.
+   */
+  void Gm_CullObjectsByDistance(const ObjectPool& objects, const Vec3f& position, float distance, std::vector<u16>& indices) {
+    auto* pool = objects.begin();
+
+    auto last = std::remove_if(indices.begin(), indices.end(), [&](u16 index) {
+      return (pool[index].position - position).magnitude() > distance;
+    });
+
+    indices.erase(last, indices.end());
+  }
+
+  /**
+   * Gm_CullObjectsByFrustum
+   * -----------------------
+   *
+   * Rebuilds a list of the active objects in front of a camera,
+   * within a cone determined by the camera's field of view and
+   * fovDivisor. Objects closer than distanceThreshold are always
+   * included.
+   */
+  void Gm_CullObjectsByFrustum(const ObjectPool& objects, const Camera& camera, float distanceThreshold, float fovDivisor, std::vector<u16>& indices) {
+    const float visibilityDotThreshold = 1.f - camera.fov / fovDivisor;
+
+    auto* pool = objects.begin();
+    Vec3f cameraDirection = camera.orientation.getDirection();
+
+    indices.clear();
+
+    for (u16 i = 0; i < objects.totalActive(); i++) {
+      Vec3f cameraToObject = pool[i].position - camera.position;
+      float distance = cameraToObject.magnitude();
+      Vec3f unitCameraToObject = cameraToObject / distance;
+
+      if (Vec3f::dot(cameraDirection, unitCameraToObject) >= visibilityDotThreshold || distance < distanceThreshold) {
+        indices.push_back(i);
+      }
+    }
+  }
+
+  /**
+   * Gm_GatherObjectInstances
+   * ------------------------
+   *
+   * Copies the matrices and colors of a list of objects into
+   * contiguous arrays, in list order, for buffering to the GPU.
+   * Compact transforms are packed from the objects themselves,
+   * rather than decomposed from their matrices.
+   */
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<Matrix4f>& matrices, std::vector<pVec4>& colors) {
+    auto* sourceMatrices = objects.getMatrices();
+    auto* sourceColors = objects.getColors();
+
+    matrices.resize(indices.size());
+    colors.resize(indices.size());
+
+    for (u32 i = 0; i < indices.size(); i++) {
+      matrices[i] = sourceMatrices[indices[i]];
+      colors[i] = sourceColors[indices[i]];
+    }
+  }
+
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<pTransform>& transforms, std::vector<pVec4>& colors) {
+    gatherCompactObjectInstances(objects, indices, transforms, colors);
+  }
+
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<pHalfTransform>& transforms, std::vector<pVec4>& colors) {
+    gatherCompactObjectInstances(objects, indices, transforms, colors);
+  }
+
+  /**
+   * Gm_PartitionObjectsByDistance
+   * -----------------------------
+   *
+   * Reorders the indices from 'start' onward so that objects
+   * within a given distance of a position come first, and
+   * returns the position of the first index outside it.
+   */
+  u32 Gm_PartitionObjectsByDistance(const ObjectPool& objects, std::vector<u16>& indices, u32 start, float distance, const Vec3f& position) {
+    auto* pool = objects.begin();
+
+    auto pivot = std::partition(indices.begin() + start, indices.end(), [&](u16 index) {
+      return (pool[index].position - position).magnitude() <= distance;
+    });
+
+    return u32(pivot - indices.begin());
+  }
+
+  /**
+   * Gm_PartitionObjectsByLod
+   * ------------------------
+   *
+   * Groups indices by level of detail, nearest first. Objects
+   * within (n + 1) * distance of a position use level of detail
+   * n, and the last level of detail takes the rest. lodOffsets
+   * receives the start of each group, followed by the end of
+   * the list.
+   */
+  void Gm_PartitionObjectsByLod(const ObjectPool& objects, std::vector<u16>& indices, u32 totalLods, float distance, const Vec3f& position, std::vector<u32>& lodOffsets) {
+    lodOffsets.resize(totalLods + 1);
+    lodOffsets[0] = 0;
+
+    for (u32 i = 1; i < totalLods; i++) {
+      lodOffsets[i] = Gm_PartitionObjectsByDistance(objects, indices, lodOffsets[i - 1], distance * float(i), position);
+    }
+
+    lodOffsets[totalLods] = (u32)indices.size();
+  }
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "system/packed_data.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  class ObjectPool;
+  struct Camera;
+
+  void Gm_CullObjectsByDistance(const ObjectPool& objects, const Vec3f& position, float distance, std::vector<u16>& indices);
+  void Gm_CullObjectsByFrustum(const ObjectPool& objects, const Camera& camera, float distanceThreshold, float fovDivisor, std::vector<u16>& indices);
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<Matrix4f>& matrices, std::vector<pVec4>& colors);
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<pTransform>& transforms, std::vector<pVec4>& colors);
+  void Gm_GatherObjectInstances(const ObjectPool& objects, const std::vector<u16>& indices, std::vector<pHalfTransform>& transforms, std::vector<pVec4>& colors);
+  u32 Gm_PartitionObjectsByDistance(const ObjectPool& objects, std::vector<u16>& indices, u32 start, float distance, const Vec3f& position);
+  void Gm_PartitionObjectsByLod(const ObjectPool& objects, std::vector<u16>& indices, u32 totalLods, float distance, const Vec3f& position, std::vector<u32>& lodOffsets);
+}
\ No newline at end of file
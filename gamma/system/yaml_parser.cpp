@@ -1,136 +1,277 @@
+#include <algorithm>
+#include <charconv>
 #include <cctype>
-#include <vector>
 
 #include "system/assert.h"
 #include "system/file.h"
-#include "system/string_helpers.h"
 #include "system/yaml_parser.h"
 
 namespace Gamma {
+  struct YamlParseFrame {
+    YamlNode* node;
+    YamlNode* lastChild;
+  };
+
+  static std::string_view trim(std::string_view str) {
+    u32 start = 0;
+    u32 end = (u32)str.size();
+
+    while (start < end && std::isspace((u8)str[start])) {
+      start++;
+    }
+
+    while (end > start && std::isspace((u8)str[end - 1])) {
+      end--;
+    }
+
+    return str.substr(start, end - start);
+  }
+
+  static std::string_view trimTrailingComma(std::string_view str) {
+    if (str.size() > 0 && str.back() == ',') {
+      return trim(str.substr(0, str.size() - 1));
+    }
+
+    return str;
+  }
+
+  static bool isNumber(std::string_view str) {
+    u32 start = str.size() > 0 && (str[0] == '-' || str[0] == '+') ? 1 : 0;
+
+    return start < str.size() && (std::isdigit((u8)str[start]) || str[start] == '.');
+  }
+
   /**
-   * Gm_ParsePrimitiveValue
-   * ----------------------
-   *
-   * @todo description
+   * Parses a primitive value into a node. Quoted values are
+   * always strings, with their quotes stripped.
    */
-  static void* Gm_ParsePrimitiveValue(const std::string& str) {
-    // Check for boolean literals
-    if (str == "true") {
-      return new bool(true);
-    } else if (str == "false") {
-      return new bool(false);
+  static void parsePrimitiveValue(std::string_view str, YamlNode& node) {
+    if (str == "true" || str == "false") {
+      node.type = YAML_BOOLEAN;
+      node.boolean = str == "true";
+
+      return;
     }
 
-    // Check for numbers
-    if (std::isdigit(str[0])) {
-      // @todo use std::stof if the string contains a '.'
-      return new int(std::stoi(str));
+    if (isNumber(str)) {
+      const char* start = str.data() + (str[0] == '+' ? 1 : 0);
+      const char* end = str.data() + str.size();
+
+      if (str.find('.') == std::string_view::npos) {
+        s32 integer;
+        auto result = std::from_chars(start, end, integer);
+
+        if (result.ec == std::errc() && result.ptr == end) {
+          node.type = YAML_INTEGER;
+          node.integer = integer;
+
+          return;
+        }
+      } else {
+        float number;
+        auto result = std::from_chars(start, end, number);
+
+        if (result.ec == std::errc() && result.ptr == end) {
+          node.type = YAML_NUMBER;
+          node.number = number;
+
+          return;
+        }
+      }
+    }
+
+    if (str.size() >= 2 && (str[0] == '"' || str[0] == '\'') && str.back() == str[0]) {
+      str = str.substr(1, str.size() - 2);
     }
 
-    // Fall back to string
-    // @todo strip leading/trailing quotes
-    return new std::string(str);
+    node.type = YAML_STRING;
+    node.string = str;
+  }
+
+  static YamlNode& appendNode(YamlDocument& document, YamlParseFrame& parent) {
+    // Nodes are reserved upfront, so this never reallocates
+    // and existing node pointers remain valid
+    assert(document.nodes.size() < document.nodes.capacity(), "Malformed YAML file");
+
+    auto& node = document.nodes.emplace_back();
+
+    if (parent.lastChild == nullptr) {
+      parent.node->firstChild = &node;
+    } else {
+      parent.lastChild->next = &node;
+    }
+
+    parent.lastChild = &node;
+    parent.node->totalChildren++;
+
+    return node;
+  }
+
+  /**
+   * YamlNode
+   * --------
+   */
+  YamlNodeIterator YamlNode::begin() const {
+    return { firstChild };
+  }
+
+  YamlNodeIterator YamlNode::end() const {
+    return { nullptr };
+  }
+
+  const YamlNode& YamlNodeIterator::operator*() const {
+    return *node;
+  }
+
+  YamlNodeIterator& YamlNodeIterator::operator++() {
+    node = node->next;
+
+    return *this;
+  }
+
+  bool YamlNodeIterator::operator!=(const YamlNodeIterator& iterator) const {
+    return node != iterator.node;
   }
 
   /**
    * Gm_ParseYamlFile
    * ----------------
    */
-  YamlObject& Gm_ParseYamlFile(const char* path) {
-    std::vector<YamlObject*> objectStack;
-    std::string fileContents = Gm_LoadFileContents(path);
-    auto lines = Gm_SplitString(fileContents, "\n");
-    auto* root = new YamlObject();
+  YamlDocument& Gm_ParseYamlFile(const char* path) {
+    auto* document = new YamlDocument();
+    auto& nodes = document->nodes;
 
-    objectStack.push_back(root);
+    document->source = Gm_LoadFileContents(path);
 
-    for (u32 i = 0; i < lines.size(); i++) {
-      auto trimmedLine = Gm_TrimString(lines[i]);
+    std::string_view source = document->source;
 
-      if (trimmedLine[0] == '}') {
-        // End of object
-        objectStack.pop_back();
-      } else if (trimmedLine.find(":") != std::string::npos) {
-        // Property declaration
-        YamlProperty property;
+    // Each line declares at most one node, plus the root
+    nodes.reserve(std::count(source.begin(), source.end(), '\n') + 2);
 
-        if (trimmedLine.back() == '{') {
-          // Nested object property
-          property.object = new YamlObject();
-        } else if (trimmedLine.back() == '[') {
-          // Specialization for array leaf properties
-          auto array = new YamlArray<void*>();
-          auto incomingLine = Gm_TrimString(lines[++i]);
+    auto& root = nodes.emplace_back();
 
-          // Iterate over and parse new lines into values
-          // until we reach the end of the array
-          while (incomingLine[0] != ']') {
-            if (incomingLine.back() == ',') {
-              incomingLine = incomingLine.substr(0, incomingLine.size() - 1);
-            }
+    root.type = YAML_OBJECT;
+    document->root = &root;
 
-            // @todo strip leading/trailing quotes
+    std::vector<YamlParseFrame> stack;
+    u32 lineStart = 0;
 
-            array->push_back(Gm_ParsePrimitiveValue(incomingLine));
+    stack.push_back({ &root, nullptr });
 
-            incomingLine = Gm_TrimString(lines[++i]);
-          }
+    while (lineStart < source.size()) {
+      u32 lineEnd = (u32)std::min(source.find('\n', lineStart), source.size());
+      auto line = trim(source.substr(lineStart, lineEnd - lineStart));
 
-          property.value = array;
-        } else {
-          // Other leaf properties (strings, numbers, or booleans)
-          u32 vStart = trimmedLine.find(":") + 1;
-          u32 vLength = trimmedLine.find(",") - vStart;
-          auto value = Gm_TrimString(trimmedLine.substr(vStart, vLength));
+      lineStart = lineEnd + 1;
+
+      if (line.size() == 0) {
+        continue;
+      }
+
+      auto& parent = stack.back();
 
-          property.value = Gm_ParsePrimitiveValue(value);
+      if (parent.node->type == YAML_ARRAY) {
+        if (line[0] == ']') {
+          // End of array
+          stack.pop_back();
+        } else {
+          parsePrimitiveValue(trimTrailingComma(line), appendNode(*document, parent));
         }
+      } else if (line[0] == '}') {
+        // End of object
+        stack.pop_back();
+
+        assert(stack.size() > 0, "Malformed YAML file");
+      } else if (line.find(':') != std::string_view::npos) {
+        // Property declaration
+        u32 colon = (u32)line.find(':');
+        auto value = trimTrailingComma(trim(line.substr(colon + 1)));
+        auto& node = appendNode(*document, parent);
+
+        node.key = trim(line.substr(0, colon));
 
-        // Assign the property to the current object
-        auto propertyName = trimmedLine.substr(0, trimmedLine.find(":"));
-        auto& currentObject = *objectStack.back();
+        if (value == "{") {
+          // Nested object property
+          node.type = YAML_OBJECT;
 
-        currentObject[propertyName] = property;
+          stack.push_back({ &node, nullptr });
+        } else if (value == "[") {
+          // Array property, with one value per line
+          node.type = YAML_ARRAY;
 
-        if (property.object != nullptr) {
-          // Push nested objects onto the stack so they can
-          // represent the current object on the next cycle
-          objectStack.push_back(property.object);
+          stack.push_back({ &node, nullptr });
+        } else {
+          // Other leaf properties (strings, numbers, or booleans)
+          parsePrimitiveValue(value, node);
         }
       }
     }
 
     // Remove the root object from the stack
-    objectStack.pop_back();
+    stack.pop_back();
 
-    assert(objectStack.size() == 0, "Malformed YAML file");
+    assert(stack.size() == 0, "Malformed YAML file");
 
-    return *root;
+    return *document;
   }
 
   /**
-   * Gm_HasYamlProperty
-   * ------------------
+   * Gm_FindYamlProperty
+   * -------------------
    */
-  bool Gm_HasYamlProperty(const YamlObject& object, const std::string& property) {
-    return object.find(property) != object.end();
+  const YamlNode* Gm_FindYamlProperty(const YamlNode& object, const YamlPath& path) {
+    const YamlNode* current = &object;
+
+    for (u8 i = 0; i < path.totalSegments; i++) {
+      const YamlNode* child = current->firstChild;
+
+      while (child != nullptr && child->key != path.segments[i]) {
+        child = child->next;
+      }
+
+      if (child == nullptr) {
+        return nullptr;
+      }
+
+      current = child;
+    }
+
+    return current;
   }
 
   /**
-   * Gm_FreeYamlObject
-   * --------------------
+   * Gm_GetYamlProperty
+   * ------------------
    */
-  void Gm_FreeYamlObject(YamlObject* object) {
-    for (auto& [ key, property ] : *object) {
-      if (property.object != nullptr) {
-        Gm_FreeYamlObject(property.object);
-      } else if (property.value != nullptr) {
-        delete property.value;
+  const YamlNode& Gm_GetYamlProperty(const YamlNode& object, const YamlPath& path) {
+    auto* node = Gm_FindYamlProperty(object, path);
+
+    if (node == nullptr) {
+      std::string chain;
+
+      for (u8 i = 0; i < path.totalSegments; i++) {
+        chain += (i > 0 ? "." : "") + std::string(path.segments[i]);
       }
+
+      assert(false, "Missing YAML property: " + chain);
     }
 
-    object->clear();
+    return *node;
+  }
+
+  /**
+   * Gm_HasYamlProperty
+   * ------------------
+   */
+  bool Gm_HasYamlProperty(const YamlNode& object, const YamlPath& path) {
+    return Gm_FindYamlProperty(object, path) != nullptr;
+  }
 
-    delete object;
+  /**
+   * Gm_FreeYamlDocument
+   * -------------------
+   */
+  void Gm_FreeYamlDocument(YamlDocument* document) {
+    delete document;
   }
 }
\ No newline at end of file
@@ -1,103 +1,192 @@
 #pragma once
 
-#include <map>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
-#include "system/string_helpers.h"
+#include "system/assert.h"
 #include "system/type_aliases.h"
 
+#define YAML_PATH_MAX_SEGMENTS 8
+
 namespace Gamma {
-  struct YamlProperty;
+  enum YamlNodeType : u8 {
+    YAML_NULL,
+    YAML_BOOLEAN,
+    YAML_INTEGER,
+    YAML_NUMBER,
+    YAML_STRING,
+    YAML_ARRAY,
+    YAML_OBJECT
+  };
+
+  struct YamlNode;
+
+  struct YamlNodeIterator {
+    const YamlNode* node;
+
+    const YamlNode& operator*() const;
+    YamlNodeIterator& operator++();
+    bool operator!=(const YamlNodeIterator& iterator) const;
+  };
 
   /**
-   * YamlObject
-   * ----------
+   * YamlNode
+   * --------
+   *
+   * A single value in a parsed YAML document, tagged by type.
+   * Object and array nodes link to their first child, and
+   * children link to their next sibling. Object members also
+   * have a key. Keys and strings refer directly into the
+   * document source, and are only valid for the lifetime of
+   * the document.
    *
-   * @todo description
+   * Iterating over a node iterates over its children.
    */
-  typedef std::map<std::string, YamlProperty> YamlObject;
+  struct YamlNode {
+    YamlNodeType type = YAML_NULL;
+    std::string_view key;
+
+    union {
+      bool boolean = false;
+      s32 integer;
+      float number;
+    };
+
+    std::string_view string;
+
+    YamlNode* firstChild = nullptr;
+    YamlNode* next = nullptr;
+    u32 totalChildren = 0;
+
+    YamlNodeIterator begin() const;
+    YamlNodeIterator end() const;
+  };
 
   /**
-   * YamlArray
-   * ---------
+   * YamlDocument
+   * ------------
    *
-   * @todo description
+   * A parsed YAML file. All nodes are allocated in a single
+   * array, which is sized upfront so nodes never move once
+   * parsed.
    */
-  template<typename T>
-  struct YamlArray : std::vector<T> {
-    virtual ~YamlArray() {
-      for (auto* value : *this) {
-        delete value;
-      }
-    }
+  struct YamlDocument {
+    std::string source;
+    std::vector<YamlNode> nodes;
+    YamlNode* root = nullptr;
   };
 
   /**
-   * YamlProperty
-   * ------------
+   * YamlPath
+   * --------
    *
-   * @todo description
+   * A property chain (e.g. "plane.size") split into its
+   * segments, so repeated lookups don't need to split the
+   * chain again. Paths can be compiled as constexpr, and
+   * otherwise only refer to the original string without
+   * copying it, so should not outlive it.
    */
-  struct YamlProperty {
-    /**
-     * For leaf properties (strings, numbers,
-     * booleans, or arrays), the regular value.
-     * Remains nullptr otherwise.
-     *
-     * @todo void* is risky with respect to
-     * Gm_ReadYamlProperty's cast + dereferencing,
-     * and makes variable type determination
-     * impossible. see if we can use a lightweight
-     * wrapper struct with type information instead.
-     */
-    void* value = nullptr;
-    /**
-     * For nested object properties, a pointer
-     * to that object. Remains nullptr otherwise.
-     */
-    YamlObject* object = nullptr;
+  struct YamlPath {
+    std::string_view segments[YAML_PATH_MAX_SEGMENTS] = {};
+    u8 totalSegments = 0;
+
+    constexpr YamlPath(const char* propertyChain) {
+      std::string_view chain = propertyChain;
+      u32 start = 0;
+
+      for (u32 i = 0; i <= chain.size() && totalSegments < YAML_PATH_MAX_SEGMENTS; i++) {
+        if (i == chain.size() || chain[i] == '.') {
+          segments[totalSegments++] = chain.substr(start, i - start);
+          start = i + 1;
+        }
+      }
+    }
   };
 
   /**
    * Gm_ParseYamlFile
    * ----------------
    *
-   * @todo description
+   * Parses a YAML file into a document, which should be freed
+   * with Gm_FreeYamlDocument() once no longer needed.
    */
-  YamlObject& Gm_ParseYamlFile(const char* path);
+  YamlDocument& Gm_ParseYamlFile(const char* path);
 
   /**
-   * Gm_ReadYamlProperty
+   * Gm_FindYamlProperty
    * -------------------
    *
-   * @todo description
+   * Returns the node at a property path within an object,
+   * or nullptr if no such property exists.
    */
-  template<typename T>
-  T Gm_ReadYamlProperty(const YamlObject& object, const std::string& propertyChain) {
-    auto properties = Gm_SplitString(propertyChain, ".");
-    auto* currentObject = &object;
-
-    for (u32 i = 0; i < properties.size() - 1; i++) {
-      currentObject = currentObject->at(properties[i]).object;
-    }
+  const YamlNode* Gm_FindYamlProperty(const YamlNode& object, const YamlPath& path);
 
-    return *(T*)currentObject->at(properties.back()).value;
-  }
+  /**
+   * Gm_GetYamlProperty
+   * ------------------
+   *
+   * Returns the node at a property path within an object,
+   * which must exist.
+   */
+  const YamlNode& Gm_GetYamlProperty(const YamlNode& object, const YamlPath& path);
 
   /**
    * Gm_HasYamlProperty
    * ------------------
+   */
+  bool Gm_HasYamlProperty(const YamlNode& object, const YamlPath& path);
+
+  /**
+   * Gm_ReadYamlValue
+   * ----------------
    *
-   * @todo description
+   * Reads a node as a number, boolean or string. Booleans
+   * and numbers can be read as any arithmetic type.
    */
-  bool Gm_HasYamlProperty(const YamlObject& object, const std::string& property);
+  template<typename T>
+  T Gm_ReadYamlValue(const YamlNode& node) {
+    if constexpr (std::is_same_v<T, std::string>) {
+      return std::string(Gm_ReadYamlValue<std::string_view>(node));
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+      if (node.type != YAML_STRING) {
+        assert(false, "Expected YAML string property: " + std::string(node.key));
+      }
+
+      return node.string;
+    } else {
+      static_assert(std::is_arithmetic_v<T>, "YAML values can only be read as strings or arithmetic types");
+
+      switch (node.type) {
+        case YAML_BOOLEAN:
+          return (T)node.boolean;
+        case YAML_INTEGER:
+          return (T)node.integer;
+        case YAML_NUMBER:
+          return (T)node.number;
+        default:
+          assert(false, "Expected YAML number or boolean property: " + std::string(node.key));
+
+          return T();
+      }
+    }
+  }
 
   /**
-   * Gm_FreeYamlObject
-   * -----------------
+   * Gm_ReadYamlProperty
+   * -------------------
    *
-   * @todo description
+   * Reads the value at a property path within an object.
+   */
+  template<typename T>
+  T Gm_ReadYamlProperty(const YamlNode& object, const YamlPath& path) {
+    return Gm_ReadYamlValue<T>(Gm_GetYamlProperty(object, path));
+  }
+
+  /**
+   * Gm_FreeYamlDocument
+   * -------------------
    */
-  void Gm_FreeYamlObject(YamlObject* object);
+  void Gm_FreeYamlDocument(YamlDocument* document);
 }
\ No newline at end of file
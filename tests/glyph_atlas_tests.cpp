@@ -0,0 +1,266 @@
+#include "system/glyph_atlas.h"
+#include "test.h"
+
+using namespace Gamma;
+
+static bool isRegion(const GlyphRegion& region, u16 x, u16 y, u16 w, u16 h) {
+  return region.x == x && region.y == y && region.w == w && region.h == h;
+}
+
+// Every loaded glyph is 8x10 pixels, offset by (1, 2) and advancing
+// the pen by 10, except spaces, which are empty and advance by 5
+static void createFont(GlyphFont& font) {
+  font.height = 12;
+  font.lineSkip = 14;
+
+  for (char c = 'a'; c <= 'z'; c++) {
+    auto& glyph = font.glyphs[(u8)c];
+
+    glyph.region.w = 8;
+    glyph.region.h = 10;
+    glyph.offsetX = 1;
+    glyph.offsetY = 2;
+    glyph.advance = 10;
+    glyph.isLoaded = true;
+  }
+
+  font.glyphs[' '].advance = 5;
+  font.glyphs[' '].isLoaded = true;
+}
+
+TEST(Gm_PackGlyphRegion_packsGlyphsAlongAShelf) {
+  GlyphAtlas atlas;
+  GlyphRegion a;
+  GlyphRegion b;
+
+  Gm_ResetGlyphAtlas(atlas, 32, 32);
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 10, 5, a));
+  EXPECT(Gm_PackGlyphRegion(atlas, 10, 8, b));
+
+  // Glyphs are separated by a pixel of padding
+  EXPECT(isRegion(a, 0, 0, 10, 5));
+  EXPECT(isRegion(b, 11, 0, 10, 8));
+  EXPECT(atlas.shelfHeight == 8);
+}
+
+TEST(Gm_PackGlyphRegion_startsANewShelfWhenARowOverflows) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 32, 32);
+
+  Gm_PackGlyphRegion(atlas, 10, 5, region);
+  Gm_PackGlyphRegion(atlas, 10, 8, region);
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 15, 4, region));
+
+  // The new shelf starts beneath the tallest glyph in the last one
+  EXPECT(isRegion(region, 0, 9, 15, 4));
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 16, 6, region));
+  EXPECT(isRegion(region, 16, 9, 16, 6));
+}
+
+TEST(Gm_PackGlyphRegion_fitsGlyphsAtTheEdgeOfTheAtlas) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 16, 16, region));
+  EXPECT(isRegion(region, 0, 0, 16, 16));
+}
+
+TEST(Gm_PackGlyphRegion_failsOnceTheAtlasIsFull) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 16, 10, region));
+  EXPECT(!Gm_PackGlyphRegion(atlas, 8, 8, region));
+
+  // Glyphs which still fit beneath the last shelf can be packed
+  EXPECT(Gm_PackGlyphRegion(atlas, 8, 5, region));
+  EXPECT(isRegion(region, 0, 11, 8, 5));
+}
+
+TEST(Gm_PackGlyphRegion_failsForGlyphsWiderThanTheAtlas) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+
+  EXPECT(!Gm_PackGlyphRegion(atlas, 17, 4, region));
+}
+
+TEST(Gm_PackGlyphRegion_doesNotPackEmptyGlyphs) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+
+  region.w = 5;
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 0, 10, region));
+  EXPECT(isRegion(region, 0, 0, 0, 0));
+  EXPECT(atlas.shelfX == 0);
+  EXPECT(atlas.shelfHeight == 0);
+}
+
+TEST(Gm_ResetGlyphAtlas_clearsPackedGlyphs) {
+  GlyphAtlas atlas;
+  GlyphRegion region;
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+  Gm_PackGlyphRegion(atlas, 16, 16, region);
+
+  EXPECT(!Gm_PackGlyphRegion(atlas, 4, 4, region));
+
+  Gm_ResetGlyphAtlas(atlas, 16, 16);
+
+  EXPECT(Gm_PackGlyphRegion(atlas, 4, 4, region));
+  EXPECT(isRegion(region, 0, 0, 4, 4));
+}
+
+TEST(Gm_LayoutText_placesGlyphsAlongALine) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "ab", 0, layout);
+
+  EXPECT(layout.quads.size() == 2);
+  EXPECT(layout.quads[0].x == 1);
+  EXPECT(layout.quads[0].y == 2);
+  EXPECT(layout.quads[1].x == 11);
+  EXPECT(layout.quads[1].y == 2);
+  EXPECT(isRegion(layout.quads[1].region, 0, 0, 8, 10));
+  EXPECT(layout.width == 19);
+  EXPECT(layout.height == 12);
+  EXPECT(layout.totalLines == 1);
+}
+
+TEST(Gm_LayoutText_advancesPastSpacesWithoutQuads) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "a b", 0, layout);
+
+  EXPECT(layout.quads.size() == 2);
+  EXPECT(layout.quads[1].x == 16);
+}
+
+TEST(Gm_LayoutText_breaksLinesAtNewlines) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "ab\nc", 0, layout);
+
+  EXPECT(layout.quads.size() == 3);
+  EXPECT(layout.quads[2].x == 1);
+  EXPECT(layout.quads[2].y == 16);
+  EXPECT(layout.width == 19);
+  EXPECT(layout.height == 26);
+  EXPECT(layout.totalLines == 2);
+}
+
+TEST(Gm_LayoutText_wrapsWordsPastTheWrapWidth) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "ab cd", 40, layout);
+
+  EXPECT(layout.quads.size() == 4);
+  EXPECT(layout.quads[1].y == 2);
+
+  // The whole word moves onto the next line, rather than
+  // just the overflowing glyph
+  EXPECT(layout.quads[2].x == 1);
+  EXPECT(layout.quads[2].y == 16);
+  EXPECT(layout.quads[3].x == 11);
+  EXPECT(layout.quads[3].y == 16);
+  EXPECT(layout.totalLines == 2);
+  EXPECT(layout.height == 26);
+}
+
+TEST(Gm_LayoutText_breaksWordsWiderThanTheWrapWidth) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "abcd", 25, layout);
+
+  EXPECT(layout.quads.size() == 4);
+  EXPECT(layout.quads[1].x == 11);
+  EXPECT(layout.quads[1].y == 2);
+  EXPECT(layout.quads[2].x == 1);
+  EXPECT(layout.quads[2].y == 16);
+  EXPECT(layout.quads[3].x == 11);
+  EXPECT(layout.quads[3].y == 16);
+  EXPECT(layout.totalLines == 2);
+  EXPECT(layout.width == 19);
+}
+
+TEST(Gm_LayoutText_doesNotWrapWithoutAWrapWidth) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "abcdefghij klmnopqrst", 0, layout);
+
+  EXPECT(layout.quads.size() == 20);
+  EXPECT(layout.totalLines == 1);
+  EXPECT(layout.quads[19].y == 2);
+}
+
+TEST(Gm_LayoutText_skipsGlyphsWhichArentLoaded) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "a?b", 0, layout);
+
+  EXPECT(layout.quads.size() == 2);
+  EXPECT(layout.quads[1].x == 11);
+}
+
+TEST(Gm_LayoutText_replacesThePreviousLayout) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "abc\nd", 0, layout);
+  Gm_LayoutText(font, "a", 0, layout);
+
+  EXPECT(layout.quads.size() == 1);
+  EXPECT(layout.totalLines == 1);
+  EXPECT(layout.width == 9);
+  EXPECT(layout.height == 12);
+}
+
+TEST(Gm_LayoutText_laysOutEmptyStrings) {
+  GlyphFont font;
+  TextLayout layout;
+
+  createFont(font);
+
+  Gm_LayoutText(font, "", 0, layout);
+
+  EXPECT(layout.quads.size() == 0);
+  EXPECT(layout.width == 0);
+  EXPECT(layout.height == 12);
+  EXPECT(layout.totalLines == 1);
+}
\ No newline at end of file
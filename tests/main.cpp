@@ -0,0 +1,52 @@
+#include <cstdio>
+
+#include "test.h"
+
+namespace Tests {
+  static int totalFailures = 0;
+
+  std::vector<Test>& getTests() {
+    // Constructed on first use, since tests register themselves
+    // during static initialization of their translation units
+    static std::vector<Test> tests;
+
+    return tests;
+  }
+
+  bool registerTest(const char* name, const char* file, TestFunction run) {
+    getTests().push_back({ name, file, run });
+
+    return true;
+  }
+
+  void reportFailure(const char* condition, const char* file, int line) {
+    printf("  Failed: %s (%s:%d)\n", condition, file, line);
+
+    totalFailures++;
+  }
+}
+
+/**
+ * Runs every registered test, returning the number of failed
+ * expectations, so a non-zero exit code indicates failure.
+ */
+int main(int argc, char* argv[]) {
+  auto& tests = Tests::getTests();
+  int totalFailedTests = 0;
+
+  for (auto& test : tests) {
+    int failuresBefore = Tests::totalFailures;
+
+    printf("[Tests] %s\n", test.name);
+
+    test.run();
+
+    if (Tests::totalFailures > failuresBefore) {
+      totalFailedTests++;
+    }
+  }
+
+  printf("[Tests] %d of %d tests passed\n", (int)tests.size() - totalFailedTests, (int)tests.size());
+
+  return Tests::totalFailures;
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <vector>
+
+#include "system/lights_objects_meshes.h"
+#include "system/ObjectPool.h"
+#include "system/visibility.h"
+#include "test.h"
+
+using namespace Gamma;
+
+static bool isListed(const std::vector<u16>& indices, u16 index) {
+  return std::find(indices.begin(), indices.end(), index) != indices.end();
+}
+
+static u16 indexOf(ObjectPool& pool, const Object& object) {
+  return u16(pool.getByRecord(object._record) - pool.begin());
+}
+
+TEST(editVisibleIndices_listsEveryActiveObjectWhenUnculled) {
+  ObjectPool pool;
+
+  pool.reserve(10);
+
+  for (u32 i = 0; i < 5; i++) {
+    pool.createObject();
+  }
+
+  auto& indices = pool.editVisibleIndices();
+
+  EXPECT(pool.isCulled());
+  EXPECT(indices.size() == 5);
+
+  for (u16 i = 0; i < 5; i++) {
+    EXPECT(indices[i] == i);
+  }
+
+  pool.free();
+}
+
+TEST(editVisibleIndices_doesNotChangeVersion) {
+  ObjectPool pool;
+
+  pool.reserve(10);
+  pool.createObject();
+
+  u32 version = pool.version;
+
+  pool.editVisibleIndices().clear();
+
+  EXPECT(pool.version == version);
+  EXPECT(pool.totalVisible() == 0);
+
+  pool.free();
+}
+
+TEST(createObject_addsNewObjectsToVisibleIndices) {
+  ObjectPool pool;
+
+  pool.reserve(10);
+  pool.createObject();
+  pool.editVisibleIndices().clear();
+
+  auto& object = pool.createObject();
+
+  EXPECT(pool.totalVisible() == 1);
+  EXPECT(pool.getVisibleIndices()[0] == indexOf(pool, object));
+
+  pool.free();
+}
+
+TEST(removeById_dropsRemovedObjectsFromVisibleIndices) {
+  ObjectPool pool;
+  std::vector<Object> objects;
+
+  pool.reserve(10);
+
+  for (u32 i = 0; i < 6; i++) {
+    objects.push_back(pool.createObject());
+  }
+
+  // Show objects 1, 3 and 5, in reverse order
+  auto& indices = pool.editVisibleIndices();
+
+  indices = { 5, 3, 1 };
+
+  // Removing object 1 moves object 5 into its index
+  pool.removeById(objects[1]._record.id);
+
+  auto& visible = pool.getVisibleIndices();
+
+  EXPECT(visible.size() == 2);
+  EXPECT(visible[0] == indexOf(pool, objects[5]));
+  EXPECT(visible[1] == indexOf(pool, objects[3]));
+  EXPECT(visible[0] == 1);
+
+  pool.free();
+}
+
+TEST(removeById_resolvesVisibleIndicesAfterSeveralRemovals) {
+  ObjectPool pool;
+  std::vector<Object> objects;
+
+  pool.reserve(100);
+
+  for (u32 i = 0; i < 100; i++) {
+    objects.push_back(pool.createObject());
+  }
+
+  auto& indices = pool.editVisibleIndices();
+
+  indices.clear();
+
+  for (u16 i = 0; i < 100; i += 3) {
+    indices.push_back(i);
+  }
+
+  for (u32 i = 0; i < 100; i += 2) {
+    pool.removeById(objects[i]._record.id);
+  }
+
+  auto& visible = pool.getVisibleIndices();
+  u32 totalExpected = 0;
+
+  for (u32 i = 3; i < 100; i += 6) {
+    EXPECT(isListed(visible, indexOf(pool, objects[i])));
+
+    totalExpected++;
+  }
+
+  EXPECT(visible.size() == totalExpected);
+  EXPECT(pool.totalVisible() == totalExpected);
+
+  for (auto index : visible) {
+    EXPECT(index < pool.totalActive());
+  }
+
+  pool.free();
+}
+
+TEST(removeById_listsObjectsWithReusedIdsOnce) {
+  ObjectPool pool;
+
+  pool.reserve(10);
+
+  auto removed = pool.createObject();
+  auto kept = pool.createObject();
+
+  pool.editVisibleIndices();
+  pool.removeById(removed._record.id);
+
+  // Cycle through IDs until the removed object's ID is reused
+  Object reused;
+
+  do {
+    reused = pool.createObject();
+
+    if (reused._record.id != removed._record.id) {
+      pool.removeById(reused._record.id);
+    }
+  } while (reused._record.id != removed._record.id);
+
+  auto& visible = pool.getVisibleIndices();
+
+  EXPECT(pool.totalActive() == 2);
+  EXPECT(visible.size() == 2);
+  EXPECT(isListed(visible, indexOf(pool, kept)));
+  EXPECT(isListed(visible, indexOf(pool, reused)));
+  EXPECT(pool.getByRecord(removed._record) == nullptr);
+
+  pool.free();
+}
+
+TEST(showAll_resetsVisibleIndices) {
+  ObjectPool pool;
+
+  pool.reserve(10);
+
+  auto object = pool.createObject();
+
+  pool.createObject();
+  pool.editVisibleIndices().clear();
+  pool.removeById(object._record.id);
+  pool.showAll();
+
+  EXPECT(!pool.isCulled());
+  EXPECT(pool.totalVisible() == 1);
+  EXPECT(pool.editVisibleIndices().size() == 1);
+
+  pool.free();
+}
+
+TEST(Gm_PartitionObjectsByLod_groupsObjectsByDistance) {
+  ObjectPool pool;
+  std::vector<u32> lodOffsets;
+
+  pool.reserve(10);
+
+  for (float distance : { 60.f, 40.f, 30.f, 20.f, 10.f, 0.f }) {
+    pool.createObject().position = Vec3f(distance, 0, 0);
+  }
+
+  auto& indices = pool.editVisibleIndices();
+
+  Gm_PartitionObjectsByLod(pool, indices, 3, 25.f, Vec3f(0.f), lodOffsets);
+
+  EXPECT(lodOffsets.size() == 4);
+  EXPECT(lodOffsets[0] == 0);
+  EXPECT(lodOffsets[1] == 3);
+  EXPECT(lodOffsets[2] == 5);
+  EXPECT(lodOffsets[3] == 6);
+
+  for (u32 lod = 0; lod < 3; lod++) {
+    for (u32 i = lodOffsets[lod]; i < lodOffsets[lod + 1]; i++) {
+      float distance = pool[indices[i]].position.x;
+
+      EXPECT(distance <= 25.f * float(lod + 1) || lod == 2);
+      EXPECT(distance > 25.f * float(lod) || lod == 0);
+    }
+  }
+
+  pool.free();
+}
+
+TEST(Gm_PartitionObjectsByLod_handlesEmptyLists) {
+  ObjectPool pool;
+  std::vector<u16> indices;
+  std::vector<u32> lodOffsets;
+
+  pool.reserve(10);
+
+  Gm_PartitionObjectsByLod(pool, indices, 2, 25.f, Vec3f(0.f), lodOffsets);
+
+  EXPECT(lodOffsets.size() == 3);
+  EXPECT(lodOffsets[0] == 0 && lodOffsets[1] == 0 && lodOffsets[2] == 0);
+
+  pool.free();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <cmath>
+
+#include "math/matrix.h"
+#include "math/Quaternion.h"
+#include "system/packed_data.h"
+#include "test.h"
+
+using namespace Gamma;
+
+static bool isClose(const Vec3f& a, const Vec3f& b, float tolerance) {
+  return (
+    fabsf(a.x - b.x) <= tolerance &&
+    fabsf(a.y - b.y) <= tolerance &&
+    fabsf(a.z - b.z) <= tolerance
+  );
+}
+
+/**
+ * Transforms a set of vectors by a compact transform and by
+ * the model matrix for the same position, rotation and scale,
+ * expecting the results to match within a tolerance.
+ */
+template<typename T>
+static void expectSameTransform(const Vec3f& position, const Quaternion& rotation, const Vec3f& scale, float tolerance) {
+  T transform(position, rotation, scale);
+  Matrix4f matrix = Matrix4f::transformation(position, scale, rotation);
+
+  Vec3f vectors[] = {
+    Vec3f(0.f),
+    Vec3f(1.f, 0, 0),
+    Vec3f(0, 1.f, 0),
+    Vec3f(0, 0, 1.f),
+    Vec3f(-0.5f, 0.25f, 0.75f)
+  };
+
+  for (auto& vector : vectors) {
+    EXPECT(isClose(transform.transformVec3f(vector), matrix.transformVec3f(vector), tolerance));
+  }
+}
+
+TEST(pTransform_matchesModelMatrix) {
+  expectSameTransform<pTransform>(Vec3f(0.f), Quaternion(1.f, 0, 0, 0), Vec3f(1.f), 0.001f);
+  expectSameTransform<pTransform>(Vec3f(10.f, -5.f, 200.f), Quaternion::fromAxisAngle(Vec3f(0, 1.f, 0), 1.2f), Vec3f(2.f), 0.001f);
+  expectSameTransform<pTransform>(Vec3f(-3.f, 7.f, 1.f), Quaternion::fromEulerAngles(0.3f, -1.1f, 2.4f), Vec3f(1.f, 4.f, 0.5f), 0.002f);
+}
+
+TEST(pTransform_normalizesRotation) {
+  Quaternion rotation = Quaternion::fromAxisAngle(Vec3f(1.f, 0, 0), 0.7f);
+  Quaternion scaledRotation = Quaternion(rotation.w * 3.f, rotation.x * 3.f, rotation.y * 3.f, rotation.z * 3.f);
+  pTransform transform(Vec3f(0.f), scaledRotation, Vec3f(1.f));
+  Quaternion unpacked = transform.getRotation();
+
+  EXPECT(fabsf(unpacked.w - rotation.w) < 0.001f);
+  EXPECT(fabsf(unpacked.x - rotation.x) < 0.001f);
+}
+
+TEST(pTransform_treatsZeroRotationAsIdentity) {
+  pTransform transform(Vec3f(0.f), Quaternion(0.f), Vec3f(1.f));
+  Quaternion rotation = transform.getRotation();
+
+  EXPECT(rotation.w == 1.f);
+  EXPECT(rotation.x == 0.f && rotation.y == 0.f && rotation.z == 0.f);
+}
+
+TEST(pHalfTransform_matchesModelMatrix) {
+  expectSameTransform<pHalfTransform>(Vec3f(0.f), Quaternion(1.f, 0, 0, 0), Vec3f(1.f), 0.001f);
+  expectSameTransform<pHalfTransform>(Vec3f(10.f, -5.f, 200.f), Quaternion::fromAxisAngle(Vec3f(0, 0, 1.f), -0.4f), Vec3f(3.f, 0.25f, 12.f), 0.02f);
+  expectSameTransform<pHalfTransform>(Vec3f(-3.f, 7.f, 1.f), Quaternion::fromEulerAngles(1.5f, 0.2f, -0.9f), Vec3f(1.f, 4.f, 0.5f), 0.01f);
+}
+
+TEST(pHalfTransform_storesScaleAtHalfPrecision) {
+  pHalfTransform transform(Vec3f(0.f), Quaternion(1.f, 0, 0, 0), Vec3f(1.f, 0.1f, 1000.f));
+  Vec3f scale = transform.getScale();
+
+  EXPECT(scale.x == 1.f);
+  // Halfs have 10 mantissa bits, for a relative error of 2^-11
+  EXPECT(fabsf(scale.y - 0.1f) <= 0.1f / 2048.f);
+  EXPECT(fabsf(scale.z - 1000.f) <= 1000.f / 2048.f);
+  EXPECT(transform.scale[3] == 0);
+}
+
+TEST(Gm_FloatToHalf_roundTripsRepresentableValues) {
+  float values[] = { 0.f, -0.f, 1.f, -2.f, 0.5f, 65504.f, 6.103515625e-05f, 5.9604644775390625e-08f };
+
+  for (float value : values) {
+    EXPECT(Gm_HalfToFloat(Gm_FloatToHalf(value)) == value);
+  }
+
+  EXPECT(Gm_FloatToHalf(1.f) == 0x3C00);
+  EXPECT(Gm_FloatToHalf(-2.f) == 0xC000);
+}
+
+TEST(Gm_FloatToHalf_handlesOutOfRangeValues) {
+  // Overflow to infinity
+  EXPECT(Gm_FloatToHalf(100000.f) == 0x7C00);
+  EXPECT(Gm_FloatToHalf(-100000.f) == 0xFC00);
+  // Underflow to zero
+  EXPECT(Gm_FloatToHalf(1e-10f) == 0);
+  EXPECT(std::isinf(Gm_HalfToFloat(0x7C00)));
+  EXPECT(std::isnan(Gm_HalfToFloat(0x7E00)));
+}
+
+TEST(Gm_FloatToHalf_roundsToNearestEven) {
+  // Halfway between 1 and the next half, 1 + 2^-10
+  EXPECT(Gm_FloatToHalf(1.f + 1.f / 2048.f) == 0x3C00);
+  // Halfway between 1 + 2^-10 and 1 + 2^-9
+  EXPECT(Gm_FloatToHalf(1.f + 3.f / 2048.f) == 0x3C02);
+}
\ No newline at end of file
@@ -0,0 +1,423 @@
+#include <vector>
+
+#include "math/matrix.h"
+#include "system/lights_objects_meshes.h"
+#include "system/ObjectPool.h"
+#include "system/shadow_casters.h"
+#include "test.h"
+
+using namespace Gamma;
+
+// Meshes without vertices have a bounding radius of 1, so objects
+// are in range of a light if within its radius plus their scale
+static Mesh* createMesh(u16 index) {
+  auto* mesh = new Mesh();
+
+  mesh->index = index;
+  mesh->objects.reserve(10);
+
+  return mesh;
+}
+
+static void freeMeshes(std::vector<Mesh*>& meshes) {
+  for (auto* mesh : meshes) {
+    mesh->objects.free();
+
+    delete mesh;
+  }
+
+  meshes.clear();
+}
+
+static Object& addObject(Mesh& mesh, const Vec3f& position) {
+  auto& object = mesh.objects.createObject();
+
+  object.position = position;
+  object.scale = Vec3f(1.f);
+  object.rotation = Quaternion(1.f, 0, 0, 0);
+
+  return object;
+}
+
+static void moveObject(Mesh& mesh, const Object& object, const Vec3f& position) {
+  auto* live = mesh.objects.getByRecord(object._record);
+
+  live->position = position;
+
+  mesh.objects.transformById(live->_record.id, Matrix4f::identity());
+}
+
+static Light createPointLight() {
+  Light light;
+
+  light.type = LightType::POINT_SHADOWCASTER;
+  light.position = Vec3f(0.f);
+  light.radius = 100.f;
+
+  return light;
+}
+
+TEST(Gm_UpdateShadowCasterList_listsMeshesWithObjectsInRange) {
+  std::vector<Mesh*> meshes = { createMesh(0), createMesh(1) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+  addObject(*meshes[0], Vec3f(500.f, 0, 0));
+  addObject(*meshes[0], Vec3f(0, 0, -80.f));
+  addObject(*meshes[1], Vec3f(1000.f, 0, 0));
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 1);
+  EXPECT(list.meshIndices[0] == 0);
+  EXPECT(Gm_IsShadowCaster(list, 0));
+  EXPECT(!Gm_IsShadowCaster(list, 1));
+
+  auto& indices = Gm_GetShadowCasterIndices(list, 0);
+
+  EXPECT(indices.size() == 2);
+  EXPECT(indices[0] == 0);
+  EXPECT(indices[1] == 2);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_isUnchangedWithoutChanges) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(!Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 1);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_changesWhenObjectsInRangeMove) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+  auto& object = addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  moveObject(*meshes[0], object, Vec3f(60.f, 0, 0));
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_ignoresObjectsMovingOutOfRange) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  auto& far = addObject(*meshes[0], Vec3f(500.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  u32 version = meshes[0]->objects.version;
+
+  moveObject(*meshes[0], far, Vec3f(600.f, 0, 0));
+
+  EXPECT(meshes[0]->objects.version != version);
+  EXPECT(!Gm_UpdateShadowCasterList(list, light, meshes));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_ignoresReorderedObjects) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  auto far = addObject(*meshes[0], Vec3f(500.f, 0, 0));
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+  addObject(*meshes[0], Vec3f(-50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  // Removing the out-of-range object moves the last
+  // in-range object into its index
+  meshes[0]->objects.removeById(far._record.id);
+
+  EXPECT(!Gm_UpdateShadowCasterList(list, light, meshes));
+
+  auto& indices = Gm_GetShadowCasterIndices(list, 0);
+
+  EXPECT(indices.size() == 2);
+  EXPECT(indices[0] == 0);
+  EXPECT(indices[1] == 1);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_changesWhenObjectsInRangeAreRemoved) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+  auto object = addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  meshes[0]->objects.removeById(object._record.id);
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 0);
+  EXPECT(!Gm_IsShadowCaster(list, 0));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_changesWhenTheLightChanges) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  light.position = Vec3f(10.f, 0, 0);
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+
+  light.radius = 200.f;
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(!Gm_UpdateShadowCasterList(list, light, meshes));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_dropsMeshesWhichStopCastingShadows) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  meshes[0]->disabled = true;
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 0);
+
+  meshes[0]->disabled = false;
+  meshes[0]->canCastShadows = false;
+
+  EXPECT(!Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 0);
+
+  meshes[0]->canCastShadows = true;
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 1);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_excludesObjectsBehindSpotLights) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  light.type = LightType::SPOT_SHADOWCASTER;
+  light.direction = Vec3f(0, 0, 1.f);
+
+  addObject(*meshes[0], Vec3f(0, 0, 50.f));
+  addObject(*meshes[0], Vec3f(0, 0, -50.f));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  auto& indices = Gm_GetShadowCasterIndices(list, 0);
+
+  EXPECT(indices.size() == 1);
+  EXPECT(indices[0] == 0);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_alwaysChangesWithAnimatedCasters) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  meshes[0]->transformedVertices.push_back(Vertex());
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterList_resetsWhenMeshesAreAdded) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterList list;
+  auto light = createPointLight();
+
+  addObject(*meshes[0], Vec3f(50.f, 0, 0));
+
+  Gm_UpdateShadowCasterList(list, light, meshes);
+
+  meshes.push_back(createMesh(1));
+
+  addObject(*meshes[1], Vec3f(-50.f, 0, 0));
+
+  EXPECT(Gm_UpdateShadowCasterList(list, light, meshes));
+  EXPECT(list.meshIndices.size() == 2);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterCache_marksUnchangedMeshesAsStatic) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterCache cache;
+
+  addObject(*meshes[0], Vec3f(0.f));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+
+  u32 generation = cache.staticGeneration;
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 59);
+
+  EXPECT(!Gm_IsStaticShadowCaster(cache, *meshes[0]));
+  EXPECT(cache.staticGeneration == generation);
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 60);
+
+  EXPECT(Gm_IsStaticShadowCaster(cache, *meshes[0]));
+  EXPECT(cache.staticGeneration == generation + 1);
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 61);
+
+  EXPECT(cache.staticGeneration == generation + 1);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterCache_invalidatesStaticLayersWhenStaticMeshesChange) {
+  std::vector<Mesh*> meshes = { createMesh(0), createMesh(1) };
+  ShadowCasterCache cache;
+  auto& object = addObject(*meshes[0], Vec3f(0.f));
+
+  addObject(*meshes[1], Vec3f(10.f, 0, 0));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+  Gm_UpdateShadowCasterCache(cache, meshes, 60);
+
+  u32 generation = cache.staticGeneration;
+
+  moveObject(*meshes[0], object, Vec3f(5.f, 0, 0));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 61);
+
+  EXPECT(!Gm_IsStaticShadowCaster(cache, *meshes[0]));
+  EXPECT(Gm_IsStaticShadowCaster(cache, *meshes[1]));
+  EXPECT(cache.staticGeneration != generation);
+
+  // The mesh becomes static again once it stops changing
+  generation = cache.staticGeneration;
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 121);
+
+  EXPECT(Gm_IsStaticShadowCaster(cache, *meshes[0]));
+  EXPECT(cache.staticGeneration != generation);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterCache_invalidatesStaticLayersWhenMeshesStopCastingShadows) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterCache cache;
+
+  addObject(*meshes[0], Vec3f(0.f));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+  Gm_UpdateShadowCasterCache(cache, meshes, 60);
+
+  u32 generation = cache.staticGeneration;
+
+  meshes[0]->disabled = true;
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 61);
+
+  EXPECT(!Gm_IsStaticShadowCaster(cache, *meshes[0]));
+  EXPECT(cache.staticGeneration != generation);
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterCache_neverMarksAnimatedMeshesAsStatic) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterCache cache;
+
+  addObject(*meshes[0], Vec3f(0.f));
+
+  meshes[0]->transformedVertices.push_back(Vertex());
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+  Gm_UpdateShadowCasterCache(cache, meshes, 1000);
+
+  EXPECT(!Gm_IsStaticShadowCaster(cache, *meshes[0]));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_UpdateShadowCasterCache_invalidatesStaticLayersWhenMeshesAreAdded) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterCache cache;
+
+  addObject(*meshes[0], Vec3f(0.f));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+  Gm_UpdateShadowCasterCache(cache, meshes, 60);
+
+  u32 generation = cache.staticGeneration;
+
+  meshes.push_back(createMesh(1));
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 61);
+
+  EXPECT(cache.staticGeneration != generation);
+  EXPECT(!Gm_IsStaticShadowCaster(cache, *meshes[0]));
+
+  freeMeshes(meshes);
+}
+
+TEST(Gm_GetShadowCastersInCascade_listsObjectsInsideTheCascade) {
+  std::vector<Mesh*> meshes = { createMesh(0) };
+  ShadowCasterCache cache;
+  std::vector<u16> indices;
+
+  for (auto& object : { Vec3f(0.f), Vec3f(10.f, 0, 0), Vec3f(0, 1.5f, 0) }) {
+    auto& created = addObject(*meshes[0], object);
+
+    created.scale = Vec3f(0.1f);
+  }
+
+  Gm_UpdateShadowCasterCache(cache, meshes, 0);
+
+  // An identity view-projection covers the box from -1 to 1
+  EXPECT(Gm_GetShadowCastersInCascade(cache, *meshes[0], Matrix4f::identity(), indices));
+  EXPECT(indices.size() == 1);
+  EXPECT(indices[0] == 0);
+
+  auto offset = Matrix4f::translation(Vec3f(100.f, 0, 0));
+
+  EXPECT(!Gm_GetShadowCastersInCascade(cache, *meshes[0], offset, indices));
+  EXPECT(indices.size() == 0);
+
+  freeMeshes(meshes);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Defines a test case, registered to run from tests/main.cpp.
+ */
+#define TEST(name)\
+  static void name();\
+  static bool name##_registered = Tests::registerTest(#name, __FILE__, name);\
+  static void name()
+
+/**
+ * Records a failure, with its file and line, if an expected
+ * condition doesn't hold. Tests keep running after a failure.
+ */
+#define EXPECT(condition)\
+  if (!(condition)) {\
+    Tests::reportFailure(#condition, __FILE__, __LINE__);\
+  }
+
+namespace Tests {
+  typedef void (*TestFunction)();
+
+  struct Test {
+    const char* name;
+    const char* file;
+    TestFunction run;
+  };
+
+  std::vector<Test>& getTests();
+  bool registerTest(const char* name, const char* file, TestFunction run);
+  void reportFailure(const char* condition, const char* file, int line);
+}
\ No newline at end of file